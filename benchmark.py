@@ -1,14 +1,86 @@
+"""
+Guardian benchmark suite.
+
+  python benchmark.py                          # full run, printed as a table
+  python benchmark.py --quick -k list          # fewer sizes / repeats, only cases matching "list"
+  python benchmark.py --json run.json          # machine-readable results
+  python benchmark.py --compare base.json      # diff against an earlier --json run; exits 1 on regressions
+
+Every case reports the best and median time per operation over several repeats; container cases
+also report time per element. pydantic and beartype comparisons run when those packages are installed.
+"""
+import argparse
+import array
+import dataclasses as std_dataclasses
+import enum
+import json
+import os
+import platform
+import statistics
+import sys
+import threading
+import time
 import timeit
-from typing import Union, List, Dict
-from pydantic import BaseModel
-from beartype import beartype
+from collections.abc import Iterator
+from typing import Any, Literal, NamedTuple, NotRequired, Protocol, TypedDict, Union, runtime_checkable
 
-from guardian.guard_set import guard, deepguard
-from guardian.shield import Shield
+import guardian
+from guardian import guard, deepguard, Shield, Buffer, GuardianTypeError, GuardedList, validate_many
+from guardian import _guardian_core
+from guardian.dataclasses import dataclass
+from guardian._compiler import compile_program, OP_LIST, OP_TUPLE_VAR, OP_UNION, OP_INSTANCE
+
+try:
+  from pydantic import BaseModel
+except ImportError:
+  BaseModel = None
+try:
+  from beartype import beartype
+except ImportError:
+  beartype = None
+
+
+# ==========================================
+# CASE REGISTRY
+# ==========================================
+
+@std_dataclasses.dataclass
+class Case:
+  group: str
+  name: str
+  fn: Any                 # zero-argument callable timed in a loop
+  elements: int = 1       # items checked per call, for the ns / element column
+
+
+SUITES = {}
+
+
+def suite(group: str):
+  def register(builder):
+    SUITES[group] = builder
+    return builder
+  return register
+
+
+def _sizes(quick: bool) -> tuple:
+  return (10, 1_000) if quick else (10, 1_000, 100_000)
+
+
+def _check(rule, value):
+  return lambda: rule.check(value)
+
+
+def _rejects(fn, *args):
+  def call():
+    try:
+      fn(*args)
+    except GuardianTypeError:
+      pass
+  return call
 
 
 # ==========================================
-# BENCHMARK TARGETS
+# SUITES
 # ==========================================
 
 def standard_add(a: int, b: int) -> int:
@@ -22,85 +94,515 @@ def guard_add(a: int, b: int) -> int:
 
 @deepguard
 def deepguard_add(a: int, b: int) -> int:
-  return a + b
-
-
-@beartype
-def beartype_add(a: int, b: int) -> int:
-  return a + b
+  total: int = a + b
+  return total
+
+
+@suite("call")
+def call_cases(quick: bool):
+  cases = [
+    Case("call", "plain function", lambda: standard_add(1, 2)),
+    Case("call", "@guard", lambda: guard_add(1, 2)),
+    Case("call", "@guard kwargs", lambda: guard_add(a=1, b=2)),
+    Case("call", "@deepguard", lambda: deepguard_add(1, 2)),
+  ]
+  if beartype is not None:
+    beartype_add = beartype(standard_add)
+    cases.append(Case("call", "beartype", lambda: beartype_add(1, 2)))
+  return cases
+
+
+class Color(enum.Enum):
+  RED = 1
+  GREEN = 2
+
+
+class Cat(TypedDict):
+  kind: Literal["cat"]
+  lives: int
+
+
+class Dog(TypedDict):
+  kind: Literal["dog"]
+  good: bool
+
+
+@suite("opcode")
+def opcode_cases(quick: bool):
+  """One case per opcode the compiler emits, across container sizes."""
+  cases = [
+    Case("opcode", "ANY", _check(compile_program(Any), 1)),
+    Case("opcode", "EXACT int", _check(compile_program(int, exact_primitives=True), 1)),
+    Case("opcode", "INSTANCE Color", _check(compile_program(Color), Color.RED)),
+    Case("opcode", "UNION int | Color", _check(_guardian_core.lower_rule(
+      (OP_UNION, ((OP_INSTANCE, int), (OP_INSTANCE, Color)))), Color.RED)),
+    Case("opcode", "UNION_DISPATCH int | str | None", _check(compile_program(int | str | None), None)),
+    Case("opcode", "TAGGED_UNION Cat | Dog", _check(compile_program(Cat | Dog), {"kind": "dog", "good": True})),
+    Case("opcode", "TUPLE_FIXED[int, str, float]", _check(compile_program(tuple[int, str, float]), (1, "a", 1.0))),
+  ]
+  for width in (2, 16, 256):
+    values = tuple(range(width))
+    cases.append(Case("opcode", f"LITERAL width={width}", _check(compile_program(Literal[values]), width - 1)))
+    routes = tuple(f"route.{i}" for i in range(width))
+    parsed = json.loads(json.dumps(routes[-1]))  # equal but not identical, like a decoded message field
+    cases.append(Case("opcode", f"LITERAL str width={width} (parsed)", _check(compile_program(Literal[routes]), parsed)))
+  for n in _sizes(quick):
+    cases += [
+      Case("opcode", f"LIST[int] n={n}", _check(compile_program(list[int]), list(range(n))), n),
+      Case("opcode", f"LIST[int | str] n={n}", _check(compile_program(list[int | str]), [i if i % 2 else str(i) for i in range(n)]), n),
+      Case("opcode", f"TUPLE_VAR[float] n={n}", _check(compile_program(tuple[float, ...]), tuple(map(float, range(n)))), n),
+      Case("opcode", f"DICT[str, int] n={n}", _check(compile_program(dict[str, int]), {str(i): i for i in range(n)}), n),
+      Case("opcode", f"SET[int] n={n}", _check(compile_program(set[int]), set(range(n))), n),
+      Case("opcode", f"BUFFER d ge/le n={n}", _check(compile_program(Buffer("d", ge=0.0, le=float(n))),
+                                                     array.array("d", map(float, range(n)))), n),
+    ]
+  return cases
+
+
+class LineItem(TypedDict):
+  sku: str
+  qty: int
+  tags: NotRequired[list[str]]
+
+
+class OrderBody(TypedDict):
+  id: int
+  customer: str
+  lines: list[LineItem]
+
+
+class Point(NamedTuple):
+  x: float
+  y: float
+
+
+@std_dataclasses.dataclass(slots=True)
+class Segment:
+  start: Point
+  end: Point
+  label: str
+
+
+@runtime_checkable
+class Closable(Protocol):
+  def close(self) -> None: ...
+
+
+class FileLike:
+  def close(self) -> None:
+    pass
+
+
+def _json_alias():
+  """`type JSON = ...` needs 3.12 syntax, so the alias is only built there."""
+  if sys.version_info < (3, 12):
+    return None
+  namespace = {}
+  exec("type JSON = dict[str, JSON] | list[JSON] | str | int | float | bool | None", namespace)
+  return namespace["JSON"]
+
+
+@suite("structural")
+def structural_cases(quick: bool):
+  """TypedDict request bodies, NamedTuples, plain dataclasses, protocols and recursive aliases checked in C."""
+  closable = FileLike()
+  cases = [
+    Case("structural", "NAMED_TUPLE Point", _check(compile_program(Point), Point(1.0, 2.0))),
+    Case("structural", "DATACLASS Segment (slots)", _check(compile_program(Segment), Segment(Point(0.0, 0.0), Point(1.0, 1.0), "a"))),
+    Case("structural", "PROTOCOL Closable", _check(compile_program(Closable), closable)),
+    Case("structural", "isinstance(Closable)", lambda: isinstance(closable, Closable)),
+  ]
+  for n in _sizes(quick):
+    body = {"id": 1, "customer": "c", "lines": [{"sku": f"s{i}", "qty": i} for i in range(n)]}
+    cases.append(Case("structural", f"TYPED_DICT OrderBody lines={n}", _check(compile_program(OrderBody), body), n))
+  json_alias = _json_alias()
+  for n in _sizes(quick) if json_alias is not None else ():
+    document = json.loads(json.dumps([{"id": i, "tags": ["a", "b"], "meta": {"score": 0.5, "ok": True}} for i in range(n)]))
+    cases.append(Case("structural", f"REF JSON alias records={n}", _check(compile_program(json_alias), document), n))
+  return cases
+
+
+@suite("union")
+def union_cases(quick: bool):
+  """Dispatch-table unions against the ordered scan they replace, by width (value matches the last branch)."""
+  classes = [type(f"T{i}", (), {}) for i in range(16)]
+  cases = []
+  for width in ((2, 8) if quick else (2, 4, 8, 16)):
+    branches = tuple(classes[:width])
+    last = branches[-1]()
+    dispatch = compile_program(Union[branches])
+    scan = _guardian_core.lower_rule((OP_UNION, tuple((OP_INSTANCE, tp) for tp in branches)))
+    cases.append(Case("union", f"dispatch width={width}", _check(dispatch, last)))
+    cases.append(Case("union", f"ordered scan width={width}", _check(scan, last)))
+  return cases
+
+
+@suite("nesting")
+def nesting_cases(quick: bool):
+  """list[list[...[int]]] at increasing depth, with about 1024 leaves in total."""
+  cases = []
+  for depth in ((1, 4) if quick else (1, 2, 4, 8)):
+    hint, value = int, 1
+    fanout = max(2, round(1024 ** (1 / depth)))
+    for _ in range(depth):
+      hint, value = list[hint], [value] * fanout
+    cases.append(Case("nesting", f"list depth={depth} fanout={fanout}", _check(compile_program(hint), value), fanout ** depth))
+  return cases
+
+
+@suite("kernel")
+def kernel_cases(quick: bool):
+  """
+  The batched ob_type scan that list[T] / tuple[T, ...] rules use, against the same check run
+  through a one-branch union, which forces the generic per-element recursion.
+  """
+  specs = [
+    ("list[int]", list[int], (OP_LIST, (OP_UNION, ((OP_INSTANCE, int),))), lambda n: list(range(n))),
+    ("tuple[str, ...]", tuple[str, ...], (OP_TUPLE_VAR, (OP_UNION, ((OP_INSTANCE, str),))), lambda n: tuple(map(str, range(n)))),
+  ]
+  cases = []
+  for name, hint, generic_raw, make in specs:
+    for n in ((10_000,) if quick else (10_000, 1_000_000)):
+      data = make(n)
+      cases.append(Case("kernel", f"{name} kernel n={n}", _check(compile_program(hint), data), n))
+      cases.append(Case("kernel", f"{name} per-element n={n}", _check(_guardian_core.lower_rule(generic_raw), data), n))
+  return cases
 
 
 class ShieldCat(Shield):
   name: str
   age: int
+  _lives: int
 
   def __init__(self, name: str, age: int):
     self.name = name
     self.age = age
+    self._lives = 9
+
+  def write_lives_at_depth(self, depth: int, writes: int):
+    if depth > 1:
+      return self.write_lives_at_depth(depth - 1, writes)
+    for lives in range(writes):
+      self._lives = lives
 
 
-class PydanticCat(BaseModel):
+class SlottedCat(Shield, slots=True):
   name: str
   age: int
 
+  def __init__(self, name: str, age: int):
+    self.name = name
+    self.age = age
 
-# ==========================================
-# BENCHMARK RUNNER
-# ==========================================
 
-def run_benchmarks(iterations: int = 100_000):
-  print("\n" + "=" * 65)
-  print(f"GUARDIAN PERFORMANCE BENCHMARK ({iterations:,} iterations)")
-  print("=" * 65)
+@suite("shield")
+def shield_cases(quick: bool):
+  cat, slotted = ShieldCat("Luna", 3), SlottedCat("Luna", 3)
 
-  def measure(stmt: str, setup: str = "pass") -> float:
-    # Warmup loop to prime the CPU cache and JIT (if applicable)
-    timeit.timeit(stmt, setup=setup, globals=globals(), number=1000)
-    # Actual measurement
-    total_time = timeit.timeit(stmt, setup=setup, globals=globals(), number=iterations)
-    # Convert total time to nanoseconds per operation
-    return (total_time / iterations) * 1_000_000_000
+  def set_age():
+    cat.age = 4
+
+  def set_slotted_age():
+    slotted.age = 4
+
+  cases = [
+    Case("shield", "init", lambda: ShieldCat("Luna", 3)),
+    Case("shield", "attr set", set_age),
+    Case("shield", "attr set slots=True", set_slotted_age),
+    Case("shield", "attr get", lambda: cat.age),
+  ]
+  # The owner check looks only at the writing frame, so ns / element (one private write each,
+  # with the recursion amortized over 100 writes) should stay flat as the stack deepens.
+  for depth in ((1, 16) if quick else (1, 4, 16, 64)):
+    cases.append(Case("shield", f"private write depth={depth}", lambda d=depth: cat.write_lives_at_depth(d, 100), 100))
+  if BaseModel is not None:
+    class PydanticCat(BaseModel):
+      name: str
+      age: int
+    pydantic_cat = PydanticCat(name="Luna", age=3)
+
+    def set_pydantic_age():
+      pydantic_cat.age = 4
+    cases.append(Case("shield", "pydantic init", lambda: PydanticCat(name="Luna", age=3)))
+    cases.append(Case("shield", "pydantic attr set", set_pydantic_age))
+  return cases
+
+
+@dataclass
+class Point:
+  x: float
+  y: float
+  tags: list[str] = std_dataclasses.field(default_factory=list)
 
-  results = []
 
-  # 1. Simple Function Call (Overhead Test)
-  results.append(("Standard Func", measure("standard_add(1, 2)"), "func"))
-  results.append(("Guard Func", measure("guard_add(1, 2)"), "func"))
-  results.append(("DeepGuard Func", measure("deepguard_add(1, 2)"), "func"))
-  results.append(("Beartype Func", measure("beartype_add(1, 2)"), "func"))
+@dataclass(frozen=True)
+class FrozenPoint:
+  x: float
+  y: float
 
-  # 2. Class Instantiation
-  results.append(("Standard/Shield Init", measure("ShieldCat('Luna', 3)"), "init"))
-  results.append(("Pydantic Init", measure("PydanticCat(name='Luna', age=3)"), "init"))
 
-  # 3. Attribute Assignment (Setup phase creates the object so we ONLY measure the assignment)
-  setup_shield_attr = "c = ShieldCat('Luna', 3)"
-  setup_pydantic_attr = "p = PydanticCat(name='Luna', age=3)"
+@dataclass(slots=True)
+class SlottedPoint:
+  x: float
+  y: float
 
-  results.append(("Shield Attr Set", measure("c.age = 4", setup=setup_shield_attr), "attr"))
-  results.append(("Pydantic Attr Set", measure("p.age = 4", setup=setup_pydantic_attr), "attr"))
 
-  # ==========================================
-  # PRINT RESULTS TABLE
-  # ==========================================
+@suite("dataclass")
+def dataclass_cases(quick: bool):
+  point = Point(1.0, 2.0)
 
-  print(f"{'Operation / Library':<25} | {'Time (ns / op)':<15} | {'Relative Overhead':<15}")
-  print("-" * 65)
+  def set_x():
+    point.x = 3.0
 
-  # Use standard python function as the baseline for 1.00x overhead
-  baseline_func = results[0][1]
+  return [
+    Case("dataclass", "init", lambda: Point(1.0, 2.0)),
+    Case("dataclass", "init frozen", lambda: FrozenPoint(1.0, 2.0)),
+    Case("dataclass", "init slots", lambda: SlottedPoint(1.0, 2.0)),
+    Case("dataclass", "field set", set_x),
+    Case("dataclass", "from_dict", lambda: guardian.dataclasses.from_dict(Point, {"x": 1.0, "y": 2.0, "tags": ["a"]})),
+  ]
+
+
+@guard
+def ingest(payload: dict[str, list[int]]) -> int:
+  return len(payload)
+
+
+@suite("reject")
+def reject_cases(quick: bool):
+  """The error path: raising (and catching) a GuardianTypeError, without rendering its message."""
+  big = {str(i): list(range(10)) for i in range(10_000)}
+  big["zz"] = ["bad"]
+  guarded = GuardedList(int)
+  cases = [
+    Case("reject", "guard scalar", _rejects(guard_add, "1", 2)),
+    Case("reject", "guard shallow payload", _rejects(ingest, ["not", "a", "dict"])),
+    Case("reject", "guard deep payload n=100k", _rejects(ingest, big), 100_000),
+    Case("reject", "GuardedList.append", _rejects(guarded.append, "x")),
+  ]
+
+  def render():
+    try:
+      ingest(big)
+    except GuardianTypeError as exc:
+      str(exc)
+  cases.append(Case("reject", "guard deep payload + str(exc)", render, 100_000))
+  return cases
+
+
+@suite("bulk")
+def bulk_cases(quick: bool):
+  n = 10_000
+  values = list(range(n))
+  rule = compile_program(int, exact_primitives=True)
+  return [
+    Case("bulk", f"validate_many int n={n}", lambda: validate_many(int, values), n),
+    Case("bulk", f"Rule.check loop int n={n}", lambda: [rule.check(v) for v in values], n),
+  ]
+
+
+async def plain_fetch(n: int) -> int:
+  return n
+
+
+@guard
+async def guard_fetch(n: int) -> int:
+  return n
 
-  for name, ns, category in results:
-    if category == "func":
-      overhead = f"{(ns / baseline_func):.2f}x"
-    else:
-      overhead = "N/A"
 
-    print(f"{name:<25} | {ns:<15.2f} | {overhead:<15}")
+async def wrapper_fetch(n: int) -> int:
+  # What a pure-Python async guard costs: an extra coroutine frame per await
+  result = await plain_fetch(n)
+  if type(result) is not int:
+    raise TypeError("expected int")
+  return result
 
-  print("=" * 65 + "\n")
+
+def plain_count(n: int) -> Iterator[int]:
+  yield from range(n)
+
+
+@guard
+def guard_count(n: int) -> Iterator[int]:
+  yield from range(n)
+
+
+async def _await_each(fetch, n: int):
+  for i in range(n):
+    await fetch(i)
+
+
+def _awaits(fetch, n: int):
+  # One coroutine awaiting n calls, driven without an event loop: none of them suspends
+  def call():
+    try:
+      _await_each(fetch, n).send(None)
+    except StopIteration:
+      pass
+  return call
+
+
+@suite("flow")
+def flow_cases(quick: bool):
+  n = 1_000
+  return [
+    Case("flow", f"await async def n={n}", _awaits(plain_fetch, n), n),
+    Case("flow", f"await @guard async def -> int n={n}", _awaits(guard_fetch, n), n),
+    Case("flow", f"await python wrapper n={n}", _awaits(wrapper_fetch, n), n),
+    Case("flow", f"generator n={n}", lambda: list(plain_count(n)), n),
+    Case("flow", f"@guard generator -> Iterator[int] n={n}", lambda: list(guard_count(n)), n),
+  ]
+
+
+class _Workers:
+  """Daemon threads that each run their own work() once per round; one round is one timed call."""
+
+  def __init__(self, works):
+    self.start = threading.Barrier(len(works) + 1)
+    self.done = threading.Barrier(len(works) + 1)
+    for work in works:
+      threading.Thread(target=self._loop, args=(work,), daemon=True).start()
+
+  def _loop(self, work):
+    while True:
+      self.start.wait()
+      work()
+      self.done.wait()
+
+  def round(self):
+    self.start.wait()
+    self.done.wait()
+
+
+def _thread_counts(quick: bool) -> tuple:
+  counts = (1, 4) if quick else (1, 2, 4, 8)
+  return tuple(n for n in counts if n == 1 or n <= (os.cpu_count() or 1))
+
+
+@suite("threads")
+def thread_cases(quick: bool):
+  # Every worker checks its own data against shared guards and Shield classes, so ns / element
+  # is wall time per operation across all threads: flat with the GIL, falling as threads are
+  # added on a free-threaded build.
+  rounds = 2_000
+
+  def guard_calls():
+    for _ in range(rounds):
+      guard_add(1, 2)
+
+  def guard_payload():
+    payload = {"a": list(range(100)), "b": list(range(100))}
+    def work():
+      for _ in range(rounds // 20):
+        ingest(payload)
+    return work
+
+  def shield_sets():
+    cat = ShieldCat("Luna", 3)
+    def work():
+      for age in range(rounds):
+        cat.age = age
+    return work
+
+  cases = []
+  for threads in _thread_counts(quick):
+    workers = _Workers([guard_calls] * threads)
+    cases.append(Case("threads", f"@guard threads={threads}", workers.round, rounds * threads))
+    workers = _Workers([guard_payload() for _ in range(threads)])
+    cases.append(Case("threads", f"@guard dict[str, list[int]] threads={threads}", workers.round, rounds // 20 * threads))
+    workers = _Workers([shield_sets() for _ in range(threads)])
+    cases.append(Case("threads", f"shield attr set threads={threads}", workers.round, rounds * threads))
+  return cases
+
+
+# ==========================================
+# RUNNER
+# ==========================================
+
+def measure(fn, repeat: int, min_time: float) -> list:
+  """Per-call seconds for each repeat; the loop count is calibrated so a repeat lasts about min_time."""
+  timer = timeit.Timer(fn)
+  number = 1
+  while True:
+    elapsed = timer.timeit(number)
+    if elapsed >= min_time:
+      break
+    number = max(number * 2, int(number * min_time / max(elapsed, 1e-9) * 1.1))
+  return [t / number for t in timer.repeat(repeat=repeat, number=number)]
+
+
+def run(groups, pattern: str | None, quick: bool) -> list:
+  repeat, min_time = (3, 0.02) if quick else (7, 0.1)
+  results = []
+  for group in groups:
+    for case in SUITES[group](quick):
+      label = f"{case.group}: {case.name}"
+      if pattern and pattern.lower() not in label.lower():
+        continue
+      times = measure(case.fn, repeat, min_time)
+      best, median = min(times) * 1e9, statistics.median(times) * 1e9
+      results.append({"group": case.group, "name": case.name, "ns": best, "median_ns": median,
+                      "elements": case.elements, "ns_per_element": best / case.elements})
+      print(f"{label:<52} {best:>12.1f} ns {median:>12.1f} med"
+            + (f" {best / case.elements:>9.2f} ns/elem" if case.elements > 1 else ""), flush=True)
+  return results
+
+
+def metadata() -> dict:
+  return {
+    "guardian": guardian.__version__,
+    "python": sys.version.split()[0],
+    "implementation": platform.python_implementation(),
+    "gil": getattr(sys, "_is_gil_enabled", lambda: True)(),
+    "platform": platform.platform(),
+    "machine": platform.machine(),
+    "timestamp": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+  }
+
+
+def compare(results: list, baseline_path: str, threshold: float) -> int:
+  """Prints per-case changes against a baseline run; returns how many cases regressed past threshold %."""
+  with open(baseline_path, encoding="utf-8") as f:
+    baseline = {(r["group"], r["name"]): r for r in json.load(f)["results"]}
+  regressions = 0
+  print(f"\n{'Case':<52} {'Base ns':>12} {'Now ns':>12} {'Change':>8}")
+  for r in results:
+    base = baseline.get((r["group"], r["name"]))
+    if base is None:
+      continue
+    change = (r["ns"] / base["ns"] - 1) * 100
+    flag = ""
+    if change > threshold:
+      regressions += 1
+      flag = "  REGRESSION"
+    print(f"{r['group'] + ': ' + r['name']:<52} {base['ns']:>12.1f} {r['ns']:>12.1f} {change:>+7.1f}%{flag}")
+  return regressions
+
+
+def main(argv=None) -> int:
+  parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument("groups", nargs="*", help=f"suites to run (default: all of {', '.join(SUITES)})")
+  parser.add_argument("-k", dest="pattern", help="only run cases whose 'group: name' contains this text")
+  parser.add_argument("--quick", action="store_true", help="fewer sizes and repeats")
+  parser.add_argument("--json", dest="json_path", help="write results to this file")
+  parser.add_argument("--compare", dest="baseline", help="compare against a --json file from an earlier run")
+  parser.add_argument("--threshold", type=float, default=10.0, help="regression threshold in percent (default 10)")
+  args = parser.parse_args(argv)
+  unknown = set(args.groups) - set(SUITES)
+  if unknown:
+    parser.error(f"unknown suite(s): {', '.join(sorted(unknown))}")
+
+  meta = metadata()
+  print(f"guardian {meta['guardian']} on {meta['implementation']} {meta['python']} ({meta['machine']})"
+        + ("" if meta["gil"] else ", free-threaded"))
+  results = run(args.groups or list(SUITES), args.pattern, args.quick)
+  if args.json_path:
+    with open(args.json_path, "w", encoding="utf-8") as f:
+      json.dump({"meta": meta, "results": results}, f, indent=2)
+  if args.baseline and compare(results, args.baseline, args.threshold):
+    return 1
+  return 0
 
 
 if __name__ == "__main__":
-  # You can increase this to 1_000_000 if you want an even more stable average
-  run_benchmarks(iterations=100_000)
\ No newline at end of file
+  sys.exit(main())
@@ -1,6 +1,19 @@
+import os
+
 from .guard_set import guard, deepguard
 from .shield import Shield
-from ._guardian_core import GuardianTypeError, GuardianAccessError
+from ._compiler import Buffer
+from .validation import validate, validate_many, validate_columns, set_max_depth
+from .instrumentation import stats, enable_stats, disable_stats, reset_stats
+from ._guardian_core import GuardianTypeError, GuardianAccessError, GuardedList, GuardedDict, GuardedSet
+
+__all__ = ["guard", "deepguard", "Shield", "GuardianTypeError", "GuardianAccessError",
+           "GuardedList", "GuardedDict", "GuardedSet", "Buffer",
+           "validate", "validate_many", "validate_columns", "set_max_depth",
+           "stats", "enable_stats", "disable_stats", "reset_stats", "get_include"]
+__version__ = "2.1.6"
+
 
-__all__ = ["guard", "deepguard", "Shield", "GuardianTypeError", "GuardianAccessError"]
-__version__ = "2.1.6"
\ No newline at end of file
+def get_include() -> str:
+    """Directory holding guardian_capi.h, for C extensions that call the core's checker directly."""
+    return os.path.join(os.path.dirname(__file__), "include")
\ No newline at end of file
@@ -1,6 +1,13 @@
+import dataclasses
+import functools
+import math
+import sys
+import threading
 import types
 import typing
-from typing import Any, Literal, get_args, get_origin, Annotated, Union
+from typing import Any, Literal, Optional, get_args, get_origin, Annotated, Union
+
+from . import _guardian_core
 
 OP_ANY = 0
 OP_INSTANCE = 1
@@ -12,6 +19,94 @@ OP_TUPLE_VAR = 6
 OP_TUPLE_FIXED = 7
 OP_SET = 8
 OP_LITERAL = 9
+OP_UNION_DISPATCH = 10
+OP_TAGGED_UNION = 11
+OP_BUFFER = 12
+OP_TYPED_DICT = 13
+OP_NAMED_TUPLE = 14
+OP_DATACLASS = 15
+OP_PROTOCOL = 16
+OP_REF = 17
+
+PRIMITIVES = {int, str, float, bool, type(None)}
+
+# Unions at least this wide get a type->branch dispatch table when their branches allow it.
+DISPATCH_MIN_BRANCHES = 4
+
+_CONTAINER_HEADS = {
+    OP_LIST: (list,),
+    OP_DICT: (dict,),
+    OP_SET: (set, frozenset),
+    OP_TUPLE_VAR: (tuple,),
+    OP_TUPLE_FIXED: (tuple,),
+    OP_TYPED_DICT: (dict,),
+}
+
+# TypedDict item qualifiers that do not change the value's type
+_ITEM_QUALIFIERS = tuple(q for q in (getattr(typing, "Required", None), getattr(typing, "NotRequired", None),
+                                     getattr(typing, "ReadOnly", None)) if q is not None)
+
+# PEP 695 `type X = ...` aliases (3.12+)
+_TypeAliasType = getattr(typing, "TypeAliasType", None)
+
+# Models and aliases being compiled on this thread, each mapped to whether its own body
+# referred back to it. Such a reference compiles to an OP_REF back-edge. `unresolved` is
+# set when a forward reference forced a fallback, so the result must not be cached.
+_compiling = threading.local()
+
+
+@dataclasses.dataclass(frozen=True, repr=False)
+class Buffer:
+    """
+    Hint for PEP 3118 buffers (bytes, bytearray, memoryview, array.array, NumPy arrays, ...),
+    checked through the buffer view without converting the items to Python objects.
+    Use it as a hint on its own to accept any exporter, or as Annotated metadata to also
+    require the exporter type::
+
+        Annotated[array.array, Buffer("d", ndim=1, ge=0.0, le=1.0)]
+
+    :param format: accepted struct format code(s), e.g. "d" or ("f", "d"); native "@" is implied.
+    :param itemsize: required item size in bytes.
+    :param ndim: required number of dimensions.
+    :param ge: inclusive lower bound for every item (native numeric formats only).
+    :param le: inclusive upper bound for every item. NaN never satisfies a range.
+    """
+    format: Union[str, tuple, None] = None
+    itemsize: Optional[int] = None
+    ndim: Optional[int] = None
+    ge: Optional[float] = None
+    le: Optional[float] = None
+
+    def __post_init__(self):
+        if isinstance(self.format, str):
+            object.__setattr__(self, "format", (self.format,))
+        if self.format is not None:
+            object.__setattr__(self, "format", tuple(f[1:] if f.startswith("@") else f for f in self.format))
+        for bound in (self.ge, self.le):
+            if bound is None or (isinstance(bound, int) and not isinstance(bound, bool)):
+                continue
+            if not isinstance(bound, float) or math.isnan(bound):
+                raise TypeError(f"Buffer bounds must be real numbers, got {bound!r}")
+
+    def __repr__(self):
+        parts = []
+        if self.format is not None:
+            parts.append(repr(self.format[0]) if len(self.format) == 1 else repr(self.format))
+        parts += [f"{name}={getattr(self, name)!r}" for name in ("itemsize", "ndim", "ge", "le")
+                  if getattr(self, name) is not None]
+        return f"Buffer({', '.join(parts)})"
+
+    def rule(self, exporter: Any = None) -> tuple:
+        """The (OP_BUFFER, spec) rule for this buffer, optionally requiring an exporter type."""
+        exporter = get_origin(exporter) or exporter
+        if exporter is Any or exporter is object or not isinstance(exporter, type):
+            exporter = None
+        return (OP_BUFFER, (exporter, self.format, self.itemsize or 0,
+                            -1 if self.ndim is None else self.ndim, self.ge, self.le))
+
+
+def _buffer_metadata(args: tuple):
+    return next((meta for meta in args[1:] if isinstance(meta, Buffer)), None)
 
 
 def format_type_name(tp: Any) -> str:
@@ -21,7 +116,12 @@ def format_type_name(tp: Any) -> str:
         return " | ".join(format_type_name(a) for a in args)
     if origin is Literal:
         return f"Literal[{', '.join(repr(a) for a in args)}]"
+    if isinstance(tp, Buffer):
+        return repr(tp)
     if origin is Annotated:
+        buffer = _buffer_metadata(args)
+        if buffer is not None:
+            return f"{format_type_name(args[0])}[{buffer!r}]"
         return format_type_name(args[0])
     if tp is Ellipsis:
         return "..."
@@ -40,11 +140,29 @@ def compile_rule(expected_type: Any) -> tuple:
     origin = get_origin(expected_type)
     args = get_args(expected_type)
 
+    alias = origin if origin is not None else expected_type
+    if _TypeAliasType is not None and isinstance(alias, _TypeAliasType):
+        # Type parameters are not substituted: they compile like any other TypeVar
+        return _compile_recursive(alias, lambda: _compile_alias_value(alias))
+
+    if isinstance(expected_type, Buffer):
+        return expected_type.rule()
+
     if origin is Annotated:
+        buffer = _buffer_metadata(args)
+        if buffer is not None:
+            return buffer.rule(args[0])
         return compile_rule(args[0])
 
     if origin is Union or isinstance(expected_type, types.UnionType):
-        return (OP_UNION, tuple(compile_rule(a) for a in args))
+        branches = tuple(compile_rule(a) for a in args)
+        tagged = _compile_tagged_union(args, branches)
+        if tagged is not None:
+            return tagged
+        table = _dispatch_table(branches)
+        if table is not None:
+            return (OP_UNION_DISPATCH, (branches, table))
+        return (OP_UNION, branches)
 
     if origin is Literal:
         return (OP_LITERAL, tuple(args))
@@ -67,6 +185,9 @@ def compile_rule(expected_type: Any) -> tuple:
             return (OP_TUPLE_VAR, compile_rule(args[0]))
         return (OP_TUPLE_FIXED, tuple(compile_rule(a) for a in args))
 
+    if typing.is_typeddict(expected_type):
+        return _compile_structural(expected_type, (OP_INSTANCE, dict), _compile_typed_dict)
+
     target_type = origin or expected_type
     if not isinstance(target_type, type):
         target_type = type(None) if expected_type is type(None) else Any
@@ -74,4 +195,222 @@ def compile_rule(expected_type: Any) -> tuple:
     if target_type is Any:
         return (OP_ANY, None)
 
-    return (OP_INSTANCE, target_type)
\ No newline at end of file
+    if getattr(target_type, "_is_protocol", False) and target_type is not typing.Protocol:
+        return (OP_PROTOCOL, (target_type, tuple(sorted(_protocol_attrs(target_type)))))
+
+    if issubclass(target_type, tuple) and hasattr(target_type, "_fields"):
+        return _compile_structural(target_type, (OP_INSTANCE, target_type), _compile_named_tuple)
+
+    # Guardian dataclasses validate every field on assignment, so an instance is already sound
+    if dataclasses.is_dataclass(target_type) and "__guardian_fields__" not in target_type.__dict__:
+        return _compile_structural(target_type, (OP_INSTANCE, target_type), _compile_dataclass)
+
+    return (OP_INSTANCE, target_type)
+
+
+def _compile_recursive(key: Any, compile_body) -> tuple:
+    """
+    Compiles the body of a model or alias. A reference back to key from inside its own
+    body becomes (OP_REF, key), and the body is then declared as (OP_REF, (key, body)).
+    """
+    active = _compiling.__dict__.setdefault("keys", {})
+    if key in active:
+        active[key] = True
+        return (OP_REF, key)
+    active[key] = False
+    try:
+        body = compile_body()
+        referenced = active[key]
+    finally:
+        del active[key]
+    if not referenced:
+        return body
+    if body == (OP_REF, key):  # `type A = A` constrains nothing
+        return (OP_ANY, None)
+    return (OP_REF, (key, body))
+
+
+def _compile_alias_value(alias: Any) -> tuple:
+    try:
+        value = alias.__value__  # evaluated on first access, so it may name undefined types
+    except Exception:
+        _compiling.unresolved = True
+        return (OP_ANY, None)
+    return compile_rule(value)
+
+
+def _compile_structural(tp: type, nominal: tuple, compile_fields) -> tuple:
+    """Compiles a model's fields, or returns the nominal rule when its hints cannot be resolved."""
+    def compile_body():
+        try:
+            hints = typing.get_type_hints(tp, include_extras=True)
+        except Exception:
+            _compiling.unresolved = True
+            return nominal
+        return compile_fields(tp, hints) or nominal
+
+    return _compile_recursive(tp, compile_body)
+
+
+def _unqualified(hint: Any) -> Any:
+    while get_origin(hint) in _ITEM_QUALIFIERS:
+        hint = get_args(hint)[0]
+    return hint
+
+
+def _compile_typed_dict(tp: type, hints: dict):
+    required = tp.__required_keys__
+    keys = tuple(sys.intern(key) for key in hints)
+    return (OP_TYPED_DICT, (keys, tuple(key in required for key in keys),
+                            tuple(compile_rule(_unqualified(hints[key])) for key in keys)))
+
+
+def _compile_named_tuple(tp: type, hints: dict):
+    rules = tuple(compile_rule(hints.get(name, Any)) for name in tp._fields)
+    if all(rule[0] == OP_ANY for rule in rules):
+        return None
+    return (OP_NAMED_TUPLE, (tp, rules))
+
+
+def _compile_dataclass(tp: type, hints: dict):
+    # init=False fields may legitimately be unset, so only constructor fields are checked
+    fields = [(sys.intern(f.name), compile_rule(hints.get(f.name, Any))) for f in dataclasses.fields(tp) if f.init]
+    fields = [(name, rule) for name, rule in fields if rule[0] != OP_ANY]
+    if not fields:
+        return None
+    return (OP_DATACLASS, (tp, tuple(name for name, _ in fields), tuple(rule for _, rule in fields)))
+
+
+def _protocol_attrs(tp: type) -> set:
+    attrs = getattr(tp, "__protocol_attrs__", None)  # 3.12+
+    if attrs is None:
+        attrs = typing._get_protocol_attrs(tp)
+    return {sys.intern(name) for name in attrs}
+
+
+def _branch_heads(rule: tuple):
+    """Returns the concrete types a branch can accept directly, or None if it is not type-keyed."""
+    op, arg = rule
+    if op in (OP_EXACT, OP_INSTANCE) and isinstance(arg, type):
+        # A metaclass with its own __instancecheck__ (ABCs, protocols) can accept unrelated types.
+        if type(arg).__instancecheck__ is not type.__instancecheck__:
+            return None
+        return (arg,)
+    if op in (OP_NAMED_TUPLE, OP_DATACLASS) and type(arg[0]).__instancecheck__ is type.__instancecheck__:
+        return (arg[0],)
+    if op == OP_LITERAL:
+        return tuple({type(value): None for value in arg})  # literals match their exact type only
+    if op == OP_REF:
+        return _branch_heads(arg[1]) if isinstance(arg, tuple) else None  # a declaration heads like its body
+    return _CONTAINER_HEADS.get(op)
+
+
+def _dispatch_table(branches: tuple):
+    """
+    Builds {concrete type: branch index} for a union whose branches are keyed by
+    pairwise unrelated types, so a value's exact type selects the only branch that
+    could accept it. Returns None when the union is too narrow or the heads overlap.
+    """
+    if len(branches) < DISPATCH_MIN_BRANCHES:
+        return None
+    table = {}
+    for index, branch in enumerate(branches):
+        heads = _branch_heads(branch)
+        if heads is None:
+            return None
+        for head in heads:
+            if any(issubclass(head, other) or issubclass(other, head) for other in table):
+                return None
+            table[head] = index
+    return table
+
+
+def _literal_tag_values(hint: Any):
+    if get_origin(hint) is Annotated:
+        hint = get_args(hint)[0]
+    if get_origin(hint) is Literal:
+        return get_args(hint)
+    return None
+
+
+def _compile_tagged_union(members: tuple, branches: tuple):
+    """
+    Recognizes a union of dataclasses or TypedDicts that share a Literal-typed
+    discriminator field and compiles it to a tag -> branch lookup.
+    """
+    if len(members) < 2:
+        return None
+    if all(typing.is_typeddict(m) for m in members):
+        is_mapping = True
+    elif all(isinstance(m, type) and dataclasses.is_dataclass(m) for m in members):
+        is_mapping = False
+    else:
+        return None
+
+    try:
+        member_hints = [typing.get_type_hints(m) for m in members]
+    except Exception:
+        return None
+
+    for tag_name in member_hints[0]:
+        table = {}
+        for index, hints in enumerate(member_hints):
+            values = _literal_tag_values(hints.get(tag_name))
+            if not values or any(v in table for v in values):
+                table = None
+                break
+            for value in values:
+                table[value] = index
+        if table is not None:
+            return (OP_TAGGED_UNION, (tag_name, table, branches, is_mapping))
+    return None
+
+
+def compile_program(expected_type: Any, exact_primitives: bool = False):
+    """
+    Compiles a type hint and lowers it into a flat C rule program.
+    Equal hints share one Rule, so a codebase annotating thousands of parameters with
+    the same few types compiles each of them once. The cache holds its hints, and the
+    classes they name, strongly until they are evicted (8192 entries, least recently
+    used first). A hint whose forward references do not resolve yet compiles to its
+    nominal fallback and is not cached, so it is compiled again once they do.
+
+    :param exact_primitives: If True, a bare primitive hint (int, str, ...) is
+        matched by exact type instead of isinstance, so e.g. bool is rejected for int.
+    """
+    compile_ = _cached_program
+    try:
+        hash(expected_type)
+    except TypeError:  # e.g. Annotated metadata holding a list
+        compile_ = _compile_program
+    try:
+        return compile_(expected_type, exact_primitives)
+    except _Unresolved as fallback:
+        return fallback.program
+
+
+class _Unresolved(Exception):
+    """Carries a program built from fallbacks out of _cached_program, which does not cache exceptions."""
+
+    def __init__(self, program):
+        super().__init__()
+        self.program = program
+
+
+def _compile_program(expected_type: Any, exact_primitives: bool):
+    outer = getattr(_compiling, "unresolved", False)
+    _compiling.unresolved = False
+    try:
+        raw_rule = compile_rule(expected_type)
+        unresolved = _compiling.unresolved
+    finally:
+        _compiling.unresolved = outer
+    if exact_primitives and raw_rule[0] == OP_INSTANCE and raw_rule[1] is expected_type and expected_type in PRIMITIVES:
+        raw_rule = (OP_EXACT, raw_rule[1])
+    program = _guardian_core.lower_rule(raw_rule)
+    if unresolved:
+        raise _Unresolved(program)
+    return program
+
+
+_cached_program = functools.lru_cache(maxsize=8192)(_compile_program)
@@ -1,41 +1,40 @@
-import dataclasses
 from typing import Optional
 
+from . import _guardian_core
+
 
 def dump_dict(obj, include: Optional[set] = None, exclude: Optional[set] = None, recursive: bool = True, **overrides) -> dict:
     """
     Serializes a guardian dataclass to a dictionary.
     Prioritizes __guardian_serialize__ hooks, falling back to standard extraction.
+    Nested dataclasses inside lists, tuples and dict values are converted as well;
+    include/exclude/overrides apply to the top-level object only.
     """
-    if hasattr(obj, "__guardian_serialize__"):
-        return obj.__guardian_serialize__()
-
-    result = {}
-    for field in dataclasses.fields(obj):
-        name = field.name
-
-        if include and name not in include:
-            continue
-        if exclude and name in exclude:
-            continue
+    return _guardian_core.dump_dict(obj, include, exclude, recursive, overrides)
 
-        # Handle temporary overrides
-        if name in overrides:
-            result[name] = overrides[name]
-            continue
 
-        value = getattr(obj, name)
+def dump_json(obj, include: Optional[set] = None, exclude: Optional[set] = None) -> bytes:
+    """
+    Serializes a guardian dataclass straight to compact UTF-8 JSON bytes, without building
+    intermediate dicts. Equivalent to json.dumps(dump_dict(obj), separators=(",", ":"),
+    ensure_ascii=False).encode().
+    """
+    return _guardian_core.dump_json(obj, include, exclude)
 
-        if recursive and dataclasses.is_dataclass(value):
-            result[name] = dump_dict(value, recursive=True)
-        elif recursive and isinstance(value, list) and len(value) > 0 and dataclasses.is_dataclass(value[0]):
-            result[name] = [dump_dict(item, recursive=True) for item in value]
-        else:
-            result[name] = value
+def from_dict(cls, data: dict):
+    """
+    Builds a guardian dataclass from a dict, validating every field against its compiled rule
+    and running @validator hooks. Nested dataclass fields (also inside list/dict/Optional
+    annotations) are built from nested dicts in the same traversal. Errors are prefixed with
+    the failing path, e.g. "lines[1].sku: ...", which is also available as ``exc.path``.
+    """
+    return _guardian_core.from_dict(cls, data)
 
-    # Apply any overrides that weren't standard fields
-    for k, v in overrides.items():
-        if k not in result:
-            result[k] = v
 
-    return result
\ No newline at end of file
+def from_json(cls, data):
+    """
+    Parses JSON (bytes, bytearray, memoryview or str) straight into a guardian dataclass.
+    Object members are bound to fields as they are parsed; no intermediate dicts are built for
+    dataclass-typed values. Malformed input raises ValueError with the byte offset.
+    """
+    return _guardian_core.from_json(cls, data)
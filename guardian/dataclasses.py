@@ -1,15 +1,42 @@
 import dataclasses
+import inspect
+import types
 import typing
 from typing import dataclass_transform, TypeVar, Callable, Any
 
-from ._compiler import compile_rule, format_type_name
+from ._compiler import compile_program
 from . import _guardian_core
-from ._serialization import dump_dict
+from ._serialization import dump_dict, dump_json, from_dict, from_json
 
 asdict = dump_dict  # Alias for convenience
 
 T = TypeVar("T")
 
+# Field flags understood by the native __init__ (mirrors INIT_FIELD_* in _guardian_core.c)
+_INIT_PARAM, _INIT_KW_ONLY, _INIT_DEFAULT, _INIT_FACTORY = 0x1, 0x2, 0x4, 0x8
+
+
+def _nested_shape(tp: Any) -> Any:
+    """
+    Describes where guardian dataclasses sit inside a field type, so from_dict/from_json can
+    build nested payloads: a dataclass, (shape,) for list items, (None, shape) for dict values.
+    """
+    if isinstance(tp, type) and "__guardian_init__" in tp.__dict__:
+        return tp
+    origin, args = typing.get_origin(tp), typing.get_args(tp)
+    if origin is typing.Annotated:
+        return _nested_shape(args[0])
+    if origin is list and args:
+        inner = _nested_shape(args[0])
+        return (inner,) if inner is not None else None
+    if origin is dict and len(args) == 2:
+        inner = _nested_shape(args[1])
+        return (None, inner) if inner is not None else None
+    if origin in (typing.Union, types.UnionType):
+        shapes = [shape for shape in map(_nested_shape, args) if shape is not None]
+        return shapes[0] if len(shapes) == 1 else None
+    return None
+
 
 # 1. Define the custom exception, inheriting from the standard one for compatibility
 class FrozenInstanceError(dataclasses.FrozenInstanceError):
@@ -55,10 +82,13 @@ def dataclass(
     }
 
     def wrap(cls: type[T]) -> type[T]:
+        # Only replace an __init__ the standard library generates, never a user-defined one
+        native_init = init and '__init__' not in cls.__dict__
+
         # 1. Standard library generation
         dc_cls = dataclasses.dataclass(**std_kwargs)(cls)
         
-        hints = typing.get_type_hints(dc_cls)
+        hints = typing.get_type_hints(dc_cls, include_extras=True)
         custom_validators = {}
         
         for attr_name in dir(dc_cls):
@@ -66,40 +96,72 @@ def dataclass(
             if hasattr(attr, "__guardian_validator__"):
                 custom_validators[attr.__guardian_validator__] = attr
 
-        compiled_rules = {}
-
-        # 2. Inject C-Descriptors
-        
+        # Slotted classes keep each value in its member slot; the descriptor writes there directly.
+        # Otherwise values live in the instance dict under a private "_name" key.
+        def storage_for(name: str) -> Any:
+            if slots:
+                for klass in dc_cls.__mro__:
+                    attr = klass.__dict__.get(name)
+                    if isinstance(attr, _guardian_core.CFieldDescriptor):
+                        return attr.storage  # inherited from a guardian dataclass base
+                    if isinstance(attr, types.MemberDescriptorType):
+                        return attr
+            return f"_{name}"
+
+        # 2. Inject C-Descriptors. Frozen classes get them too: instance assignment is refused by
+        # _frozen_setattr before the descriptor is reached, while construction stores through it.
+        init_fields = []
+        field_table = []
         for field in dataclasses.fields(dc_cls): # type: ignore[arg-type]
             expected_type = hints.get(field.name, typing.Any)
-            raw_rule = compile_rule(expected_type)
-            expected_name = format_type_name(expected_type)
+            raw_rule = compile_program(expected_type)
             
             custom_val = custom_validators.get(field.name, None)
-            
-            compiled_rules[field.name] = (raw_rule, expected_name, custom_val)
-
-            if not frozen:
-                c_descriptor = _guardian_core.make_c_descriptor(
-                    field.name, 
-                    f"_{field.name}", 
-                    raw_rule, 
-                    expected_name, 
-                    custom_val
-                )
-                setattr(dc_cls, field.name, c_descriptor)
-
-        # 3. Frozen Model Handling
+
+            c_descriptor = _guardian_core.make_c_descriptor(
+                field.name, 
+                storage_for(field.name), 
+                raw_rule, 
+                expected_type,  # the C core formats it only when a check fails
+                custom_val
+            )
+            setattr(dc_cls, field.name, c_descriptor)
+            field_table.append(c_descriptor)
+
+            flags = (_INIT_PARAM if field.init else 0) | (_INIT_KW_ONLY if field.kw_only else 0)
+            fallback = None
+            if field.default is not dataclasses.MISSING:
+                flags, fallback = flags | _INIT_DEFAULT, field.default
+            elif field.default_factory is not dataclasses.MISSING:
+                flags, fallback = flags | _INIT_FACTORY, field.default_factory
+            elif not field.init:
+                continue  # never assigned by __init__
+            init_fields.append((c_descriptor, flags, fallback, _nested_shape(expected_type)))
+
+        # Read by the native serializers (dump_dict / dump_json)
+        dc_cls.__guardian_fields__ = tuple(field_table)
+
+        # 3. Native single-pass constructor. InitVar pseudo-fields are forwarded to __post_init__,
+        # which the native init does not model; those classes keep the stdlib init, which still
+        # validates every assignment through the descriptors above. The plan is published as
+        # __guardian_init__ either way; from_dict/from_json go through cls(**kwargs) when it is
+        # not the class's constructor.
+        has_init_var = any(isinstance(hints.get(name), dataclasses.InitVar) or hints.get(name) is dataclasses.InitVar
+                           for name in dc_cls.__dataclass_fields__)
+        use_native_init = native_init and not has_init_var
+        init_plan = _guardian_core.make_dataclass_init(
+            dc_cls.__qualname__,
+            init_fields,
+            hasattr(dc_cls, "__post_init__"),
+            inspect.signature(dc_cls.__init__) if init else None,
+            not use_native_init,
+        )
+        dc_cls.__guardian_init__ = init_plan
+        if use_native_init:
+            dc_cls.__init__ = init_plan
+
+        # 4. Frozen Model Handling
         if frozen:
-            original_init = dc_cls.__init__
-            def frozen_init(self, *args, **init_kwargs):
-                original_init(self, *args, **init_kwargs)
-                for name, (rule, exp_name, custom_v) in compiled_rules.items():
-                    val = getattr(self, name)
-                    c_desc = _guardian_core.make_c_descriptor(name, f"_{name}", rule, exp_name, custom_v)
-                    c_desc.__set__(self, val) 
-            dc_cls.__init__ = frozen_init
-            
             # --- OVERRIDE STANDARD FREEZE HOOKS HERE ---
             dc_cls.__setattr__ = _frozen_setattr
             dc_cls.__delattr__ = _frozen_delattr
@@ -1,14 +1,16 @@
+import os
+import sys
+import types
 import typing
 import inspect
 import ast
 import textwrap
+import collections.abc
 from typing import Callable, Any
 
-from ._compiler import compile_rule, format_type_name
+from ._compiler import compile_program, PRIMITIVES
 from . import _guardian_core
 
-PRIMITIVES = {int, str, float, bool, type(None)}
-
 
 def _extract_local_annotations(func: Callable) -> dict:
     """Parses the function AST to extract local variable annotations."""
@@ -32,36 +34,101 @@ def _extract_local_annotations(func: Callable) -> dict:
                 pass
     return local_hints
 
-def _compile_signature(func: Callable):
-  """Pre-compiles signatures into aligned positional arrays and kwarg dictionaries for O(1) C-lookups."""
+# sys.monitoring tool ids not reserved for debuggers (0), coverage (1), profilers (2) or optimizers (5)
+_DEEPGUARD_TOOL_IDS = (4, 3)
+_deepguard_tool = None
+
+
+def _claim_deepguard_tool():
+  """
+  Claims a sys.monitoring tool id for deepguard and registers its PY_RETURN callback
+  (Python 3.12+). Returns None when monitoring is unavailable or every candidate id is
+  taken, in which case deepguard falls back to a profiler scoped to the guarded call.
+  """
+  global _deepguard_tool
+  monitoring = getattr(sys, "monitoring", None)
+  if monitoring is None or _deepguard_tool is not None:
+    return _deepguard_tool
+  for tool_id in _DEEPGUARD_TOOL_IDS:
+    if monitoring.get_tool(tool_id) is None:
+      monitoring.use_tool_id(tool_id, "guardian.deepguard")
+      monitoring.register_callback(tool_id, monitoring.events.PY_RETURN, _guardian_core.deepguard_on_return)
+      _deepguard_tool = tool_id
+      break
+  return _deepguard_tool
+
+
+def _needs_resolution(hint: Any) -> bool:
+  """True if a hint still holds string forward references that get_type_hints would evaluate."""
+  if isinstance(hint, (str, typing.ForwardRef)):
+    return True
+  if isinstance(hint, list):  # Callable[[...], R] parameter lists
+    return any(_needs_resolution(arg) for arg in hint)
+  origin = typing.get_origin(hint)
+  if origin is typing.Literal:
+    return False
+  if origin is typing.Annotated:
+    return _needs_resolution(hint.__origin__)
+  return any(_needs_resolution(arg) for arg in typing.get_args(hint))
 
+
+def _resolved_hints(func: Callable) -> dict:
+  annotations = getattr(func, '__annotations__', None)
+  if not annotations:
+    return {}
+  # Most annotations are already live objects; get_type_hints only matters for forward references
+  if not any(_needs_resolution(hint) for hint in annotations.values()):
+    return {name: type(None) if hint is None else hint for name, hint in annotations.items()}
   # FIX: Resolve string forward references (like 'int') into actual type objects
   try:
-    resolved_hints = typing.get_type_hints(func)
+    return typing.get_type_hints(func, include_extras=True)
   except Exception:
-    resolved_hints = getattr(func, '__annotations__', {})
+    return annotations
+
+
+def _parameters(func: Callable):
+  """Yields (name, is_positional) per parameter, in signature order."""
+  if type(func) is types.FunctionType and not hasattr(func, '__wrapped__') and '__signature__' not in func.__dict__:
+    # Plain functions: read the code object instead of building an inspect.Signature
+    code = func.__code__
+    names = code.co_varnames
+    n_pos, n_kwonly = code.co_argcount, code.co_kwonlyargcount
+    for name in names[:n_pos]:
+      yield name, True
+    extra = n_pos + n_kwonly
+    if code.co_flags & inspect.CO_VARARGS:
+      yield names[extra], False
+      extra += 1
+    for name in names[n_pos:n_pos + n_kwonly]:
+      yield name, False
+    if code.co_flags & inspect.CO_VARKEYWORDS:
+      yield names[extra], False
+    return
+  for name, param in inspect.signature(func).parameters.items():
+    yield name, param.kind in (inspect.Parameter.POSITIONAL_ONLY, inspect.Parameter.POSITIONAL_OR_KEYWORD)
 
-  sig = inspect.signature(func)
+
+def _compile_signature(func: Callable):
+  """Pre-compiles signatures into aligned positional arrays and kwarg dictionaries for O(1) C-lookups."""
+  resolved_hints = _resolved_hints(func)
   pos_rules = []
   kw_rules = {}
 
-  for name, param in sig.parameters.items():
+  for name, is_positional in _parameters(func):
     # Read the resolved actual type, falling back to empty if un-annotated
     annotation = resolved_hints.get(name, inspect.Parameter.empty)
 
-    if annotation != inspect.Parameter.empty:
-      raw_rule = compile_rule(annotation)
-      if annotation in PRIMITIVES and raw_rule[0] == 1:
-        raw_rule = (2, raw_rule[1])
+    if annotation is not inspect.Parameter.empty:
+      raw_rule = compile_program(annotation, exact_primitives=True)
 
-      rule_def = (name, format_type_name(annotation), raw_rule)
+      # The hint doubles as the expected name; the C core formats it only when a check fails
+      rule_def = (name, annotation, raw_rule)
       kw_rules[name] = rule_def
 
-      if param.kind in (inspect.Parameter.POSITIONAL_ONLY, inspect.Parameter.POSITIONAL_OR_KEYWORD):
+      if is_positional:
         pos_rules.append(rule_def)
-    else:
-      if param.kind in (inspect.Parameter.POSITIONAL_ONLY, inspect.Parameter.POSITIONAL_OR_KEYWORD):
-        pos_rules.append(None)
+    elif is_positional:
+      pos_rules.append(None)
 
   ret_rule = None
   ret_name = ""
@@ -69,36 +136,99 @@ def _compile_signature(func: Callable):
 
   # FIX: Handle resolved return annotations
   if 'return' in resolved_hints:
-    ret_annotation = resolved_hints['return']
-    ret_rule = compile_rule(ret_annotation)
-    if ret_annotation in PRIMITIVES and ret_rule[0] == 1:
-      ret_rule = (2, ret_rule[1])
-    ret_name = format_type_name(ret_annotation)
+    ret_name = resolved_hints['return']
+    ret_rule = compile_program(ret_name, exact_primitives=True)
     check_return = True
 
   return tuple(pos_rules), kw_rules, ret_rule, ret_name, check_return
 
 
-def guard(func=None, *, check_return: bool = True) -> Callable:
+# Which of a generator annotation's arguments type its yields, sends and return value
+_FLOW_ROLES = {
+  collections.abc.Generator: ("yield", "send", "return"),
+  collections.abc.Iterator: ("yield",),
+  collections.abc.Iterable: ("yield",),
+  collections.abc.AsyncGenerator: ("yield", "send"),
+  collections.abc.AsyncIterator: ("yield",),
+  collections.abc.AsyncIterable: ("yield",),
+}
+
+
+def _flow_spec(func: Callable, ret_rule, ret_name):
+  """
+  Splits the return annotation of an async or generator function into the checks its native
+  wrapper runs while it is driven: (ret_rule, ret_name, check_return, (yield, send)). Returns
+  None when the result is an ordinary value checked on return.
+  """
+  if inspect.iscoroutinefunction(func):
+    # `async def f() -> int` describes the awaited result
+    return ret_rule, ret_name, True, (None, None)
+  if not (inspect.isgeneratorfunction(func) or inspect.isasyncgenfunction(func)):
+    return None
+  # @types.coroutine generators are awaited, not iterated
+  if getattr(getattr(func, "__code__", None), "co_flags", 0) & inspect.CO_ITERABLE_COROUTINE:
+    return None
+  roles = _FLOW_ROLES.get(typing.get_origin(ret_name), ())
+  hints = dict(zip(roles, typing.get_args(ret_name)))
+  if not hints:
+    return None
+  yield_def, send_def = (
+    (role, hints[role], compile_program(hints[role], exact_primitives=True)) if role in hints else None
+    for role in ("yield", "send")
+  )
+  if "return" in hints:
+    return compile_program(hints["return"], exact_primitives=True), hints["return"], True, (yield_def, send_def)
+  return None, "", False, (yield_def, send_def)
+
+
+def _guard_spec(func: Callable, check_return: bool):
+  pos_rules, kw_rules, ret_rule, ret_name, has_return_annotation = _compile_signature(func)
+  # Only enforce if the user wants it AND the function actually has a return annotation
+  if check_return and has_return_annotation:
+    flow = _flow_spec(func, ret_rule, ret_name)
+    if flow is not None:
+      return (pos_rules, kw_rules, *flow)
+  return pos_rules, kw_rules, ret_rule, ret_name, check_return and has_return_annotation
+
+
+def _guard_spec_checked(func: Callable):
+  return _guard_spec(func, True)
+
+
+def _guard_spec_unchecked(func: Callable):
+  return _guard_spec(func, False)
+
+
+# GUARDIAN_LAZY=1 makes every @guard compile its signature on the first call
+_LAZY_DEFAULT = os.environ.get("GUARDIAN_LAZY") == "1"
+
+
+def guard(func=None, *, check_return: bool = True, lazy: bool = None) -> Callable:
   """
   Creates a guarded version of the provided function, enforcing rules defined
   by the compiled signature. This ensures that the input parameters and return
   value adhere to the specified constraints during runtime.
 
+  Coroutines and generators are checked as they run: an `async def` annotation types
+  the awaited result, and a generator annotated `Generator[Y, S, R]` (or `Iterator[Y]`,
+  `AsyncGenerator[Y, S]`, ...) has every yielded, sent and returned value checked.
+
   :param func: The function to be wrapped and guarded.
   :param check_return: If False, skips validating the function's return type for maximum performance.
+  :param lazy: If True, defers resolving and compiling the signature to the first call, so
+      decorating thousands of functions at import time costs next to nothing. Forward
+      references then only need to resolve by the first call, and annotation errors surface
+      there too. Defaults to the GUARDIAN_LAZY environment variable.
   :return: A new function with the guarding behavior applied.
   """
   # Handle the case where the decorator is called with arguments: @guard(check_return=False)
   if func is None:
-    return lambda f: guard(f, check_return=check_return)
+    return lambda f: guard(f, check_return=check_return, lazy=lazy)
 
-  pos_rules, kw_rules, ret_rule, ret_name, has_return_annotation = _compile_signature(func)
-
-  # Only enforce if the user wants it AND the function actually has a return annotation
-  enforce_return = check_return and has_return_annotation
+  if _LAZY_DEFAULT if lazy is None else lazy:
+    return _guardian_core.make_lazy_guard(func, _guard_spec_checked if check_return else _guard_spec_unchecked)
 
-  return _guardian_core.make_guard(func, pos_rules, kw_rules, ret_rule, ret_name, enforce_return)
+  return _guardian_core.make_guard(func, *_guard_spec(func, check_return))
 
 
 def deepguard(func=None, *, check_return: bool = True) -> Callable:
@@ -110,9 +240,12 @@ def deepguard(func=None, *, check_return: bool = True) -> Callable:
     (inputs and outputs) are strictly typed, but it also prevents invalid internal
     mutations of tracked variables during the function's lifecycle.
 
-    Because of its deep tracing nature, `deepguard` incurs performance overhead
-    and is best utilized as a strict development, debugging, or auditing tool
-    rather than in high-performance production loops.
+    On Python 3.12+ the locals are checked from a `sys.monitoring` PY_RETURN event
+    enabled for the guarded function's code object only, so the rest of the process
+    runs unmonitored and installed profilers are left untouched. Every return of that
+    code is checked, including recursive calls. Older interpreters use a profiler
+    scoped to the guarded call, which restores (and keeps feeding) any profiler that
+    was already installed; that path still costs overhead on nested calls.
 
     :param func: The target function to be deeply audited. If not provided,
         the decorator can be applied with additional configuration options.
@@ -132,9 +265,13 @@ def deepguard(func=None, *, check_return: bool = True) -> Callable:
   local_annotations = _extract_local_annotations(func)
   for var_name, annotation in local_annotations.items():
       if var_name not in kw_rules:
-          raw_rule = compile_rule(annotation)
-          if annotation in PRIMITIVES and raw_rule[0] == 1:
-              raw_rule = (2, raw_rule[1])
-          kw_rules[var_name] = (var_name, format_type_name(annotation), raw_rule)
+          raw_rule = compile_program(annotation, exact_primitives=True)
+          kw_rules[var_name] = (var_name, annotation, raw_rule)
 
-  return _guardian_core.make_strictguard(func, pos_rules, kw_rules, ret_rule, ret_name, enforce_return)
\ No newline at end of file
+  tool_id = _claim_deepguard_tool()
+  strict = _guardian_core.make_strictguard(func, pos_rules, kw_rules, ret_rule, ret_name, enforce_return, tool_id is not None)
+  if tool_id is not None:
+    monitoring = sys.monitoring
+    code = func.__code__
+    monitoring.set_local_events(tool_id, code, monitoring.get_local_events(tool_id, code) | monitoring.events.PY_RETURN)
+  return strict
\ No newline at end of file
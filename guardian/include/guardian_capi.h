@@ -0,0 +1,83 @@
+/*
+ * guardian C API.
+ *
+ * Lets other C extensions (Cython, Rust via its C FFI, ...) compile a type hint once,
+ * or borrow the rule behind a @guard parameter, a dataclass field or a Shield
+ * attribute, and run guardian's native checker on values they are building, with
+ * no Python call in between. The table is exported by guardian._guardian_core as a
+ * PyCapsule; add guardian.get_include() to your include path and fetch it with
+ * Guardian_ImportCAPI() during module init.
+ *
+ * Every function must be called with the GIL held (an attached thread state on
+ * free-threaded builds). Rules are immutable once compiled and may be shared
+ * between threads.
+ */
+#ifndef GUARDIAN_CAPI_H
+#define GUARDIAN_CAPI_H
+
+#include <Python.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GUARDIAN_CAPSULE_NAME "guardian._guardian_core._C_API"
+
+/* Bumped on incompatible changes. New functions are appended to the table and
+ * announced through its size, without a version bump. */
+#define GUARDIAN_CAPI_VERSION 1
+
+typedef struct {
+    unsigned int version;       /* GUARDIAN_CAPI_VERSION the core was built with */
+    size_t size;                /* sizeof(GuardianCAPI) in the core */
+
+    PyTypeObject *RuleType;     /* guardian._guardian_core.Rule */
+    PyObject *TypeError;        /* guardian.GuardianTypeError */
+
+    /* Compiles a type hint into a Rule with @guard semantics (bool is not an int).
+     * Equal hints share one Rule. Returns a new reference, or NULL with an
+     * exception set. */
+    PyObject *(*compile)(PyObject *hint);
+
+    /* Finds the rule an existing guardian object enforces:
+     *   - a Rule: the rule itself (name is ignored);
+     *   - a @guard function: parameter `name`, or "return";
+     *   - a dataclass field descriptor: its field (name is ignored);
+     *   - a Shield class or guardian dataclass: attribute `name`.
+     * Returns 1 with borrowed references in *rule and, if expected is not NULL, in
+     * *expected (the hint, for error messages). Both stay valid while owner lives.
+     * *rule may be Py_None, which every value satisfies. Returns 0 if owner has no
+     * such rule, or -1 with an exception set. */
+    int (*borrow)(PyObject *owner, PyObject *name, PyObject **rule, PyObject **expected);
+
+    /* Returns 1 if obj satisfies rule, 0 if it does not, or -1 with an exception set
+     * (e.g. a raising __instancecheck__). */
+    int (*check)(PyObject *rule, PyObject *obj);
+
+    /* check() returning the failure instead of a bare 0. Returns NULL if obj passes;
+     * on a failure, a new reference to a GuardianTypeError for `name` (NULL: "value")
+     * expecting `expected` (NULL: the rule), not raised, with .path and the message
+     * computed on first access. Returns NULL with an exception set if the check
+     * itself raised: tell the two NULLs apart with PyErr_Occurred(). */
+    PyObject *(*check_detail)(PyObject *rule, PyObject *obj, PyObject *name, PyObject *expected);
+} GuardianCAPI;
+
+/* Imports guardian's C API table. Returns NULL with an exception set if guardian is
+ * missing or was built with an incompatible version of this header. */
+static inline const GuardianCAPI *Guardian_ImportCAPI(void) {
+    const GuardianCAPI *api = (const GuardianCAPI *)PyCapsule_Import(GUARDIAN_CAPSULE_NAME, 0);
+    if (api == NULL) return NULL;
+    if (api->version != GUARDIAN_CAPI_VERSION || api->size < sizeof(GuardianCAPI)) {
+        PyErr_Format(PyExc_ImportError, "guardian C API version %u (table of %zu bytes) is incompatible with "
+                     "this extension's version %u (%zu bytes); rebuild it against the installed guardian",
+                     api->version, api->size, (unsigned int)GUARDIAN_CAPI_VERSION, sizeof(GuardianCAPI));
+        return NULL;
+    }
+    return api;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GUARDIAN_CAPI_H */
@@ -0,0 +1,43 @@
+import os
+
+from . import _guardian_core
+
+
+def enable_stats(enabled: bool = True) -> None:
+    """
+    Turns the per-guard statistics counters on (or off) for the whole process.
+
+    While off, each checked call pays a single predictable branch. Set GUARDIAN_ENABLE_STATS=1
+    in the environment to start with them on.
+    """
+    _guardian_core.enable_stats(enabled)
+
+
+def disable_stats() -> None:
+    _guardian_core.enable_stats(False)
+
+
+def stats_enabled() -> bool:
+    return _guardian_core.stats_enabled()
+
+
+def stats(reset: bool = False) -> list[dict]:
+    """
+    Snapshot of the counters of every @guard, @deepguard, Shield class and dataclass field
+    checked while statistics were on.
+
+    Each entry is a dict with ``kind``, ``name``, ``calls``, ``failures``, ``ns`` (time spent
+    validating, excluding the guarded function itself) and ``scanned``: container elements
+    visited per container kind.
+
+    :param reset: Restart every counter from zero after taking the snapshot.
+    """
+    return _guardian_core.stats_snapshot(reset)
+
+
+def reset_stats() -> None:
+    _guardian_core.stats_snapshot(True)
+
+
+if os.environ.get("GUARDIAN_ENABLE_STATS") == "1":
+    enable_stats()
@@ -1,15 +1,98 @@
+import types
 import typing
 import inspect
 from typing import Any
 
 from .guard_set import guard
-from ._compiler import compile_rule, format_type_name
+from ._compiler import compile_program
 from . import _guardian_core
 
-PRIMITIVES = {int, str, float, bool, type(None)}
 
+def _collect_code(code: types.CodeType, found: dict, nested: bool = False) -> None:
+  if id(code) in found and (nested or not found[id(code)][1]):
+    return
+  found[id(code)] = (code, nested)
+  # Nested functions, lambdas and comprehensions compiled inside a method act for the method.
+  for const in code.co_consts:
+    if isinstance(const, types.CodeType):
+      _collect_code(const, found, True)
 
-class Shield(_guardian_core.ShieldBase, metaclass=_guardian_core.ShieldMeta):
+
+def _owned_code_objects(cls: type) -> tuple:
+  """
+  Collects the code objects of every function defined on cls and its Shield bases, as
+  (methods, nested): a method may write the private state of the object it was called on,
+  and code nested in one acts for the method frame that called it.
+  """
+  found = {}
+  for klass in cls.__mro__:
+    if not isinstance(klass, _guardian_core.ShieldMeta):
+      continue
+    for attr in klass.__dict__.values():
+      if isinstance(attr, (staticmethod, classmethod)):
+        attr = attr.__func__
+      targets = (attr.fget, attr.fset, attr.fdel) if isinstance(attr, property) else (attr,)
+      for target in targets:
+        if target is None:
+          continue
+        code = getattr(inspect.unwrap(target), '__code__', None)
+        if isinstance(code, types.CodeType):
+          _collect_code(code, found)
+  methods = [code for code, nested in found.values() if not nested]
+  return methods, [code for code, nested in found.values() if nested]
+
+
+def _is_classvar(annotation: Any) -> bool:
+  if isinstance(annotation, str):
+    return annotation.startswith(('ClassVar', 'typing.ClassVar'))
+  return annotation is typing.ClassVar or typing.get_origin(annotation) is typing.ClassVar
+
+
+def _namespace_annotations(namespace: dict) -> dict:
+  if '__annotations__' in namespace:
+    return namespace['__annotations__']
+  annotate = namespace.get('__annotate__')  # Python 3.14+: annotations are evaluated lazily
+  if annotate is None:
+    return {}
+  import annotationlib
+  return annotationlib.call_annotate_function(annotate, annotationlib.Format.FORWARDREF)
+
+
+def _slot_layout(bases: tuple, namespace: dict) -> tuple:
+  """Picks the annotated fields of a class body that can live in fixed-offset member slots."""
+  inherited = {name for base in bases for klass in base.__mro__
+               for name, attr in vars(klass).items() if isinstance(attr, types.MemberDescriptorType)}
+  slots, needs_dict = [], False
+  for name, annotation in _namespace_annotations(namespace).items():
+    if _is_classvar(annotation) or name in inherited:
+      continue
+    if name in namespace:
+      # A class-level default cannot share its name with a slot; keep the field dict-backed.
+      needs_dict = True
+      continue
+    slots.append(name)
+  if needs_dict and not any(base.__dictoffset__ for base in bases):
+    slots.append('__dict__')
+  return tuple(slots)
+
+
+class ShieldMeta(_guardian_core.ShieldMeta):
+  """
+  Metaclass of Shield models. ``class Point(Shield, slots=True)`` stores each annotated field
+  in a member slot at a fixed offset in the instance instead of in a per-instance ``__dict__``;
+  the native setattr path validates and writes the slot directly. Fields with a class-level
+  default stay dict-backed, and unannotated attributes are refused like on any slotted class.
+  """
+
+  def __new__(mcls, name, bases, namespace, slots=False, **kwargs):
+    if slots:
+      if '__slots__' in namespace:
+        raise TypeError(f"{name} already specifies __slots__")
+      namespace = dict(namespace, __slots__=_slot_layout(bases, namespace))
+    return super().__new__(mcls, name, bases, namespace, **kwargs)
+
+
+class Shield(_guardian_core.ShieldBase, metaclass=ShieldMeta):
   """
   Provides a base for creating shielded classes that enforce attribute-type rules.
 
@@ -19,13 +102,15 @@ class Shield(_guardian_core.ShieldBase, metaclass=_guardian_core.ShieldMeta):
   The shielding rules are based on type hints and can handle complex rules, including resolving
   forward references and primitives.
 
-  :ivar __shield_rules__: A dictionary mapping attribute names to their compiled type rules
-      and expected type names. This is populated during subclass initialization based on
-      type annotations.
-  :type __shield_rules__: dict[str, tuple[Any, str]]
+  :ivar __shield_rules__: A dictionary mapping attribute names to their compiled rule
+      programs and expected types (a hint, or a display string). This is populated during subclass initialization based on
+      type annotations. ShieldMeta snapshots it into a native per-class table on first use;
+      reassign the attribute (rather than mutating the dict) to change rules afterwards.
+  :type __shield_rules__: dict[str, tuple[Any, Any]]
   """
 
-  __shield_rules__: dict[str, tuple[Any, str]] = {}
+  __slots__ = ()
+  __shield_rules__: dict[str, tuple[Any, Any]] = {}
 
   def __init_subclass__(cls, **kwargs):
     super().__init_subclass__(**kwargs)
@@ -37,17 +122,15 @@ class Shield(_guardian_core.ShieldBase, metaclass=_guardian_core.ShieldMeta):
 
     # FIX: Resolve string forward references for class attributes
     try:
-      annotations = typing.get_type_hints(cls)
+      annotations = typing.get_type_hints(cls, include_extras=True)
     except Exception:
       annotations = inspect.get_annotations(cls)
 
     for attr_name, attr_type in annotations.items():
-      raw_rule = compile_rule(attr_type)
-      if attr_type in PRIMITIVES and raw_rule[0] == 1:
-        raw_rule = (2, raw_rule[1])
+      raw_rule = compile_program(attr_type, exact_primitives=True)
 
-      expected_name = format_type_name(attr_type)
-      cls.__shield_rules__[attr_name] = (raw_rule, expected_name)
+      # The hint itself stands in for its display name until an assignment fails
+      cls.__shield_rules__[attr_name] = (raw_rule, attr_type)
 
     if '__init__' in cls.__dict__:
       original_init = cls.__init__
@@ -56,4 +139,8 @@ class Shield(_guardian_core.ShieldBase, metaclass=_guardian_core.ShieldMeta):
       new_annotations.update(getattr(original_init, '__annotations__', {}))
       original_init.__annotations__ = new_annotations
 
-      cls.__init__ = guard(original_init)
\ No newline at end of file
+      cls.__init__ = guard(original_init)
+
+    # Private state may only be rebound by code this class (or a Shield base) defines,
+    # on the instance or class that code was called on.
+    _guardian_core.register_shield_owners(cls, *_owned_code_objects(cls))
\ No newline at end of file
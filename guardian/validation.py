@@ -0,0 +1,56 @@
+from typing import Any, Iterable, Mapping
+import typing
+
+from . import _guardian_core
+from ._compiler import compile_program
+
+def _rule_for(tp: Any) -> "_guardian_core.Rule":
+    """Compiles a hint with @guard semantics (bool is not an int); compile_program memoizes it."""
+    if isinstance(tp, _guardian_core.Rule):
+        return tp
+    return compile_program(tp, exact_primitives=True)
+
+
+def set_max_depth(depth: int) -> int:
+    """
+    Sets how many levels deep one check may follow a recursive alias or model (1000 by
+    default). Deeper values raise RecursionError instead of being walked, so a hostile
+    payload cannot grow a check's memory without bound.
+
+    :return: the previous limit.
+    """
+    return _guardian_core.set_max_depth(depth)
+
+
+def validate(tp: Any, value: Any) -> bool:
+    """Returns True if value satisfies the type hint (or compiled Rule) tp."""
+    return _rule_for(tp).check(value)
+
+
+def validate_many(tp: Any, values: Iterable, *, failures: bool = False) -> list:
+    """
+    Checks every item of values against tp in a single C loop.
+
+    :return: one bool per item, or with failures=True the indices of the items that failed.
+    """
+    return _guardian_core.validate_many(_rule_for(tp), values, failures)
+
+
+def validate_columns(schema: Any, columns: Mapping[str, Iterable], *, failures: bool = False) -> list:
+    """
+    Checks a columnar batch, e.g. {"id": [...], "price": [...]}, row by row in C.
+
+    :param schema: {column: type} mapping, or a class whose annotations name the columns
+        (dataclass, TypedDict, Shield model, ...). Columns not in the schema are not checked.
+    :param columns: {column: sequence}; every schema column must be present and all must
+        have the same length.
+    :return: one bool per row, or with failures=True the indices of the rows that failed.
+    """
+    if not isinstance(schema, Mapping):
+        schema = typing.get_type_hints(schema, include_extras=True)
+    missing = [name for name in schema if name not in columns]
+    if missing:
+        raise KeyError(f"missing column(s): {', '.join(map(repr, missing))}")
+    names = tuple(schema)
+    rules = tuple(_rule_for(schema[name]) for name in names)
+    return _guardian_core.validate_columns(names, rules, tuple(columns[name] for name in names), failures)
@@ -13,6 +13,7 @@ else:
 guardian_core = Extension(
     "guardian._guardian_core",
     sources=["src/_guardian_core.c"],
+    include_dirs=["guardian/include"],   # guardian_capi.h, shared with extensions built against the C API
     extra_compile_args=compile_args,
 )
 
@@ -21,6 +22,7 @@ setup(
     version="3.1.2",
     ext_modules=[guardian_core],
     packages=["guardian"],
+    package_data={"guardian": ["include/*.h"]},
     long_description=open("README.md", encoding="utf-8").read(),
     long_description_content_type="text/markdown",
     license="MIT",
@@ -1,8 +1,11 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <frameobject.h>
+#include <structmember.h>
 #include <stddef.h>
 
+#include "guardian_capi.h"
+
 #if defined(__GNUC__) || defined(__clang__)
     #define likely(x)   __builtin_expect(!!(x), 1)
     #define unlikely(x) __builtin_expect(!!(x), 0)
@@ -30,552 +33,6708 @@ static inline PyObject* PyFrame_GetLocals(PyFrameObject *frame) {
 #define OP_TUPLE_FIXED 7
 #define OP_SET 8
 #define OP_LITERAL 9
+#define OP_UNION_DISPATCH 10
+#define OP_TAGGED_UNION 11
+#define OP_BUFFER 12
+#define OP_TYPED_DICT 13
+#define OP_NAMED_TUPLE 14
+#define OP_DATACLASS 15
+#define OP_PROTOCOL 16
+#define OP_REF 17
+#define OP_COUNT 18
 
 static PyObject *GuardianTypeError;
 static PyObject *GuardianAccessError;
 static PyObject *GuardianInitializationError;
 
-static int fast_check_type(PyObject *obj, PyObject *rule) {
-    if (unlikely(rule == Py_None)) return 1;
+static PyObject *AbcMetaType;          // abc.ABCMeta, for positive-only inline caching
+static PyObject *ObjectClassDescr;     // object.__dict__['__class__']
+static PyObject *str___class__;
+static PyObject *str_return;
+static PyObject *EmptyTuple;
 
-    long op = PyLong_AS_LONG(PyTuple_GET_ITEM(rule, 0));
-    PyObject *arg = PyTuple_GET_ITEM(rule, 1);
+// --- FREE-THREADED BUILDS ---
+// On a free-threaded interpreter (3.13t) checks run in parallel, with no GIL to order
+// them. Rule programs and Shield attribute tables are immutable once published; the
+// few words updated afterwards (inline caches, owner verdicts, statistics counters)
+// are single-word relaxed atomics laid out so that a stale read is only a cache miss.
+// Scans of a user's list or dict run inside the container's critical section, as
+// CPython's own iteration does. With the GIL all of this compiles to plain accesses.
 
-    switch (op) {
-        case OP_ANY: return 1;
-        case OP_EXACT: {
-            if (arg == (PyObject *)&PyLong_Type) return PyLong_CheckExact(obj);
-            if (arg == (PyObject *)&PyUnicode_Type) return PyUnicode_CheckExact(obj);
-            if (arg == (PyObject *)&PyFloat_Type) return PyFloat_CheckExact(obj);
-            if (arg == (PyObject *)&PyBool_Type) return PyBool_Check(obj);
-            if (arg == (PyObject *)Py_TYPE(Py_None)) return obj == Py_None;
-            return Py_TYPE(obj) == (PyTypeObject *)arg;
-        }
-        case OP_INSTANCE:
-            return PyObject_IsInstance(obj, arg);
-        case OP_UNION: {
-            Py_ssize_t size = PyTuple_GET_SIZE(arg);
-            for (Py_ssize_t i = 0; i < size; i++) {
-                if (fast_check_type(obj, PyTuple_GET_ITEM(arg, i))) return 1;
-            }
-            return 0;
-        }
-        case OP_LIST: {
-            if (unlikely(!PyList_Check(obj))) return 0;
-            if (arg == Py_None) return 1;
-            Py_ssize_t size = PyList_GET_SIZE(obj);
-            for (Py_ssize_t i = 0; i < size; i++) {
-                if (!fast_check_type(PyList_GET_ITEM(obj, i), arg)) return 0;
-            }
-            return 1;
-        }
-        case OP_DICT: {
-            if (unlikely(!PyDict_Check(obj))) return 0;
-            if (arg == Py_None) return 1;
-            PyObject *k_rule = PyTuple_GET_ITEM(arg, 0);
-            PyObject *v_rule = PyTuple_GET_ITEM(arg, 1);
-            PyObject *key, *value;
-            Py_ssize_t pos = 0;
-            while (PyDict_Next(obj, &pos, &key, &value)) {
-                if (!fast_check_type(key, k_rule) || !fast_check_type(value, v_rule)) return 0;
-            }
-            return 1;
-        }
-        case OP_TUPLE_VAR: {
-            if (unlikely(!PyTuple_Check(obj))) return 0;
-            Py_ssize_t size = PyTuple_GET_SIZE(obj);
-            for (Py_ssize_t i = 0; i < size; i++) {
-                if (!fast_check_type(PyTuple_GET_ITEM(obj, i), arg)) return 0;
-            }
-            return 1;
-        }
-        case OP_TUPLE_FIXED: {
-            if (unlikely(!PyTuple_Check(obj))) return 0;
-            Py_ssize_t size = PyTuple_GET_SIZE(arg);
-            if (PyTuple_GET_SIZE(obj) != size) return 0;
-            for (Py_ssize_t i = 0; i < size; i++) {
-                if (!fast_check_type(PyTuple_GET_ITEM(obj, i), PyTuple_GET_ITEM(arg, i))) return 0;
-            }
-            return 1;
-        }
-        case OP_SET: {
-            if (unlikely(!PyAnySet_Check(obj))) return 0;
-            if (arg == Py_None) return 1;
-            PyObject *iter = PyObject_GetIter(obj);
-            PyObject *item;
-            while ((item = PyIter_Next(iter))) {
-                int res = fast_check_type(item, arg);
-                Py_DECREF(item);
-                if (!res) {
-                    Py_DECREF(iter);
-                    return 0;
-                }
-            }
-            Py_DECREF(iter);
-            return 1;
-        }
-        case OP_LITERAL: {
-            return PySequence_Contains(arg, obj) == 1;
-        }
-    }
-    return 0;
+#ifdef Py_GIL_DISABLED
+#define FT_LOAD_PTR(p) _Py_atomic_load_ptr_acquire(&(p))
+#define FT_STORE_PTR(p, v) _Py_atomic_store_ptr_release(&(p), (v))
+#define FT_EXCHANGE_PTR(p, v) _Py_atomic_exchange_ptr(&(p), (v))
+#define FT_CAS_PTR(p, expected, v) _Py_atomic_compare_exchange_ptr(&(p), &(expected), (v))
+#define FT_LOAD_UINTPTR(p) _Py_atomic_load_uintptr_relaxed(&(p))
+#define FT_STORE_UINTPTR(p, v) _Py_atomic_store_uintptr_relaxed(&(p), (v))
+#define FT_LOAD_UINT(p) _Py_atomic_load_uint_relaxed(&(p))
+#define FT_STORE_UINT(p, v) _Py_atomic_store_uint_relaxed(&(p), (v))
+#define FT_LOAD_INT(p) _Py_atomic_load_int_relaxed(&(p))
+#define FT_STORE_INT(p, v) _Py_atomic_store_int_relaxed(&(p), (v))
+#define FT_LOAD_SSIZE(p) _Py_atomic_load_ssize_relaxed(&(p))
+#define FT_STORE_SSIZE(p, v) _Py_atomic_store_ssize_relaxed(&(p), (v))
+#define FT_EXCHANGE_SSIZE(p, v) _Py_atomic_exchange_ssize(&(p), (v))
+#define FT_LOAD_U64(p) _Py_atomic_load_uint64_relaxed(&(p))
+#define FT_STORE_U64(p, v) _Py_atomic_store_uint64_relaxed(&(p), (v))
+#define FT_ADD_U64(p, v) ((void)_Py_atomic_add_uint64(&(p), (v)))
+#else
+#define FT_LOAD_PTR(p) (p)
+#define FT_STORE_PTR(p, v) ((void)((p) = (v)))
+#define FT_EXCHANGE_PTR(p, v) ft_exchange_ptr((void **)&(p), (v))
+#define FT_CAS_PTR(p, expected, v) ((p) == (expected) ? ((p) = (v), 1) : ((expected) = (p), 0))
+#define FT_LOAD_UINTPTR(p) (p)
+#define FT_STORE_UINTPTR(p, v) ((void)((p) = (v)))
+#define FT_LOAD_UINT(p) (p)
+#define FT_STORE_UINT(p, v) ((void)((p) = (v)))
+#define FT_LOAD_INT(p) (p)
+#define FT_STORE_INT(p, v) ((void)((p) = (v)))
+#define FT_LOAD_SSIZE(p) (p)
+#define FT_STORE_SSIZE(p, v) ((void)((p) = (v)))
+#define FT_EXCHANGE_SSIZE(p, v) ft_exchange_ssize(&(p), (v))
+#define FT_LOAD_U64(p) (p)
+#define FT_STORE_U64(p, v) ((void)((p) = (v)))
+#define FT_ADD_U64(p, v) ((void)((p) += (v)))
+
+static inline void *ft_exchange_ptr(void **slot, void *value) {
+    void *old = *slot;
+    *slot = value;
+    return old;
 }
 
-static void raise_type_error(PyObject *param_name, PyObject *expected_name, PyObject *val) {
-    PyObject *val_repr = PyObject_Repr(val);
-    PyObject *val_type_name = PyObject_GetAttrString((PyObject *)Py_TYPE(val), "__name__");
-    PyErr_Format(GuardianTypeError, "Variable '%U' expected %U, got %U (%U)",
-                 param_name, expected_name, val_type_name, val_repr);
-    Py_XDECREF(val_repr);
-    Py_XDECREF(val_type_name);
+static inline Py_ssize_t ft_exchange_ssize(Py_ssize_t *slot, Py_ssize_t value) {
+    Py_ssize_t old = *slot;
+    *slot = value;
+    return old;
 }
+#endif
 
-static int check_internal_access(PyObject *self, const char *name_str) {
-    int is_internal = 0;
-#if PY_VERSION_HEX >= 0x030B0000
-    PyFrameObject *frame = PyThreadState_GetFrame(PyThreadState_Get());
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
 #else
-    PyFrameObject *frame = PyEval_GetFrame();
-    Py_XINCREF(frame);
+#define THREAD_LOCAL _Thread_local
 #endif
-    PyFrameObject *f = frame;
-    while (f) {
-        PyObject *locals = PyFrame_GetLocals(f);
-        if (locals) {
-            // 1. Check for standard 'self' (Instance methods)
-            PyObject *frame_self = PyMapping_GetItemString(locals, "self");
-            if (frame_self) {
-                if (frame_self == self) is_internal = 1;
-                Py_DECREF(frame_self);
-            } else {
-                PyErr_Clear();
-            }
 
-            // 2. Check for 'cls' (Class methods)
-            if (!is_internal) {
-                PyObject *frame_cls = PyMapping_GetItemString(locals, "cls");
-                if (frame_cls) {
-                    if (frame_cls == self) is_internal = 1;
-                    Py_DECREF(frame_cls);
-                } else {
-                    PyErr_Clear();
-                }
-            }
-            Py_DECREF(locals);
-        }
-        if (is_internal) break;
+#if PY_VERSION_HEX < 0x030D0000
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
 
-#if PY_VERSION_HEX >= 0x03090000
-        PyFrameObject *back = PyFrame_GetBack(f);
-#else
-        PyFrameObject *back = f->f_back;
-        Py_XINCREF(back);
-#endif
-        Py_DECREF(f);
-        f = back;
-    }
-    if (f) Py_DECREF(f);
-    return is_internal;
+static inline int PyDict_GetItemRef(PyObject *mp, PyObject *key, PyObject **result) {
+    *result = Py_XNewRef(PyDict_GetItemWithError(mp, key));
+    return *result != NULL ? 1 : PyErr_Occurred() ? -1 : 0;
 }
+#endif
 
-static int shield_setattro(PyObject *self, PyObject *name, PyObject *value) {
-    if (unlikely(!PyUnicode_Check(name))) return PyObject_GenericSetAttr(self, name, value);
+// Stores value into *slot unless another thread filled it first, and returns what the
+// slot holds afterwards (borrowed); a losing value is released. For lazily created
+// objects that live as long as their owner.
+static PyObject *publish_once(PyObject **slot, PyObject *value) {
+    PyObject *expected = NULL;
+    if (FT_CAS_PTR(*slot, expected, value)) return value;
+    Py_DECREF(value);
+    return expected;
+}
 
-    const char *name_str = PyUnicode_AsUTF8(name);
+// --- INLINE TYPE CACHES ---
+// OP_INSTANCE and OP_UNION nodes remember the verdict for the last few concrete
+// types they saw. Entries hold a borrowed type pointer and are only trusted while
+// the type's version tag is unchanged: CPython bumps the tag whenever the type or
+// its bases are modified, and never reuses a tag for a new type at the same address.
+//
+// Reads take no lock. The version tag and the verdict share one 64-bit word, so a
+// reader racing a writer sees either the old pair or the new one; since a tag names
+// exactly one type, a type pointer from one write paired with the word of another
+// can never match.
 
-    if (unlikely(name_str[0] == '_')) {
-        size_t len = strlen(name_str);
-        if (!(len >= 4 && name_str[1] == '_' && name_str[len-1] == '_' && name_str[len-2] == '_')) {
-            if (!check_internal_access(self, name_str)) {
-                PyErr_Format(GuardianAccessError, "External access denied: Cannot modify protected/private attribute '%s'.", name_str);
-                return -1;
-            }
-        }
-    }
+#define INLINE_CACHE_SIZE 4
 
-    if (unlikely(value == NULL)) return PyObject_GenericSetAttr(self, name, value);
+typedef struct {
+    PyTypeObject *type;
+    uint64_t key;           // version tag << 32 | verdict
+} InlineCacheEntry;
 
-    PyTypeObject *type = Py_TYPE(self);
-    PyObject *rules_dict = PyDict_GetItemString(type->tp_dict, "__shield_rules__");
+typedef struct {
+    InlineCacheEntry entries[INLINE_CACHE_SIZE];
+    unsigned int next;
+} InlineCache;
 
-    if (likely(rules_dict != NULL)) {
-        PyObject *rule_def = PyDict_GetItemWithError(rules_dict, name);
-        if (rule_def) {
-            PyObject *rule = PyTuple_GET_ITEM(rule_def, 0);
-            if (unlikely(!fast_check_type(value, rule))) {
-                PyObject *expected = PyTuple_GET_ITEM(rule_def, 1);
-                raise_type_error(name, expected, value);
-                return -1;
-            }
+// 1 with the cached verdict for tp in *value, or 0 on a miss.
+static inline int cache_lookup(InlineCache *cache, PyTypeObject *tp, int *value) {
+    unsigned int version = FT_LOAD_UINT(tp->tp_version_tag);
+    for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+        InlineCacheEntry *e = &cache->entries[i];
+        uint64_t key = FT_LOAD_U64(e->key);
+        if ((unsigned int)(key >> 32) == version && FT_LOAD_PTR(e->type) == tp) {
+            *value = (int)(uint32_t)key;
+            return 1;
         }
-    } else {
-        PyErr_Clear();
     }
+    return 0;
+}
 
-    return PyObject_GenericSetAttr(self, name, value);
+// A verdict may be cached per type only if isinstance() cannot be steered per
+// instance: the type must have a version tag and must not override __class__.
+static int type_is_cacheable(PyTypeObject *tp) {
+    if (tp->tp_version_tag == 0) {
+#if PY_VERSION_HEX >= 0x030C0000
+        PyUnstable_Type_AssignVersionTag(tp);
+#endif
+    }
+    // _PyType_Lookup also assigns the version tag on older interpreters.
+    PyObject *descr = _PyType_Lookup(tp, str___class__);
+    return tp->tp_version_tag != 0 && descr == ObjectClassDescr;
 }
 
+static void cache_store(InlineCache *cache, PyTypeObject *tp, int value) {
+    if (!type_is_cacheable(tp)) return;
+    unsigned int version = FT_LOAD_UINT(tp->tp_version_tag);
+    if (version == 0) return;  // modified since: a tag of 0 is never trusted
+    unsigned int next = FT_LOAD_UINT(cache->next);
+    FT_STORE_UINT(cache->next, next + 1);
+    InlineCacheEntry *e = &cache->entries[next % INLINE_CACHE_SIZE];
+    FT_STORE_PTR(e->type, tp);
+    FT_STORE_U64(e->key, (uint64_t)version << 32 | (uint32_t)value);
+}
 
-static PyTypeObject ShieldBaseType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "guardian._guardian_core.ShieldBase",
-    .tp_basicsize = sizeof(PyObject),
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_getattro = PyObject_GenericGetAttr,  // <--- BYPASS CUSTOM LOGIC ENTIRELY
-    .tp_setattro = shield_setattro,          // Keep the write protection
-    .tp_new = PyType_GenericNew,
-};
+// --- FIXED-OFFSET SLOT STORAGE ---
+// Slotted Shield models and slotted guardian dataclasses keep field values in
+// member slots at fixed offsets in the instance. The write paths store straight
+// into the slot once the value has been validated, without touching a dict.
 
-// --- CORE OBJECTS ---
-typedef struct {
-    PyObject_HEAD
-    vectorcallfunc vectorcall;
-    PyObject *func;
-    PyObject *pos_rules;
-    PyObject *kw_rules;
-    PyObject *ret_rule;
-    PyObject *ret_name;
-    int check_return;
-} GuardObject;
+// Returns the offset of the writable object slot a member descriptor manages, or 0.
+static Py_ssize_t member_slot_offset(PyObject *descr) {
+    if (descr == NULL || !Py_IS_TYPE(descr, &PyMemberDescr_Type)) return 0;
+    PyMemberDef *member = ((PyMemberDescrObject *)descr)->d_member;
+    if (member->type != T_OBJECT_EX || (member->flags & READONLY)) return 0;
+    return member->offset;
+}
 
-static void Guard_dealloc(GuardObject *self) {
-    Py_XDECREF(self->func);
-    Py_XDECREF(self->pos_rules);
-    Py_XDECREF(self->kw_rules);
-    Py_XDECREF(self->ret_rule);
-    Py_XDECREF(self->ret_name);
-    Py_TYPE(self)->tp_free((PyObject *)self);
+static inline PyObject *slot_load(PyObject *obj, Py_ssize_t offset) {
+    return *(PyObject **)((char *)obj + offset);
 }
 
-// THE FIX: Descriptor Protocol binds the C-object to instances (injects `self` into args)
-static PyObject *Guard_descr_get(PyObject *self, PyObject *obj, PyObject *type) {
-    if (obj == NULL || obj == Py_None) {
-        Py_INCREF(self);
-        return self;
+// Stores (or, with value == NULL, deletes) a slot value, mirroring member_descriptor semantics.
+static inline int slot_store(PyObject *obj, Py_ssize_t offset, PyObject *name, PyObject *value) {
+    PyObject **slot = (PyObject **)((char *)obj + offset);
+    PyObject *old = *slot;
+    if (unlikely(value == NULL && old == NULL)) {
+        PyErr_SetObject(PyExc_AttributeError, name);
+        return -1;
     }
-    return PyMethod_New(self, obj);
+    *slot = Py_XNewRef(value);
+    Py_XDECREF(old);
+    return 0;
 }
 
-static PyObject* Guard_getattro(PyObject *self, PyObject *name) {
-    PyObject *res = PyObject_GenericGetAttr(self, name);
-    if (res != NULL) return res;
-    PyErr_Clear();
-    return PyObject_GetAttr(((GuardObject*)self)->func, name);
-}
+// --- RULE PROGRAMS ---
+// compile_rule() emits nested (op, arg) tuples. lower_rule() flattens that tree into
+// one contiguous array of RuleNodes so the checker walks plain structs instead of
+// chasing PyTuple/PyLong pointers on every call. Node 0 is the root; children are
+// referenced by index through the kid table that follows the node array. An OP_REF
+// node's only kid is an ancestor, which is how recursive aliases close their loop.
 
-static PyObject *Guard_vectorcall(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
-    GuardObject *self = (GuardObject *)self_obj;
-    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+#define NODE_CACHE_NEGATIVE  0x1   // OP_INSTANCE: misses may be cached too (plain `type` metaclass)
+#define NODE_TYPE_DETERMINED 0x2   // the verdict depends only on type(obj)
 
-    Py_ssize_t n_pos = PyTuple_GET_SIZE(self->pos_rules);
-    for (Py_ssize_t i = 0; i < nargs && i < n_pos; i++) {
-        PyObject *rule_def = PyTuple_GET_ITEM(self->pos_rules, i);
-        if (rule_def != Py_None) {
-            PyObject *rule = PyTuple_GET_ITEM(rule_def, 2);
-            if (unlikely(!fast_check_type(args[i], rule))) {
-                raise_type_error(PyTuple_GET_ITEM(rule_def, 0), PyTuple_GET_ITEM(rule_def, 1), args[i]);
-                return NULL;
-            }
-        }
-    }
+#define NODE_TAG_MAPPING     0x4   // OP_TAGGED_UNION: the tag is a dict key, not an attribute
+#define NODE_HOMOGENEOUS     0x8   // OP_LIST / OP_TUPLE_VAR: the element rule is headed by one type
+#define NODE_RECURSIVE       0x10  // an OP_REF lies below: checked by check_deep, not C recursion
 
-    if (unlikely(kwnames != NULL)) {
-        Py_ssize_t nkwargs = PyTuple_GET_SIZE(kwnames);
-        for (Py_ssize_t i = 0; i < nkwargs; i++) {
-            PyObject *kw = PyTuple_GET_ITEM(kwnames, i);
-            PyObject *val = args[nargs + i];
+#define UNION_HINT_DEFINITIVE 0x10000
 
-            PyObject *rule_def = PyDict_GetItemWithError(self->kw_rules, kw);
-            if (rule_def) {
-                if (unlikely(!fast_check_type(val, PyTuple_GET_ITEM(rule_def, 2)))) {
-                    raise_type_error(kw, PyTuple_GET_ITEM(rule_def, 1), val);
-                    return NULL;
-                }
-            }
-        }
-    }
+// Open-addressed type -> branch table for OP_UNION_DISPATCH.
+typedef struct {
+    PyTypeObject *type;
+    Py_ssize_t kid;
+} DispatchSlot;
 
-    PyObject *result = PyObject_Vectorcall(self->func, args, nargsf, kwnames);
+// OP_BUFFER constraints, checked against a PEP 3118 view of the object.
+typedef struct {
+    PyObject *formats;              // borrowed tuple of accepted struct formats, NULL for any
+    Py_ssize_t itemsize;            // 0: any
+    int ndim;                       // -1: any
+    int has_range;
+    int signed_empty;               // the range admits no value of a signed integer format
+    int unsigned_empty;             // ... or of an unsigned one
+    double lo, hi;                  // inclusive range for float formats; NaN never passes
+    long long ilo, ihi;             // the same range rounded inward, for signed formats
+    unsigned long long ulo, uhi;    // ... and for unsigned formats
+} BufferSpec;
 
-    if (result && self->check_return && self->ret_rule != Py_None) {
-        if (unlikely(!fast_check_type(result, self->ret_rule))) {
-            raise_type_error(PyUnicode_FromString("return"), self->ret_name, result);
-            Py_DECREF(result);
-            return NULL;
-        }
-    }
-    return result;
+typedef struct {
+    int op;
+    int flags;
+    InlineCache *cache;     // OP_INSTANCE / OP_UNION only, NULL otherwise
+    Py_ssize_t n_kids;
+    Py_ssize_t kids;        // offset of the first child index in the kid table
+    PyTypeObject *type;     // borrowed: kept alive by the rule's source tuple
+    PyObject *arg;          // borrowed: kept alive by the rule's source tuple
+    PyObject *table;        // borrowed: OP_TAGGED_UNION {tag value: branch index},
+                            // OP_LITERAL {value: (allowed values equal to it, ...)}
+    DispatchSlot *dispatch; // OP_UNION_DISPATCH only
+    PyObject **literals;    // OP_LITERAL: open-addressed identity table of the allowed values
+    size_t dispatch_mask;   // size - 1 of the dispatch or identity table
+    BufferSpec *buffer;     // OP_BUFFER only
+} RuleNode;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *source;       // the (op, arg) tuple this program was lowered from
+    Py_ssize_t n_nodes;
+    RuleNode *nodes;
+    Py_ssize_t *kids;
+    InlineCache *caches;
+    DispatchSlot *slots;
+    BufferSpec *buffers;
+    PyObject **literals;
+    PyObject *tables;       // list owning the OP_LITERAL lookup dicts built while lowering
+} RuleObject;
+
+static PyTypeObject *RuleType;
+
+#define Rule_Check(op) Py_IS_TYPE(op, RuleType)
+#define RULE_KID(r, node, i) (&(r)->nodes[(r)->kids[(node)->kids + (i)]])
+// OP_DATACLASS: slot offset of field i (0: read it as an attribute), stored after the kids
+#define RULE_FIELD_OFFSET(r, node, i) ((r)->kids[(node)->kids + (node)->n_kids + (i)])
+
+static inline size_t pointer_hash(const void *p) {
+    size_t h = (size_t)p >> 4;
+    return h ^ (h >> 7);
 }
 
-static PyTypeObject GuardType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "guardian._guardian_core.Guard",
-    .tp_basicsize = sizeof(GuardObject),
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_VECTORCALL,
-    .tp_dealloc = (destructor)Guard_dealloc,
-    .tp_call = PyVectorcall_Call,
-    .tp_getattro = Guard_getattro,
-    .tp_descr_get = Guard_descr_get, // Binds method accurately
-};
+static inline size_t dispatch_hash(PyTypeObject *tp) {
+    return pointer_hash(tp);
+}
+
+// --- RUNTIME STATISTICS ---
+// Opt-in counters per @guard / @deepguard, Shield class and dataclass field: calls,
+// failures, time spent validating, and container elements visited per opcode. They
+// are compiled in unless built with -DGUARDIAN_STATS=0 and cost one predictable
+// branch on StatsEnabled until enable_stats() flips it. A record is created on its
+// owner's first counted check and kept in StatsRegistry for stats_snapshot().
+
+#ifndef GUARDIAN_STATS
+#define GUARDIAN_STATS 1
+#endif
 
 typedef struct {
     PyObject_HEAD
-    vectorcallfunc vectorcall;
-    PyObject *func;
-    PyObject *func_code;
-    PyObject *pos_rules;
-    PyObject *kw_rules;
-    PyObject *ret_rule;
-    PyObject *ret_name;
-    int check_return;
-} StrictGuardObject;
+    PyObject *kind;                 // "guard", "deepguard", "shield" or "field"
+    PyObject *label;                // e.g. "app.api.create_order" or "app.models.Order.total"
+    uint64_t calls;
+    uint64_t failures;
+    uint64_t ns;                    // time spent validating, not running the guarded function
+    uint64_t scanned[OP_COUNT];     // container elements visited, by opcode
+} StatsRecordObject;
 
-static int strict_trace_func(PyObject *obj, PyFrameObject *frame, int what, PyObject *arg) {
-    if (what != PyTrace_RETURN) return 0;
+static int StatsEnabled;                               // read and written with FT_LOAD_INT / FT_STORE_INT
+static THREAD_LOCAL StatsRecordObject *StatsCurrent;   // record this thread's container scans are charged to
+static PyObject *StatsRegistry;                        // list of every record created
 
-    StrictGuardObject *self = (StrictGuardObject *)obj;
-    PyCodeObject *f_code = PyFrame_GetCode(frame);
-    int is_target = ((PyObject *)f_code == self->func_code);
-    Py_XDECREF(f_code);
+#if GUARDIAN_STATS
+#define STATS_ON() unlikely(FT_LOAD_INT(StatsEnabled))
+#define STATS_SCANNED(op, n) do { \
+        if (unlikely(FT_LOAD_INT(StatsEnabled)) && StatsCurrent != NULL) FT_ADD_U64(StatsCurrent->scanned[op], (uint64_t)(n)); \
+    } while (0)
+#else
+#define STATS_ON() 0
+#define STATS_SCANNED(op, n) ((void)0)
+#endif
 
-    if (!is_target) return 0;
+static void StatsRecord_dealloc(StatsRecordObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    Py_XDECREF(self->kind);
+    Py_XDECREF(self->label);
+    PyObject_Free(self);
+    Py_DECREF(tp);
+}
 
-    PyObject *locals = PyFrame_GetLocals(frame);
-    if (!locals) return 0;
+static PyType_Slot StatsRecord_slots[] = {
+    {Py_tp_dealloc, StatsRecord_dealloc},
+    {0, NULL}
+};
 
-    PyObject *key, *rule_def;
-    Py_ssize_t pos = 0;
-    
-    // Modify strict_trace_func around line 273:
+static PyType_Spec StatsRecord_spec = {
+    .name = "guardian._guardian_core.StatsRecord",
+    .basicsize = sizeof(StatsRecordObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = StatsRecord_slots,
+};
 
-    while (PyDict_Next(self->kw_rules, &pos, &key, &rule_def)) {
-        // THE FIX: PyObject_GetItem respects modern Python proxy mappings while 
-        // retaining the O(1) string lookup performance win.
-        PyObject *val = PyObject_GetItem(locals, key); 
-        
-        if (val) {
-            PyObject *rule = PyTuple_GET_ITEM(rule_def, 2);
-            if (unlikely(!fast_check_type(val, rule))) {
-                raise_type_error(key, PyTuple_GET_ITEM(rule_def, 1), val);
-                Py_DECREF(val);
-                Py_DECREF(locals);
-                return -1;
-            }
-            Py_DECREF(val); // Clean up the new reference
-        } else {
-            // STRICT ENFORCEMENT: The variable was declared but never initialized
-            PyErr_Clear();
-            PyErr_Format(GuardianInitializationError, 
-                         "Variable '%U' was declared as %U but was never initialized before return.", 
-                         key, PyTuple_GET_ITEM(rule_def, 1));
-            Py_DECREF(locals);
-            return -1;
-        }
+static PyTypeObject *StatsRecordType;
+
+static inline uint64_t stats_now(void) {
+#if PY_VERSION_HEX >= 0x030D0000
+    PyTime_t t;
+    (void)PyTime_PerfCounterRaw(&t);
+    return (uint64_t)t;
+#else
+    return (uint64_t)_PyTime_GetPerfCounter();
+#endif
+}
+
+// "module.qualname" of a function or class, plus ".attr" for fields.
+static PyObject *stats_label(PyObject *owner, PyObject *attr) {
+    PyObject *module = PyObject_GetAttrString(owner, "__module__");
+    PyObject *qualname = module ? PyObject_GetAttrString(owner, "__qualname__") : NULL;
+    PyObject *label;
+    if (qualname != NULL && PyUnicode_Check(module) && PyUnicode_Check(qualname)) {
+        label = PyUnicode_FromFormat("%U.%U", module, qualname);
+    } else {
+        PyErr_Clear();
+        label = PyObject_Repr(owner);
     }
-    
-    Py_DECREF(locals);
-    return 0;
+    Py_XDECREF(module);
+    Py_XDECREF(qualname);
+    if (label != NULL && attr != NULL) Py_SETREF(label, PyUnicode_FromFormat("%U.%U", label, attr));
+    return label;
 }
 
-static PyObject* StrictGuard_getattro(PyObject *self, PyObject *name) {
-    PyObject *res = PyObject_GenericGetAttr(self, name);
-    if (res != NULL) return res;
-    PyErr_Clear();
-    return PyObject_GetAttr(((StrictGuardObject*)self)->func, name);
+// The owner's record (created on first use), or NULL if it cannot be allocated;
+// statistics never turn a passing check into an error.
+static StatsRecordObject *stats_record(PyObject **slot, const char *kind, PyObject *owner, PyObject *attr) {
+    PyObject *existing = FT_LOAD_PTR(*slot);
+    if (likely(existing != NULL)) return (StatsRecordObject *)existing;
+    StatsRecordObject *record = PyObject_New(StatsRecordObject, StatsRecordType);
+    if (record == NULL) {
+        PyErr_Clear();
+        return NULL;
+    }
+    memset((char *)record + offsetof(StatsRecordObject, kind), 0,
+           sizeof(StatsRecordObject) - offsetof(StatsRecordObject, kind));
+    record->kind = PyUnicode_InternFromString(kind);
+    record->label = stats_label(owner, attr);
+    if (record->kind == NULL || record->label == NULL) {
+        PyErr_Clear();
+        Py_DECREF(record);
+        return NULL;
+    }
+    // Another thread may have counted the owner's first check too; only the winner is registered
+    PyObject *winner = publish_once(slot, (PyObject *)record);
+    if (winner == (PyObject *)record && PyList_Append(StatsRegistry, winner) < 0) PyErr_Clear();
+    return (StatsRecordObject *)winner;
 }
 
-static PyObject *StrictGuard_vectorcall(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
-    StrictGuardObject *self = (StrictGuardObject *)self_obj;
+// A span of validation work charged to one record; spans nest (a guarded function
+// may call other guarded functions between its argument and return checks).
+typedef struct {
+    StatsRecordObject *record;
+    StatsRecordObject *outer;
+    uint64_t start;
+} StatsSpan;
 
-    PyEval_SetProfile(strict_trace_func, self_obj);
+static inline void stats_span_begin(StatsSpan *span, StatsRecordObject *record) {
+    span->record = record;
+    span->outer = StatsCurrent;
+    StatsCurrent = record;
+    span->start = stats_now();
+}
 
-    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
-    Py_ssize_t n_pos = PyTuple_GET_SIZE(self->pos_rules);
-    for (Py_ssize_t i = 0; i < nargs && i < n_pos; i++) {
-        PyObject *rule_def = PyTuple_GET_ITEM(self->pos_rules, i);
-        if (rule_def != Py_None) {
-            if (unlikely(!fast_check_type(args[i], PyTuple_GET_ITEM(rule_def, 2)))) {
-                PyEval_SetProfile(NULL, NULL);
-                raise_type_error(PyTuple_GET_ITEM(rule_def, 0), PyTuple_GET_ITEM(rule_def, 1), args[i]);
-                return NULL;
-            }
-        }
+static inline void stats_span_end(StatsSpan *span) {
+    if (span->record != NULL) FT_ADD_U64(span->record->ns, stats_now() - span->start);
+    StatsCurrent = span->outer;
+}
+
+// fast_check_type with the check counted against the owner's record.
+static int fast_check_type(PyObject *obj, PyObject *rule);
+
+static int counted_check(PyObject **slot, const char *kind, PyObject *owner, PyObject *attr, PyObject *obj, PyObject *rule) {
+    StatsRecordObject *record = stats_record(slot, kind, owner, attr);
+    StatsSpan span;
+    stats_span_begin(&span, record);
+    int res = fast_check_type(obj, rule);
+    stats_span_end(&span);
+    if (record != NULL) {
+        FT_ADD_U64(record->calls, 1);
+        FT_ADD_U64(record->failures, res <= 0);
     }
+    return res;
+}
 
-    if (unlikely(kwnames != NULL)) {
-        Py_ssize_t nkwargs = PyTuple_GET_SIZE(kwnames);
-        for (Py_ssize_t i = 0; i < nkwargs; i++) {
-            PyObject *kw = PyTuple_GET_ITEM(kwnames, i);
-            PyObject *rule_def = PyDict_GetItemWithError(self->kw_rules, kw);
-            if (rule_def) {
-                if (unlikely(!fast_check_type(args[nargs + i], PyTuple_GET_ITEM(rule_def, 2)))) {
-                    PyEval_SetProfile(NULL, NULL);
-                    raise_type_error(kw, PyTuple_GET_ITEM(rule_def, 1), args[nargs + i]);
-                    return NULL;
-                }
-            }
-        }
+static const char *const StatsOpNames[OP_COUNT] = {
+    [OP_LIST] = "list", [OP_DICT] = "dict", [OP_TUPLE_VAR] = "tuple", [OP_TUPLE_FIXED] = "fixed_tuple",
+    [OP_SET] = "set", [OP_BUFFER] = "buffer", [OP_TYPED_DICT] = "typed_dict", [OP_NAMED_TUPLE] = "named_tuple",
+    [OP_DATACLASS] = "dataclass",
+};
+
+// enable_stats(flag): turns the counters on or off process-wide.
+static PyObject *enable_stats(PyObject *module, PyObject *arg) {
+    int flag = PyObject_IsTrue(arg);
+    if (flag < 0) return NULL;
+#if !GUARDIAN_STATS
+    if (flag) {
+        PyErr_SetString(PyExc_RuntimeError, "guardian was built with GUARDIAN_STATS=0");
+        return NULL;
     }
+#endif
+    FT_STORE_INT(StatsEnabled, flag);
+    Py_RETURN_NONE;
+}
 
-    PyObject *result = PyObject_Vectorcall(self->func, args, nargsf, kwnames);
-    PyEval_SetProfile(NULL, NULL);
+static PyObject *stats_enabled(PyObject *module, PyObject *Py_UNUSED(ignored)) {
+    return PyBool_FromLong(FT_LOAD_INT(StatsEnabled));
+}
 
-    if (result && self->check_return && self->ret_rule != Py_None) {
-        if (unlikely(!fast_check_type(result, self->ret_rule))) {
-            raise_type_error(PyUnicode_FromString("return"), self->ret_name, result);
-            Py_DECREF(result);
-            return NULL;
-        }
+static PyObject *stats_record_dict(StatsRecordObject *record) {
+    PyObject *scanned = PyDict_New();
+    for (int op = 0; scanned != NULL && op < OP_COUNT; op++) {
+        if (StatsOpNames[op] == NULL) continue;
+        PyObject *count = PyLong_FromUnsignedLongLong(FT_LOAD_U64(record->scanned[op]));
+        if (count == NULL || PyDict_SetItemString(scanned, StatsOpNames[op], count) < 0) Py_CLEAR(scanned);
+        Py_XDECREF(count);
     }
-    return result;
+    if (scanned == NULL) return NULL;
+    return Py_BuildValue("{sOsOsKsKsKsN}", "kind", record->kind, "name", record->label,
+                         "calls", (unsigned long long)FT_LOAD_U64(record->calls),
+                         "failures", (unsigned long long)FT_LOAD_U64(record->failures),
+                         "ns", (unsigned long long)FT_LOAD_U64(record->ns), "scanned", scanned);
 }
 
-static void StrictGuard_dealloc(StrictGuardObject *self) {
-    Py_XDECREF(self->func);
+// stats_snapshot(reset): one dict per record. With reset, counters restart from zero
+// and records whose owner is gone are dropped.
+static PyObject *stats_snapshot(PyObject *module, PyObject *arg) {
+    int reset = PyObject_IsTrue(arg);
+    if (reset < 0) return NULL;
+    // Work on a copy: other threads may register records meanwhile
+    PyObject *records = PyList_GetSlice(StatsRegistry, 0, PY_SSIZE_T_MAX);
+    if (records == NULL) return NULL;
+    Py_ssize_t n = PyList_GET_SIZE(records);
+    PyObject *out = PyList_New(n);
+    for (Py_ssize_t i = 0; out != NULL && i < n; i++) {
+        PyObject *entry = stats_record_dict((StatsRecordObject *)PyList_GET_ITEM(records, i));
+        if (entry == NULL) Py_CLEAR(out);
+        else PyList_SET_ITEM(out, i, entry);
+    }
+    if (out == NULL || !reset) {
+        Py_DECREF(records);
+        return out;
+    }
+
+    PyObject *live = PyList_New(0);
+    for (Py_ssize_t i = 0; live != NULL && i < n; i++) {
+        StatsRecordObject *record = (StatsRecordObject *)PyList_GET_ITEM(records, i);
+        FT_STORE_U64(record->calls, 0);
+        FT_STORE_U64(record->failures, 0);
+        FT_STORE_U64(record->ns, 0);
+        for (int op = 0; op < OP_COUNT; op++) FT_STORE_U64(record->scanned[op], 0);
+        // Referenced by the registry, the copy and its owner
+        if (Py_REFCNT(record) > 2 && PyList_Append(live, (PyObject *)record) < 0) Py_CLEAR(live);
+    }
+    // Records registered since the copy was taken stay after the live ones
+    int err = live == NULL || PyList_SetSlice(StatsRegistry, 0, n, live) < 0;
+    Py_XDECREF(live);
+    Py_DECREF(records);
+    if (err) Py_CLEAR(out);
+    return out;
+}
+
+// --- HOMOGENEOUS CONTAINER KERNEL ---
+// A list or var-length tuple whose element rule is headed by a single type (int,
+// float, str, a model class, ...) is almost always homogeneous. Its items are a
+// contiguous array of object pointers, so the element loop reduces to "find the
+// first item whose ob_type is not T": a batched scan with no per-element dispatch.
+// Only exact hits are decided here; the first miss goes through check_node, which
+// handles subclasses (bool for int) and real failures, and the scan resumes after it.
+
+// Arrays past this size are unlikely to be cache-resident; the scan then prefetches the
+// objects a few steps ahead, since each ob_type load is a dependent pointer chase.
+#define SCAN_PREFETCH_MIN 16384
+#define SCAN_PREFETCH_AHEAD 32
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define prefetch_object(p) __builtin_prefetch(p)
+#else
+    #define prefetch_object(p) ((void)0)
+#endif
+
+// Returns the index of the first item whose type is not tp, or n. Four independent
+// loads per step are folded into one branch, so the compiler is free to vectorize the
+// compares (SSE/AVX2 on x86-64, NEON on arm64); the loads themselves stay scalar.
+static Py_ssize_t scan_exact_type(PyObject *const *items, Py_ssize_t n, const PyTypeObject *tp) {
+    Py_ssize_t i = 0;
+    if (n >= SCAN_PREFETCH_MIN) {
+        for (; i + SCAN_PREFETCH_AHEAD + 4 <= n; i += 4) {
+            prefetch_object(items[i + SCAN_PREFETCH_AHEAD]);
+            prefetch_object(items[i + SCAN_PREFETCH_AHEAD + 1]);
+            prefetch_object(items[i + SCAN_PREFETCH_AHEAD + 2]);
+            prefetch_object(items[i + SCAN_PREFETCH_AHEAD + 3]);
+            if ((Py_TYPE(items[i]) != tp) | (Py_TYPE(items[i + 1]) != tp)
+                    | (Py_TYPE(items[i + 2]) != tp) | (Py_TYPE(items[i + 3]) != tp)) break;
+        }
+    }
+    for (; i + 4 <= n; i += 4) {
+        if ((Py_TYPE(items[i]) != tp) | (Py_TYPE(items[i + 1]) != tp)
+                | (Py_TYPE(items[i + 2]) != tp) | (Py_TYPE(items[i + 3]) != tp)) break;
+    }
+    for (; i < n; i++) {
+        if (Py_TYPE(items[i]) != tp) return i;
+    }
+    return n;
+}
+
+// --- BUFFER RULES ---
+// OP_BUFFER checks a PEP 3118 exporter (bytes, memoryview, array.array, NumPy, ...)
+// through its buffer view, without materializing an object per element: format,
+// item size and dimensionality come from the view, and an optional inclusive value
+// range is scanned over the raw items. Contiguous, aligned runs are scanned in blocks
+// with one branch per block, a shape the compiler turns into vector compares.
+
+#define RANGE_BLOCK 256
+
+typedef int (*RangeKernel)(const char *data, Py_ssize_t n, Py_ssize_t stride, const BufferSpec *spec);
+
+#define RANGE_SCAN(T, C, lo, hi)                                                              \
+    if (stride == (Py_ssize_t)sizeof(T) && (uintptr_t)data % sizeof(T) == 0) {                 \
+        const T *p = (const T *)data;                                                         \
+        for (Py_ssize_t i = 0; i < n; i += RANGE_BLOCK) {                                     \
+            Py_ssize_t end = n - i < RANGE_BLOCK ? n : i + RANGE_BLOCK;                        \
+            int bad = 0;                                                                      \
+            for (Py_ssize_t j = i; j < end; j++) bad |= !(((C)p[j] >= lo) & ((C)p[j] <= hi));  \
+            if (bad) return 0;                                                                \
+        }                                                                                     \
+        return 1;                                                                             \
+    }                                                                                         \
+    for (Py_ssize_t i = 0; i < n; i++) {                                                      \
+        T v;                                                                                  \
+        memcpy(&v, data + i * stride, sizeof(T));                                             \
+        if (!(((C)v >= lo) & ((C)v <= hi))) return 0;                                         \
+    }                                                                                         \
+    return 1;
+
+#define SIGNED_RANGE_KERNEL(NAME, T, TMIN, TMAX)                                              \
+static int NAME(const char *data, Py_ssize_t n, Py_ssize_t stride, const BufferSpec *spec) {  \
+    long long lo_ = spec->ilo > (long long)(TMIN) ? spec->ilo : (long long)(TMIN);            \
+    long long hi_ = spec->ihi < (long long)(TMAX) ? spec->ihi : (long long)(TMAX);            \
+    if (spec->signed_empty || lo_ > hi_) return n == 0;                                       \
+    const T lo = (T)lo_, hi = (T)hi_;                                                         \
+    RANGE_SCAN(T, T, lo, hi)                                                                  \
+}
+
+#define UNSIGNED_RANGE_KERNEL(NAME, T, TMAX)                                                  \
+static int NAME(const char *data, Py_ssize_t n, Py_ssize_t stride, const BufferSpec *spec) {  \
+    unsigned long long hi_ = spec->uhi < (unsigned long long)(TMAX) ? spec->uhi : (unsigned long long)(TMAX); \
+    if (spec->unsigned_empty || spec->ulo > hi_) return n == 0;                               \
+    const T lo = (T)spec->ulo, hi = (T)hi_;                                                   \
+    RANGE_SCAN(T, T, lo, hi)                                                                  \
+}
+
+// Compilers keep ordered floating-point compares scalar (they may trap on NaN), so the
+// contiguous float/double case is spelled out with SSE2 on x86-64 and NEON on arm64.
+// Float items are compared against float bounds rounded inward, which accepts exactly
+// the values whose double promotion lies in [lo, hi].
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HAVE_SIMD_FLOAT_RANGE 1
+
+static int simd_range_double(const double *p, Py_ssize_t n, double lo, double hi) {
+    const __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+    Py_ssize_t i = 0;
+    for (; i + RANGE_BLOCK <= n; i += RANGE_BLOCK) {
+        __m128d ok = _mm_castsi128_pd(_mm_set1_epi32(-1));
+        for (Py_ssize_t j = i; j < i + RANGE_BLOCK; j += 2) {
+            __m128d v = _mm_loadu_pd(p + j);
+            ok = _mm_and_pd(ok, _mm_and_pd(_mm_cmpge_pd(v, vlo), _mm_cmple_pd(v, vhi)));
+        }
+        if (_mm_movemask_pd(ok) != 0x3) return 0;
+    }
+    for (; i < n; i++) {
+        if (!((p[i] >= lo) & (p[i] <= hi))) return 0;
+    }
+    return 1;
+}
+
+static int simd_range_float(const float *p, Py_ssize_t n, float lo, float hi) {
+    const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+    Py_ssize_t i = 0;
+    for (; i + RANGE_BLOCK <= n; i += RANGE_BLOCK) {
+        __m128 ok = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (Py_ssize_t j = i; j < i + RANGE_BLOCK; j += 4) {
+            __m128 v = _mm_loadu_ps(p + j);
+            ok = _mm_and_ps(ok, _mm_and_ps(_mm_cmpge_ps(v, vlo), _mm_cmple_ps(v, vhi)));
+        }
+        if (_mm_movemask_ps(ok) != 0xF) return 0;
+    }
+    for (; i < n; i++) {
+        if (!((p[i] >= lo) & (p[i] <= hi))) return 0;
+    }
+    return 1;
+}
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_SIMD_FLOAT_RANGE 1
+
+static int simd_range_double(const double *p, Py_ssize_t n, double lo, double hi) {
+    const float64x2_t vlo = vdupq_n_f64(lo), vhi = vdupq_n_f64(hi);
+    Py_ssize_t i = 0;
+    for (; i + RANGE_BLOCK <= n; i += RANGE_BLOCK) {
+        uint64x2_t ok = vdupq_n_u64(~0ULL);
+        for (Py_ssize_t j = i; j < i + RANGE_BLOCK; j += 2) {
+            float64x2_t v = vld1q_f64(p + j);
+            ok = vandq_u64(ok, vandq_u64(vcgeq_f64(v, vlo), vcleq_f64(v, vhi)));
+        }
+        if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ULL) return 0;
+    }
+    for (; i < n; i++) {
+        if (!((p[i] >= lo) & (p[i] <= hi))) return 0;
+    }
+    return 1;
+}
+
+static int simd_range_float(const float *p, Py_ssize_t n, float lo, float hi) {
+    const float32x4_t vlo = vdupq_n_f32(lo), vhi = vdupq_n_f32(hi);
+    Py_ssize_t i = 0;
+    for (; i + RANGE_BLOCK <= n; i += RANGE_BLOCK) {
+        uint32x4_t ok = vdupq_n_u32(~0U);
+        for (Py_ssize_t j = i; j < i + RANGE_BLOCK; j += 4) {
+            float32x4_t v = vld1q_f32(p + j);
+            ok = vandq_u32(ok, vandq_u32(vcgeq_f32(v, vlo), vcleq_f32(v, vhi)));
+        }
+        if (vminvq_u32(ok) != ~0U) return 0;
+    }
+    for (; i < n; i++) {
+        if (!((p[i] >= lo) & (p[i] <= hi))) return 0;
+    }
+    return 1;
+}
+#endif
+
+// Narrows double bounds to the float bounds admitting the same float values.
+static void float_bounds(const BufferSpec *spec, float *lo, float *hi) {
+    *lo = (float)spec->lo;
+    if ((double)*lo < spec->lo) *lo = nextafterf(*lo, HUGE_VALF);
+    *hi = (float)spec->hi;
+    if ((double)*hi > spec->hi) *hi = nextafterf(*hi, -HUGE_VALF);
+}
+
+static int range_double(const char *data, Py_ssize_t n, Py_ssize_t stride, const BufferSpec *spec) {
+    const double lo = spec->lo, hi = spec->hi;
+#ifdef HAVE_SIMD_FLOAT_RANGE
+    if (stride == (Py_ssize_t)sizeof(double)) return simd_range_double((const double *)data, n, lo, hi);
+#endif
+    RANGE_SCAN(double, double, lo, hi)
+}
+
+static int range_float(const char *data, Py_ssize_t n, Py_ssize_t stride, const BufferSpec *spec) {
+    float lo, hi;
+    float_bounds(spec, &lo, &hi);
+#ifdef HAVE_SIMD_FLOAT_RANGE
+    if (stride == (Py_ssize_t)sizeof(float)) return simd_range_float((const float *)data, n, lo, hi);
+#endif
+    RANGE_SCAN(float, float, lo, hi)
+}
+
+SIGNED_RANGE_KERNEL(range_schar, signed char, SCHAR_MIN, SCHAR_MAX)
+SIGNED_RANGE_KERNEL(range_short, short, SHRT_MIN, SHRT_MAX)
+SIGNED_RANGE_KERNEL(range_int, int, INT_MIN, INT_MAX)
+SIGNED_RANGE_KERNEL(range_long, long, LONG_MIN, LONG_MAX)
+SIGNED_RANGE_KERNEL(range_longlong, long long, LLONG_MIN, LLONG_MAX)
+SIGNED_RANGE_KERNEL(range_ssize, Py_ssize_t, PY_SSIZE_T_MIN, PY_SSIZE_T_MAX)
+UNSIGNED_RANGE_KERNEL(range_uchar, unsigned char, UCHAR_MAX)
+UNSIGNED_RANGE_KERNEL(range_ushort, unsigned short, USHRT_MAX)
+UNSIGNED_RANGE_KERNEL(range_uint, unsigned int, UINT_MAX)
+UNSIGNED_RANGE_KERNEL(range_ulong, unsigned long, ULONG_MAX)
+UNSIGNED_RANGE_KERNEL(range_ulonglong, unsigned long long, ULLONG_MAX)
+UNSIGNED_RANGE_KERNEL(range_size, size_t, SIZE_MAX)
+
+// Range kernel for a native single-character struct format, with its item size.
+static RangeKernel range_kernel_for(char code, Py_ssize_t *size) {
+    switch (code) {
+#define KERNEL_CASE(c, fn, T) case c: *size = sizeof(T); return fn;
+        KERNEL_CASE('b', range_schar, signed char)
+        KERNEL_CASE('B', range_uchar, unsigned char)
+        KERNEL_CASE('?', range_uchar, unsigned char)
+        KERNEL_CASE('h', range_short, short)
+        KERNEL_CASE('H', range_ushort, unsigned short)
+        KERNEL_CASE('i', range_int, int)
+        KERNEL_CASE('I', range_uint, unsigned int)
+        KERNEL_CASE('l', range_long, long)
+        KERNEL_CASE('L', range_ulong, unsigned long)
+        KERNEL_CASE('q', range_longlong, long long)
+        KERNEL_CASE('Q', range_ulonglong, unsigned long long)
+        KERNEL_CASE('n', range_ssize, Py_ssize_t)
+        KERNEL_CASE('N', range_size, size_t)
+        KERNEL_CASE('f', range_float, float)
+        KERNEL_CASE('d', range_double, double)
+#undef KERNEL_CASE
+    }
+    return NULL;
+}
+
+// Walks a strided N-d view, handing each innermost row to the kernel.
+static int buffer_walk(const Py_buffer *view, RangeKernel kernel, const BufferSpec *spec, int dim, const char *data) {
+    Py_ssize_t n = view->shape[dim], stride = view->strides[dim];
+    if (dim == view->ndim - 1) return kernel(data, n, stride, spec);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        if (!buffer_walk(view, kernel, spec, dim + 1, data + i * stride)) return 0;
+    }
+    return 1;
+}
+
+// Strips a byte-order prefix that leaves the format's meaning native: '@', or '=' and the
+// host's own order when the item has its native size (NumPy exports unaligned arrays as "=d").
+static const char *native_format(const char *format, Py_ssize_t itemsize) {
+    if (format[0] == '@') return format + 1;
+#if PY_LITTLE_ENDIAN
+    int native_order = format[0] == '=' || format[0] == '<';
+#else
+    int native_order = format[0] == '=' || format[0] == '>' || format[0] == '!';
+#endif
+    Py_ssize_t size = 0;
+    if (native_order && format[1] != '\0' && format[2] == '\0' && range_kernel_for(format[1], &size) && size == itemsize) {
+        return format + 1;
+    }
+    return format;
+}
+
+static int buffer_in_range(const Py_buffer *view, const char *format, const BufferSpec *spec) {
+    Py_ssize_t size = 0;
+    RangeKernel kernel = format[0] != '\0' && format[1] == '\0' ? range_kernel_for(format[0], &size) : NULL;
+    // Byte-swapped and other non-native formats are not range-checked.
+    if (kernel == NULL || size != view->itemsize) return 0;
+    if (view->ndim == 0) return kernel(view->buf, 1, size, spec);
+    if (PyBuffer_IsContiguous(view, 'C')) return kernel(view->buf, view->len / size, size, spec);
+    return buffer_walk(view, kernel, spec, 0, view->buf);
+}
+
+static int check_buffer(const RuleNode *node, PyObject *obj) {
+    const BufferSpec *spec = node->buffer;
+    if (node->type != NULL && !PyObject_TypeCheck(obj, node->type)) return 0;
+    if (!PyObject_CheckBuffer(obj)) return 0;
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj, &view, PyBUF_RECORDS_RO) < 0) {
+        // The exporter cannot present a strided, formatted read-only view (e.g. it
+        // needs suboffsets): it does not satisfy the rule.
+        if (!PyErr_ExceptionMatches(PyExc_BufferError) && !PyErr_ExceptionMatches(PyExc_TypeError)) return -1;
+        PyErr_Clear();
+        return 0;
+    }
+    const char *format = native_format(view.format != NULL ? view.format : "B", view.itemsize);
+
+    int res = (spec->ndim < 0 || view.ndim == spec->ndim)
+              && (spec->itemsize == 0 || view.itemsize == spec->itemsize);
+    if (res && spec->formats != NULL) {
+        res = 0;
+        for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(spec->formats); i++) {
+            const char *accepted = PyUnicode_AsUTF8(PyTuple_GET_ITEM(spec->formats, i));
+            if (accepted != NULL && strcmp(accepted, format) == 0) {
+                res = 1;
+                break;
+            }
+        }
+    }
+    if (res) STATS_SCANNED(OP_BUFFER, view.itemsize > 0 ? view.len / view.itemsize : 0);
+    if (res && spec->has_range) res = buffer_in_range(&view, format, spec);
+    PyBuffer_Release(&view);
+    return res;
+}
+
+// Converts a ge/le bound to the integer bounds of the spec: a lower bound is rounded
+// up, an upper bound down, and a bound outside the 64-bit range either saturates or
+// marks that family of formats as unsatisfiable.
+static int buffer_int_bound(PyObject *bound, int upper, BufferSpec *spec) {
+    PyObject *value;
+    if (PyFloat_Check(bound)) {
+        double d = PyFloat_AS_DOUBLE(bound);
+        if (isinf(d)) {
+            if ((d > 0) != upper) spec->signed_empty = spec->unsigned_empty = 1;
+            return 0;
+        }
+        value = PyLong_FromDouble(upper ? floor(d) : ceil(d));
+    } else {
+        value = PyNumber_Index(bound);
+    }
+    if (value == NULL) return -1;
+
+    int overflow;
+    long long ll = PyLong_AsLongLongAndOverflow(value, &overflow);
+    if (ll == -1 && PyErr_Occurred()) {
+        Py_DECREF(value);
+        return -1;
+    }
+    int negative = overflow < 0 || (overflow == 0 && ll < 0);
+    if (upper) {
+        if (overflow < 0) spec->signed_empty = 1;
+        else spec->ihi = overflow > 0 ? LLONG_MAX : ll;
+        if (negative) {
+            spec->unsigned_empty = 1;
+        } else {
+            unsigned long long ull = PyLong_AsUnsignedLongLong(value);
+            if (ull == (unsigned long long)-1 && PyErr_Occurred()) {
+                PyErr_Clear();
+                ull = ULLONG_MAX;
+            }
+            spec->uhi = ull;
+        }
+    } else {
+        if (overflow > 0) spec->signed_empty = 1;
+        else spec->ilo = overflow < 0 ? LLONG_MIN : ll;
+        if (!negative) {
+            unsigned long long ull = PyLong_AsUnsignedLongLong(value);
+            if (ull == (unsigned long long)-1 && PyErr_Occurred()) {
+                PyErr_Clear();
+                spec->unsigned_empty = 1;
+            }
+            spec->ulo = ull;
+        }
+    }
+    Py_DECREF(value);
+    return 0;
+}
+
+static int buffer_float_bound(PyObject *bound, double *out) {
+    *out = PyFloat_AsDouble(bound);
+    if (*out == -1.0 && PyErr_Occurred()) {
+        if (!PyErr_ExceptionMatches(PyExc_OverflowError)) return -1;
+        PyErr_Clear();  // an int beyond double range
+        int overflow;
+        PyLong_AsLongLongAndOverflow(bound, &overflow);
+        *out = overflow < 0 ? -Py_HUGE_VAL : Py_HUGE_VAL;
+    }
+    return 0;
+}
+
+// Fills a spec from (type, formats, itemsize, ndim, ge, le); the arg was validated by rule_measure.
+static int buffer_spec_init(BufferSpec *spec, PyObject *arg) {
+    PyObject *formats = PyTuple_GET_ITEM(arg, 1), *ge = PyTuple_GET_ITEM(arg, 4), *le = PyTuple_GET_ITEM(arg, 5);
+    spec->formats = formats == Py_None ? NULL : formats;
+    spec->itemsize = PyLong_AsSsize_t(PyTuple_GET_ITEM(arg, 2));
+    spec->ndim = (int)PyLong_AsLong(PyTuple_GET_ITEM(arg, 3));
+    spec->has_range = ge != Py_None || le != Py_None;
+    spec->lo = -Py_HUGE_VAL;
+    spec->hi = Py_HUGE_VAL;
+    spec->ilo = LLONG_MIN;
+    spec->ihi = LLONG_MAX;
+    spec->ulo = 0;
+    spec->uhi = ULLONG_MAX;
+    if (ge != Py_None && (buffer_float_bound(ge, &spec->lo) < 0 || buffer_int_bound(ge, 0, spec) < 0)) return -1;
+    if (le != Py_None && (buffer_float_bound(le, &spec->hi) < 0 || buffer_int_bound(le, 1, spec) < 0)) return -1;
+    return 0;
+}
+
+static int check_node(const RuleObject *r, const RuleNode *node, PyObject *obj);
+static int guarded_accepts(PyObject *obj, const RuleObject *r, const RuleNode *node);
+
+// Item i of a list or tuple as a new reference, or NULL past its end. For checks that
+// read a list one item at a time and may run Python code in between.
+static PyObject *sequence_item_ref(PyObject *obj, Py_ssize_t i) {
+    if (!PyList_Check(obj)) return i < PyTuple_GET_SIZE(obj) ? Py_NewRef(PyTuple_GET_ITEM(obj, i)) : NULL;
+    PyObject *item = NULL;
+    Py_BEGIN_CRITICAL_SECTION(obj);
+    if (i < PyList_GET_SIZE(obj)) item = Py_NewRef(PyList_GET_ITEM(obj, i));
+    Py_END_CRITICAL_SECTION();
+    return item;
+}
+
+// PyDict_Next with new references in *key and *value, for the same kind of walk.
+static int dict_next_ref(PyObject *dict, Py_ssize_t *pos, PyObject **key, PyObject **value) {
+    int found;
+    Py_BEGIN_CRITICAL_SECTION(dict);
+    found = PyDict_Next(dict, pos, key, value);
+    if (found) {
+        Py_INCREF(*key);
+        Py_INCREF(*value);
+    }
+    Py_END_CRITICAL_SECTION();
+    return found;
+}
+
+// Element loop for NODE_HOMOGENEOUS lists and tuples. The item array is re-read after
+// every fallback check, since check_node may run Python code that resizes a list, and
+// the item under check is held so that code cannot free it either.
+static int check_homogeneous(const RuleObject *r, const RuleNode *item_rule, PyObject *obj) {
+    Py_ssize_t i = 0;
+    for (;;) {
+        PyObject *const *items = PyList_Check(obj) ? ((PyListObject *)obj)->ob_item : ((PyTupleObject *)obj)->ob_item;
+        Py_ssize_t n = Py_SIZE(obj);
+        if (i < n) i += scan_exact_type(items + i, n - i, item_rule->type);
+        if (i >= n) return 1;
+        if (item_rule->op == OP_EXACT) return 0;
+        PyObject *item = Py_NewRef(items[i]);
+        int res = check_node(r, item_rule, item);
+        Py_DECREF(item);
+        if (res <= 0) return res;
+        i++;
+    }
+}
+
+// Equality lookup for OP_LITERAL values that are not one of the allowed objects (e.g. a
+// string parsed from JSON). The type must match too, so True does not pass Literal[1].
+static int literal_lookup(const RuleNode *node, PyObject *obj) {
+    PyObject *candidates = PyDict_GetItemWithError(node->table, obj);
+    if (candidates == NULL) {
+        if (!PyErr_Occurred()) return 0;
+        if (!PyErr_ExceptionMatches(PyExc_TypeError)) return -1;
+        PyErr_Clear();  // unhashable: equal to no allowed value
+        return 0;
+    }
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(candidates); i++) {
+        if (Py_IS_TYPE(PyTuple_GET_ITEM(candidates, i), Py_TYPE(obj))) return 1;
+    }
+    return 0;
+}
+
+// getattr(obj, name): 1 with a new reference in *value, 0 if the attribute is missing, -1 on error.
+static int lookup_attr(PyObject *obj, PyObject *name, PyObject **value) {
+    *value = PyObject_GetAttr(obj, name);
+    if (*value != NULL) return 1;
+    if (!PyErr_ExceptionMatches(PyExc_AttributeError)) return -1;
+    PyErr_Clear();
+    return 0;
+}
+
+// Ordered first-match scan used by plain unions and dispatch-table misses.
+static int check_branches(const RuleObject *r, const RuleNode *node, PyObject *obj) {
+    for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+        int res = check_node(r, RULE_KID(r, node, i), obj);
+        if (res != 0) return res;
+    }
+    return 0;
+}
+
+// Resolves the branch a tagged union selects for obj: 1 with *index set, 0 if the
+// tag is missing or names no branch, -1 with an exception set.
+static int tagged_union_branch(const RuleNode *node, PyObject *obj, Py_ssize_t *index) {
+    PyObject *tag;
+    if (node->flags & NODE_TAG_MAPPING) {
+        if (unlikely(!PyDict_Check(obj))) return 0;
+        int found = PyDict_GetItemRef(obj, node->arg, &tag);
+        if (found <= 0) return found;
+    } else {
+        tag = PyObject_GetAttr(obj, node->arg);
+        if (tag == NULL) {
+            if (!PyErr_ExceptionMatches(PyExc_AttributeError)) return -1;
+            PyErr_Clear();
+            return 0;
+        }
+    }
+    PyObject *value = PyDict_GetItemWithError(node->table, tag);
+    Py_DECREF(tag);
+    if (value == NULL) {
+        if (!PyErr_Occurred()) return 0;
+        if (!PyErr_ExceptionMatches(PyExc_TypeError)) return -1;
+        PyErr_Clear();  // unhashable tag value: cannot be a valid discriminator
+        return 0;
+    }
+    *index = PyLong_AsSsize_t(value);
+    return 1;
+}
+
+// A node and the object a check is inside of, for checks that resume part-way down.
+typedef struct {
+    const RuleNode *node;
+    PyObject *obj;
+} DeepVisit;
+
+static int check_deep(const RuleObject *r, const RuleNode *root, PyObject *obj, const DeepVisit *outer, Py_ssize_t n_outer);
+
+static int check_node(const RuleObject *r, const RuleNode *node, PyObject *obj) {
+    if (unlikely(node->flags & NODE_RECURSIVE)) return check_deep(r, node, obj, NULL, 0);
+    switch (node->op) {
+        case OP_ANY: return 1;
+        case OP_EXACT:
+            return Py_TYPE(obj) == node->type;
+        case OP_INSTANCE: {
+            PyTypeObject *tp = Py_TYPE(obj);
+            if (tp == node->type) return 1;
+            if (node->cache == NULL) return PyObject_IsInstance(obj, node->arg);
+
+            int cached;
+            if (likely(cache_lookup(node->cache, tp, &cached))) return cached;
+
+            int res = PyObject_IsInstance(obj, node->arg);
+            if (res == 1 || (res == 0 && (node->flags & NODE_CACHE_NEGATIVE))) {
+                cache_store(node->cache, tp, res);
+            }
+            return res;
+        }
+        case OP_UNION: {
+            if (node->cache == NULL) return check_branches(r, node, obj);
+            PyTypeObject *tp = Py_TYPE(obj);
+            Py_ssize_t hint = -1;
+            int cached;
+            if (cache_lookup(node->cache, tp, &cached)) {
+                if (cached & UNION_HINT_DEFINITIVE) return 1;
+                hint = cached;
+                int res = check_node(r, RULE_KID(r, node, hint), obj);
+                if (res != 0) return res;
+            }
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                if (i == hint) continue;
+                const RuleNode *branch = RULE_KID(r, node, i);
+                int res = check_node(r, branch, obj);
+                if (res < 0) return res;
+                if (res) {
+                    int value = (int)i;
+                    if (branch->flags & NODE_TYPE_DETERMINED) value |= UNION_HINT_DEFINITIVE;
+                    cache_store(node->cache, tp, value);
+                    return 1;
+                }
+            }
+            return 0;
+        }
+        case OP_LIST: {
+            if (unlikely(!PyList_Check(obj))) return 0;
+            if (node->n_kids == 0) return 1;
+            if (!PyList_CheckExact(obj)) {
+                int accepted = guarded_accepts(obj, r, node);
+                if (accepted != 0) return accepted;
+            }
+            STATS_SCANNED(OP_LIST, PyList_GET_SIZE(obj));
+            const RuleNode *item_rule = RULE_KID(r, node, 0);
+            int res = 1;
+            Py_BEGIN_CRITICAL_SECTION(obj);
+            if (node->flags & NODE_HOMOGENEOUS) {
+                res = check_homogeneous(r, item_rule, obj);
+            } else {
+                for (Py_ssize_t i = 0; res > 0 && i < PyList_GET_SIZE(obj); i++) {
+                    PyObject *item = Py_NewRef(PyList_GET_ITEM(obj, i));
+                    res = check_node(r, item_rule, item);
+                    Py_DECREF(item);
+                }
+            }
+            Py_END_CRITICAL_SECTION();
+            return res;
+        }
+        case OP_DICT: {
+            if (unlikely(!PyDict_Check(obj))) return 0;
+            if (node->n_kids == 0) return 1;
+            if (!PyDict_CheckExact(obj)) {
+                int accepted = guarded_accepts(obj, r, node);
+                if (accepted != 0) return accepted;
+            }
+            STATS_SCANNED(OP_DICT, PyDict_GET_SIZE(obj));
+            const RuleNode *k_rule = RULE_KID(r, node, 0);
+            const RuleNode *v_rule = RULE_KID(r, node, 1);
+            PyObject *key, *value;
+            Py_ssize_t pos = 0;
+            int res = 1;
+            Py_BEGIN_CRITICAL_SECTION(obj);
+            while (res > 0 && PyDict_Next(obj, &pos, &key, &value)) {
+                Py_INCREF(key);  // a check running Python code may drop the entry
+                Py_INCREF(value);
+                res = check_node(r, k_rule, key);
+                if (res > 0) res = check_node(r, v_rule, value);
+                Py_DECREF(key);
+                Py_DECREF(value);
+            }
+            Py_END_CRITICAL_SECTION();
+            return res;
+        }
+        case OP_TUPLE_VAR: {
+            if (unlikely(!PyTuple_Check(obj))) return 0;
+            STATS_SCANNED(OP_TUPLE_VAR, PyTuple_GET_SIZE(obj));
+            const RuleNode *item_rule = RULE_KID(r, node, 0);
+            if (node->flags & NODE_HOMOGENEOUS) return check_homogeneous(r, item_rule, obj);
+            Py_ssize_t size = PyTuple_GET_SIZE(obj);
+            for (Py_ssize_t i = 0; i < size; i++) {
+                int res = check_node(r, item_rule, PyTuple_GET_ITEM(obj, i));
+                if (res <= 0) return res;
+            }
+            return 1;
+        }
+        case OP_TUPLE_FIXED: {
+            if (unlikely(!PyTuple_Check(obj))) return 0;
+            if (PyTuple_GET_SIZE(obj) != node->n_kids) return 0;
+            STATS_SCANNED(OP_TUPLE_FIXED, node->n_kids);
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                int res = check_node(r, RULE_KID(r, node, i), PyTuple_GET_ITEM(obj, i));
+                if (res <= 0) return res;
+            }
+            return 1;
+        }
+        case OP_SET: {
+            if (unlikely(!PyAnySet_Check(obj))) return 0;
+            if (node->n_kids == 0) return 1;
+            if (!PyAnySet_CheckExact(obj)) {
+                int accepted = guarded_accepts(obj, r, node);
+                if (accepted != 0) return accepted;
+            }
+            STATS_SCANNED(OP_SET, PySet_GET_SIZE(obj));
+            const RuleNode *item_rule = RULE_KID(r, node, 0);
+            PyObject *iter = PyObject_GetIter(obj);
+            if (iter == NULL) return -1;
+            PyObject *item;
+            int res = 1;
+            while ((item = PyIter_Next(iter))) {
+                res = check_node(r, item_rule, item);
+                Py_DECREF(item);
+                if (res <= 0) break;
+            }
+            Py_DECREF(iter);
+            if (res > 0 && PyErr_Occurred()) return -1;
+            return res;
+        }
+        case OP_LITERAL: {
+            for (size_t i = pointer_hash(obj) & node->dispatch_mask;; i = (i + 1) & node->dispatch_mask) {
+                PyObject *value = node->literals[i];
+                if (value == obj) return 1;
+                if (value == NULL) break;
+            }
+            // Allowed strings are interned, so an interned string that missed equals none of them
+            if (PyUnicode_CheckExact(obj) && PyUnicode_CHECK_INTERNED(obj)) return 0;
+            return literal_lookup(node, obj);
+        }
+        case OP_UNION_DISPATCH: {
+            // Branch heads are pairwise unrelated types, so an exact-type hit names the
+            // only branch that can accept obj. Subclass instances fall back to the scan.
+            PyTypeObject *tp = Py_TYPE(obj);
+            size_t i = dispatch_hash(tp) & node->dispatch_mask;
+            for (;;) {
+                const DispatchSlot *slot = &node->dispatch[i];
+                if (slot->type == tp) return check_node(r, &r->nodes[slot->kid], obj);
+                if (slot->type == NULL) break;
+                i = (i + 1) & node->dispatch_mask;
+            }
+            return check_branches(r, node, obj);
+        }
+        case OP_TAGGED_UNION: {
+            Py_ssize_t index;
+            int res = tagged_union_branch(node, obj, &index);
+            return res > 0 ? check_node(r, RULE_KID(r, node, index), obj) : res;
+        }
+        case OP_BUFFER:
+            return check_buffer(node, obj);
+        case OP_TYPED_DICT: {
+            if (unlikely(!PyDict_Check(obj))) return 0;
+            STATS_SCANNED(OP_TYPED_DICT, node->n_kids);
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                PyObject *value;
+                int found = PyDict_GetItemRef(obj, PyTuple_GET_ITEM(node->arg, i), &value);
+                if (found <= 0) {
+                    if (found < 0) return -1;
+                    if (PyTuple_GET_ITEM(node->table, i) == Py_True) return 0;
+                    continue;
+                }
+                int res = check_node(r, RULE_KID(r, node, i), value);
+                Py_DECREF(value);
+                if (res <= 0) return res;
+            }
+            return 1;
+        }
+        case OP_NAMED_TUPLE: {
+            if (unlikely(!PyObject_TypeCheck(obj, node->type)) || PyTuple_GET_SIZE(obj) != node->n_kids) return 0;
+            STATS_SCANNED(OP_NAMED_TUPLE, node->n_kids);
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                int res = check_node(r, RULE_KID(r, node, i), PyTuple_GET_ITEM(obj, i));
+                if (res <= 0) return res;
+            }
+            return 1;
+        }
+        case OP_DATACLASS: {
+            if (unlikely(!PyObject_TypeCheck(obj, node->type))) return 0;
+            STATS_SCANNED(OP_DATACLASS, node->n_kids);
+            // Slot offsets are only trusted for the class itself: a subclass may shadow a field
+            int exact = Py_TYPE(obj) == node->type;
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                Py_ssize_t offset = exact ? RULE_FIELD_OFFSET(r, node, i) : 0;
+                PyObject *value;
+                if (offset != 0) {
+                    value = Py_XNewRef(slot_load(obj, offset));
+                    if (value == NULL) return 0;
+                } else {
+                    int found = lookup_attr(obj, PyTuple_GET_ITEM(node->arg, i), &value);
+                    if (found <= 0) return found;
+                }
+                int res = check_node(r, RULE_KID(r, node, i), value);
+                Py_DECREF(value);
+                if (res <= 0) return res;
+            }
+            return 1;
+        }
+        case OP_PROTOCOL: {
+            PyTypeObject *tp = Py_TYPE(obj);
+            int cached;
+            if (likely(cache_lookup(node->cache, tp, &cached))) return cached;
+            // Members found on the type decide for every instance of it; instance attributes do not
+            int per_type = 1;
+            for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(node->arg); i++) {
+                PyObject *name = PyTuple_GET_ITEM(node->arg, i), *value;
+                if (_PyType_Lookup(tp, name) != NULL) continue;
+                per_type = 0;
+                int found = lookup_attr(obj, name, &value);
+                if (found <= 0) return found;
+                Py_DECREF(value);
+            }
+            if (per_type) cache_store(node->cache, tp, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// --- RECURSIVE RULES ---
+// Without OP_REF a rule is a tree, so check_node recurses at most as deep as the hint
+// itself is nested. A back-reference lets the data decide instead, so nodes marked
+// NODE_RECURSIVE are walked here on an explicit, heap-grown stack of frames. Each
+// frame hands out its children one at a time and folds their verdicts back in: every
+// child must pass, except for union branches, where the first pass decides. Subtrees
+// without a back-reference are still handed to check_node.
+
+#define DEEP_INLINE_FRAMES 32
+#define DEEP_NEXT    2   // the frame wants its next child checked
+#define DEEP_DESCEND 3   // deep_next produced a child to check
+
+static Py_ssize_t MaxDepth = 1000;   // nested OP_REF expansions allowed in one check; FT_LOAD_SSIZE
+
+typedef struct {
+    const RuleNode *node;
+    PyObject *obj;              // strong reference
+    PyObject *held;             // OP_DICT: the value waiting for its check; OP_SET: the iterator
+    const RuleNode *target;     // sole child of tagged unions and dispatch hits
+    Py_ssize_t pos;             // next child (the PyDict_Next position for OP_DICT)
+    Py_ssize_t hint;            // OP_UNION: cached branch, tried first; -1 if none
+    Py_ssize_t branch;          // OP_UNION: branch under test
+    int expanded;               // entered through an OP_REF
+} DeepFrame;
+
+// Takes over obj. Returns DEEP_NEXT once the frame is set up, or the node's verdict
+// when its shape alone decides (obj is released then).
+static int deep_open(const RuleObject *r, DeepFrame *f, const RuleNode *node, PyObject *obj) {
+    int res = DEEP_NEXT, accepted;
+    f->node = node;
+    f->held = NULL;
+    f->target = NULL;
+    f->pos = 0;
+    f->hint = -1;
+    f->branch = -1;
+    f->expanded = 0;
+    switch (node->op) {
+        case OP_UNION: {
+            int cached;
+            if (node->cache != NULL && cache_lookup(node->cache, Py_TYPE(obj), &cached)) {
+                if (cached & UNION_HINT_DEFINITIVE) res = 1;
+                else f->hint = cached;
+            }
+            break;
+        }
+        case OP_UNION_DISPATCH: {
+            PyTypeObject *tp = Py_TYPE(obj);
+            for (size_t i = dispatch_hash(tp) & node->dispatch_mask;; i = (i + 1) & node->dispatch_mask) {
+                const DispatchSlot *slot = &node->dispatch[i];
+                if (slot->type == tp) f->target = &r->nodes[slot->kid];
+                if (slot->type == tp || slot->type == NULL) break;
+            }
+            break;
+        }
+        case OP_TAGGED_UNION: {
+            Py_ssize_t index;
+            res = tagged_union_branch(node, obj, &index);
+            if (res > 0) {
+                f->target = RULE_KID(r, node, index);
+                res = DEEP_NEXT;
+            }
+            break;
+        }
+        case OP_LIST:
+            if (unlikely(!PyList_Check(obj))) res = 0;
+            else if (!PyList_CheckExact(obj) && (accepted = guarded_accepts(obj, r, node)) != 0) res = accepted;
+            else STATS_SCANNED(OP_LIST, PyList_GET_SIZE(obj));
+            break;
+        case OP_DICT:
+            if (unlikely(!PyDict_Check(obj))) res = 0;
+            else if (!PyDict_CheckExact(obj) && (accepted = guarded_accepts(obj, r, node)) != 0) res = accepted;
+            else STATS_SCANNED(OP_DICT, PyDict_GET_SIZE(obj));
+            break;
+        case OP_SET:
+            if (unlikely(!PyAnySet_Check(obj))) res = 0;
+            else if (!PyAnySet_CheckExact(obj) && (accepted = guarded_accepts(obj, r, node)) != 0) res = accepted;
+            else {
+                STATS_SCANNED(OP_SET, PySet_GET_SIZE(obj));
+                f->held = PyObject_GetIter(obj);
+                if (f->held == NULL) res = -1;
+            }
+            break;
+        case OP_TUPLE_VAR:
+            if (unlikely(!PyTuple_Check(obj))) res = 0;
+            else STATS_SCANNED(OP_TUPLE_VAR, PyTuple_GET_SIZE(obj));
+            break;
+        case OP_TUPLE_FIXED:
+            if (unlikely(!PyTuple_Check(obj)) || PyTuple_GET_SIZE(obj) != node->n_kids) res = 0;
+            else STATS_SCANNED(OP_TUPLE_FIXED, node->n_kids);
+            break;
+        case OP_TYPED_DICT:
+            if (unlikely(!PyDict_Check(obj))) res = 0;
+            else STATS_SCANNED(OP_TYPED_DICT, node->n_kids);
+            break;
+        case OP_NAMED_TUPLE:
+            if (unlikely(!PyObject_TypeCheck(obj, node->type)) || PyTuple_GET_SIZE(obj) != node->n_kids) res = 0;
+            else STATS_SCANNED(OP_NAMED_TUPLE, node->n_kids);
+            break;
+        case OP_DATACLASS:
+            if (unlikely(!PyObject_TypeCheck(obj, node->type))) res = 0;
+            else STATS_SCANNED(OP_DATACLASS, node->n_kids);
+            break;
+        default:
+            res = check_node(r, node, obj);  // leaves never carry NODE_RECURSIVE
+    }
+    if (res != DEEP_NEXT) {
+        Py_DECREF(obj);
+        return res;
+    }
+    f->obj = obj;
+    return DEEP_NEXT;
+}
+
+// Produces the frame's next child: DEEP_DESCEND with *kid and a new reference in
+// *child, or the frame's verdict once there is nothing left to check.
+static int deep_next(const RuleObject *r, DeepFrame *f, const RuleNode **kid, PyObject **child) {
+    const RuleNode *node = f->node;
+    PyObject *obj = f->obj;
+    if (f->target != NULL) {
+        if (f->pos++ > 0) return 1;  // the one child passed
+        *kid = f->target;
+        *child = Py_NewRef(obj);
+        return DEEP_DESCEND;
+    }
+    switch (node->op) {
+        case OP_UNION:
+        case OP_UNION_DISPATCH: {
+            // The cached branch first, then the others in declaration order
+            Py_ssize_t i = f->pos++;
+            if (f->hint >= 0) i = i == 0 ? f->hint : i - 1 < f->hint ? i - 1 : i;
+            if (i >= node->n_kids) return 0;
+            f->branch = i;
+            *kid = RULE_KID(r, node, i);
+            *child = Py_NewRef(obj);
+            return DEEP_DESCEND;
+        }
+        case OP_LIST:
+        case OP_TUPLE_VAR:
+        case OP_TUPLE_FIXED:
+        case OP_NAMED_TUPLE: {
+            // The size is re-read every step: a check may run Python code that resizes a list
+            PyObject *item = sequence_item_ref(obj, f->pos);
+            if (item == NULL) return 1;
+            int positional = node->op == OP_TUPLE_FIXED || node->op == OP_NAMED_TUPLE;
+            *kid = RULE_KID(r, node, positional ? f->pos : 0);
+            *child = item;
+            f->pos++;
+            return DEEP_DESCEND;
+        }
+        case OP_DICT: {
+            if (f->held != NULL) {  // the key passed, now its value
+                *kid = RULE_KID(r, node, 1);
+                *child = f->held;
+                f->held = NULL;
+                return DEEP_DESCEND;
+            }
+            PyObject *key;
+            if (!dict_next_ref(obj, &f->pos, &key, &f->held)) return 1;
+            *kid = RULE_KID(r, node, 0);
+            *child = key;
+            return DEEP_DESCEND;
+        }
+        case OP_SET: {
+            *child = PyIter_Next(f->held);
+            if (*child == NULL) return PyErr_Occurred() ? -1 : 1;
+            *kid = RULE_KID(r, node, 0);
+            return DEEP_DESCEND;
+        }
+        case OP_TYPED_DICT:
+            while (f->pos < node->n_kids) {
+                Py_ssize_t i = f->pos++;
+                int found = PyDict_GetItemRef(obj, PyTuple_GET_ITEM(node->arg, i), child);
+                if (found <= 0) {
+                    if (found < 0) return -1;
+                    if (PyTuple_GET_ITEM(node->table, i) == Py_True) return 0;
+                    continue;
+                }
+                *kid = RULE_KID(r, node, i);
+                return DEEP_DESCEND;
+            }
+            return 1;
+        case OP_DATACLASS: {
+            if (f->pos >= node->n_kids) return 1;
+            Py_ssize_t i = f->pos++;
+            // Slot offsets are only trusted for the class itself, as in check_node
+            Py_ssize_t offset = Py_IS_TYPE(obj, node->type) ? RULE_FIELD_OFFSET(r, node, i) : 0;
+            if (offset != 0) {
+                *child = Py_XNewRef(slot_load(obj, offset));
+                if (*child == NULL) return 0;
+            } else {
+                int found = lookup_attr(obj, PyTuple_GET_ITEM(node->arg, i), child);
+                if (found <= 0) return found;
+            }
+            *kid = RULE_KID(r, node, i);
+            return DEEP_DESCEND;
+        }
+    }
+    return 0;
+}
+
+// Folds a child's verdict into its frame: DEEP_NEXT to go on, or the frame's verdict.
+static int deep_fold(const RuleObject *r, DeepFrame *f, int res) {
+    if (res < 0) return -1;
+    const RuleNode *node = f->node;
+    if (f->target != NULL || (node->op != OP_UNION && node->op != OP_UNION_DISPATCH)) return res ? DEEP_NEXT : 0;
+    if (res == 0) return DEEP_NEXT;
+    if (node->op == OP_UNION && node->cache != NULL && f->branch != f->hint) {
+        int value = (int)f->branch;
+        if (RULE_KID(r, node, f->branch)->flags & NODE_TYPE_DETERMINED) value |= UNION_HINT_DEFINITIVE;
+        cache_store(node->cache, Py_TYPE(f->obj), value);
+    }
+    return 1;
+}
+
+// True if obj is already being checked against target further up the stack (or in the
+// outer check this one resumes): the data loops back on itself there, and the check in
+// progress covers this visit too.
+static int deep_revisits(const DeepFrame *stack, Py_ssize_t depth, const DeepVisit *outer, Py_ssize_t n_outer,
+                         const RuleNode *target, PyObject *obj) {
+    for (Py_ssize_t i = depth - 1; i >= 0; i--) {
+        if (stack[i].node == target && stack[i].obj == obj) return 1;
+    }
+    for (Py_ssize_t i = n_outer - 1; i >= 0; i--) {
+        if (outer[i].node == target && outer[i].obj == obj) return 1;
+    }
+    return 0;
+}
+
+static int check_deep(const RuleObject *r, const RuleNode *root, PyObject *obj, const DeepVisit *outer, Py_ssize_t n_outer) {
+    DeepFrame inline_frames[DEEP_INLINE_FRAMES];
+    DeepFrame *stack = inline_frames;
+    Py_ssize_t capacity = DEEP_INLINE_FRAMES, depth = 0, expansions = 0, limit = FT_LOAD_SSIZE(MaxDepth);
+    const RuleNode *kid = root;
+    PyObject *child = Py_NewRef(obj);
+    int res = DEEP_DESCEND;
+    for (;;) {
+        if (res == DEEP_DESCEND) {
+            // An OP_REF is not a frame of its own: its target's frame counts the expansion
+            int expanded = kid->op == OP_REF;
+            if (expanded) kid = RULE_KID(r, kid, 0);
+            if (!(kid->flags & NODE_RECURSIVE)) {
+                res = check_node(r, kid, child);
+                Py_DECREF(child);
+            } else {
+                if (depth == capacity) {
+                    DeepFrame *grown = PyMem_Malloc(2 * capacity * sizeof(DeepFrame));
+                    if (grown == NULL) {
+                        Py_DECREF(child);
+                        PyErr_NoMemory();
+                        res = -1;
+                        goto fold;
+                    }
+                    memcpy(grown, stack, capacity * sizeof(DeepFrame));
+                    if (stack != inline_frames) PyMem_Free(stack);
+                    stack = grown;
+                    capacity *= 2;
+                }
+                res = deep_open(r, &stack[depth], kid, child);
+                if (res == DEEP_NEXT && expanded) {
+                    DeepFrame *f = &stack[depth];
+                    if (deep_revisits(stack, depth, outer, n_outer, kid, f->obj)) {
+                        res = 1;
+                    } else if (expansions >= limit) {
+                        PyErr_Format(PyExc_RecursionError, "value nests deeper than the maximum depth of %zd", limit);
+                        res = -1;
+                    }
+                    if (res != DEEP_NEXT) {
+                        Py_DECREF(f->obj);
+                        Py_XDECREF(f->held);
+                    } else {
+                        f->expanded = 1;
+                        expansions++;
+                    }
+                }
+                if (res == DEEP_NEXT) depth++;
+            }
+        fold:
+            if (res != DEEP_NEXT) {
+                if (depth == 0) break;
+                res = deep_fold(r, &stack[depth - 1], res);
+            }
+        }
+        DeepFrame *f = &stack[depth - 1];
+        if (res == DEEP_NEXT) res = deep_next(r, f, &kid, &child);
+        if (res == DEEP_DESCEND) continue;
+        // The frame on top is decided
+        expansions -= f->expanded;
+        Py_DECREF(f->obj);
+        Py_XDECREF(f->held);
+        if (--depth == 0) break;
+        res = deep_fold(r, &stack[depth - 1], res);
+    }
+    if (stack != inline_frames) PyMem_Free(stack);
+    return res;
+}
+
+// set_max_depth(depth): how many times one check may re-enter a recursive alias.
+// Returns the previous limit.
+static PyObject *set_max_depth(PyObject *module, PyObject *arg) {
+    Py_ssize_t depth = PyLong_AsSsize_t(arg);
+    if (depth == -1 && PyErr_Occurred()) return NULL;
+    if (depth < 1) {
+        PyErr_SetString(PyExc_ValueError, "max depth must be at least 1");
+        return NULL;
+    }
+    Py_ssize_t previous = FT_EXCHANGE_SSIZE(MaxDepth, depth);
+    return PyLong_FromSsize_t(previous);
+}
+
+static PyObject *max_depth(PyObject *module, PyObject *Py_UNUSED(ignored)) {
+    return PyLong_FromSsize_t(FT_LOAD_SSIZE(MaxDepth));
+}
+
+// Returns 1 if obj satisfies rule, 0 if it does not, and -1 with an exception set
+// if a check itself raised (e.g. a failing __instancecheck__ or __eq__).
+static inline int fast_check_type(PyObject *obj, PyObject *rule) {
+    if (unlikely(rule == Py_None)) return 1;
+    const RuleObject *r = (const RuleObject *)rule;
+    return check_node(r, r->nodes, obj);
+}
+
+// Pass 1: validate the tuple tree and count the nodes / kid slots it needs.
+static size_t dispatch_table_size(Py_ssize_t n_entries) {
+    size_t size = 8;
+    while (size < (size_t)n_entries * 2) size <<= 1;
+    return size;
+}
+
+// Element counts for each array of the rule's shared allocation.
+typedef struct {
+    Py_ssize_t nodes;
+    Py_ssize_t kids;
+    Py_ssize_t caches;
+    Py_ssize_t slots;
+    Py_ssize_t buffers;
+    Py_ssize_t literals;
+} RuleSizes;
+
+static int rule_measure_branches(PyObject *branches, RuleSizes *n);
+
+static int rule_measure(PyObject *rule, RuleSizes *n) {
+    if (!PyTuple_Check(rule) || PyTuple_GET_SIZE(rule) != 2) {
+        PyErr_Format(PyExc_TypeError, "rule must be an (op, arg) tuple, got %R", rule);
+        return -1;
+    }
+    long op = PyLong_AsLong(PyTuple_GET_ITEM(rule, 0));
+    if (op == -1 && PyErr_Occurred()) return -1;
+    PyObject *arg = PyTuple_GET_ITEM(rule, 1);
+
+    if (Py_EnterRecursiveCall(" while lowering a guardian rule")) return -1;
+    int res = 0;
+    n->nodes++;
+
+    switch (op) {
+        case OP_ANY:
+            break;
+        case OP_EXACT:
+            if (!PyType_Check(arg)) {
+                PyErr_Format(PyExc_TypeError, "OP_EXACT expects a type, got %R", arg);
+                res = -1;
+            }
+            break;
+        case OP_INSTANCE:
+            n->caches += 1;
+            break;
+        case OP_LIST:
+        case OP_SET:
+            if (arg == Py_None) break;
+            /* fall through */
+        case OP_TUPLE_VAR:
+            n->kids += 1;
+            res = rule_measure(arg, n);
+            break;
+        case OP_DICT:
+            if (arg == Py_None) break;
+            if (!PyTuple_Check(arg) || PyTuple_GET_SIZE(arg) != 2) {
+                PyErr_Format(PyExc_TypeError, "OP_DICT expects a (key_rule, value_rule) pair, got %R", arg);
+                res = -1;
+                break;
+            }
+            n->kids += 2;
+            res = rule_measure(PyTuple_GET_ITEM(arg, 0), n);
+            if (res == 0) res = rule_measure(PyTuple_GET_ITEM(arg, 1), n);
+            break;
+        case OP_UNION:
+        case OP_TUPLE_FIXED:
+            if (op == OP_UNION) n->caches += 1;
+            res = rule_measure_branches(arg, n);
+            break;
+        case OP_UNION_DISPATCH: {
+            PyObject *table = PyTuple_Check(arg) && PyTuple_GET_SIZE(arg) == 2 ? PyTuple_GET_ITEM(arg, 1) : NULL;
+            if (table == NULL || !PyDict_Check(table)) {
+                PyErr_Format(PyExc_TypeError, "OP_UNION_DISPATCH expects (branches, {type: index}), got %R", arg);
+                res = -1;
+                break;
+            }
+            res = rule_measure_branches(PyTuple_GET_ITEM(arg, 0), n);
+            if (res < 0) break;
+            PyObject *key, *value;
+            Py_ssize_t pos = 0;
+            while (PyDict_Next(table, &pos, &key, &value)) {
+                Py_ssize_t index = PyLong_Check(value) ? PyLong_AsSsize_t(value) : -1;
+                if (!PyType_Check(key) || index < 0 || index >= PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 0))) {
+                    PyErr_Clear();
+                    PyErr_Format(PyExc_ValueError, "invalid dispatch entry %R: %R", key, value);
+                    res = -1;
+                    break;
+                }
+            }
+            n->slots += (Py_ssize_t)dispatch_table_size(PyDict_GET_SIZE(table));
+            break;
+        }
+        case OP_TAGGED_UNION: {
+            if (!PyTuple_Check(arg) || PyTuple_GET_SIZE(arg) != 4 || !PyUnicode_Check(PyTuple_GET_ITEM(arg, 0))
+                    || !PyDict_Check(PyTuple_GET_ITEM(arg, 1))) {
+                PyErr_Format(PyExc_TypeError, "OP_TAGGED_UNION expects (tag, {value: index}, branches, is_mapping), got %R", arg);
+                res = -1;
+                break;
+            }
+            PyObject *branches = PyTuple_GET_ITEM(arg, 2);
+            res = rule_measure_branches(branches, n);
+            if (res < 0) break;
+            PyObject *key, *value;
+            Py_ssize_t pos = 0;
+            while (PyDict_Next(PyTuple_GET_ITEM(arg, 1), &pos, &key, &value)) {
+                Py_ssize_t index = PyLong_Check(value) ? PyLong_AsSsize_t(value) : -1;
+                if (index < 0 || index >= PyTuple_GET_SIZE(branches)) {
+                    PyErr_Clear();
+                    PyErr_Format(PyExc_ValueError, "invalid tag entry %R: %R", key, value);
+                    res = -1;
+                    break;
+                }
+            }
+            break;
+        }
+        case OP_LITERAL:
+            if (!PyTuple_Check(arg)) {
+                PyErr_Format(PyExc_TypeError, "OP_LITERAL expects a tuple of values, got %R", arg);
+                res = -1;
+                break;
+            }
+            n->literals += (Py_ssize_t)dispatch_table_size(PyTuple_GET_SIZE(arg));
+            break;
+        case OP_BUFFER: {
+            n->buffers += 1;
+            int valid = PyTuple_Check(arg) && PyTuple_GET_SIZE(arg) == 6;
+            if (valid) {
+                PyObject *tp = PyTuple_GET_ITEM(arg, 0), *formats = PyTuple_GET_ITEM(arg, 1);
+                valid = (tp == Py_None || PyType_Check(tp)) && (formats == Py_None || PyTuple_Check(formats))
+                        && PyLong_Check(PyTuple_GET_ITEM(arg, 2)) && PyLong_Check(PyTuple_GET_ITEM(arg, 3));
+                for (Py_ssize_t i = 0; valid && formats != Py_None && i < PyTuple_GET_SIZE(formats); i++) {
+                    valid = PyUnicode_Check(PyTuple_GET_ITEM(formats, i));
+                }
+                for (int i = 4; valid && i < 6; i++) {
+                    PyObject *bound = PyTuple_GET_ITEM(arg, i);
+                    valid = bound == Py_None || (PyLong_Check(bound) && !PyBool_Check(bound))
+                            || (PyFloat_Check(bound) && !isnan(PyFloat_AS_DOUBLE(bound)));
+                }
+            }
+            if (!valid) {
+                PyErr_Format(PyExc_TypeError, "OP_BUFFER expects (type, formats, itemsize, ndim, ge, le), got %R", arg);
+                res = -1;
+            }
+            break;
+        }
+        case OP_TYPED_DICT: {
+            // (keys, required flags, rules)
+            int valid = PyTuple_Check(arg) && PyTuple_GET_SIZE(arg) == 3;
+            for (int i = 0; valid && i < 3; i++) valid = PyTuple_Check(PyTuple_GET_ITEM(arg, i));
+            valid = valid && PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 0)) == PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 2))
+                    && PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 1)) == PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 2));
+            if (!valid) {
+                PyErr_Format(PyExc_TypeError, "OP_TYPED_DICT expects (keys, required, rules), got %R", arg);
+                res = -1;
+                break;
+            }
+            res = rule_measure_branches(PyTuple_GET_ITEM(arg, 2), n);
+            break;
+        }
+        case OP_NAMED_TUPLE:
+        case OP_DATACLASS:
+        case OP_PROTOCOL: {
+            // (cls, rules), (cls, names, rules) and (cls, names)
+            Py_ssize_t size = op == OP_DATACLASS ? 3 : 2;
+            int valid = PyTuple_Check(arg) && PyTuple_GET_SIZE(arg) == size && PyType_Check(PyTuple_GET_ITEM(arg, 0));
+            for (Py_ssize_t i = 1; valid && i < size; i++) valid = PyTuple_Check(PyTuple_GET_ITEM(arg, i));
+            for (Py_ssize_t i = 0; valid && op != OP_NAMED_TUPLE && i < PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 1)); i++) {
+                valid = PyUnicode_Check(PyTuple_GET_ITEM(PyTuple_GET_ITEM(arg, 1), i));
+            }
+            if (valid && op == OP_DATACLASS) {
+                valid = PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 1)) == PyTuple_GET_SIZE(PyTuple_GET_ITEM(arg, 2));
+            }
+            if (!valid) {
+                PyErr_Format(PyExc_TypeError, "%s expects %s, got %R",
+                             op == OP_NAMED_TUPLE ? "OP_NAMED_TUPLE" : op == OP_DATACLASS ? "OP_DATACLASS" : "OP_PROTOCOL",
+                             op == OP_NAMED_TUPLE ? "(cls, rules)" : op == OP_DATACLASS ? "(cls, names, rules)" : "(cls, names)",
+                             arg);
+                res = -1;
+                break;
+            }
+            if (op == OP_PROTOCOL) {
+                n->caches += 1;
+                break;
+            }
+            PyObject *rules = PyTuple_GET_ITEM(arg, size - 1);
+            if (op == OP_DATACLASS) n->kids += PyTuple_GET_SIZE(rules);  // field offsets
+            res = rule_measure_branches(rules, n);
+            break;
+        }
+        case OP_REF:
+            // (key, rule) declares key and lowers to the rule itself; any other arg is a
+            // back-reference to the innermost declaration of that key
+            if (PyTuple_Check(arg) && PyTuple_GET_SIZE(arg) == 2) {
+                n->nodes--;
+                res = rule_measure(PyTuple_GET_ITEM(arg, 1), n);
+            } else {
+                n->kids += 1;
+            }
+            break;
+        default:
+            PyErr_Format(PyExc_ValueError, "Unknown guardian rule opcode %ld", op);
+            res = -1;
+    }
+    Py_LeaveRecursiveCall();
+    return res;
+}
+
+static int rule_measure_branches(PyObject *branches, RuleSizes *n) {
+    if (!PyTuple_Check(branches)) {
+        PyErr_Format(PyExc_TypeError, "expected a tuple of rules, got %R", branches);
+        return -1;
+    }
+    n->kids += PyTuple_GET_SIZE(branches);
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(branches); i++) {
+        if (rule_measure(PyTuple_GET_ITEM(branches, i), n) < 0) return -1;
+    }
+    return 0;
+}
+
+// Pass 2: emit nodes in pre-order. A node reserves its kid slots before its
+// children are emitted, so every subtree ends up contiguous after its parent.
+// Decides how far an OP_INSTANCE verdict may be cached for this target class.
+static void instance_cache_policy(RuleNode *node) {
+    if (node->type == NULL) return;  // isinstance against a tuple or other non-type
+    PyTypeObject *meta = Py_TYPE(node->type);
+    if (meta == &PyType_Type) {
+        // Plain classes: isinstance() is a pure MRO walk of type(obj).
+        node->flags |= NODE_CACHE_NEGATIVE | NODE_TYPE_DETERMINED;
+    } else if ((PyObject *)meta == AbcMetaType) {
+        // ABCs: register() can turn a miss into a hit later, so cache hits only.
+        node->flags |= NODE_TYPE_DETERMINED;
+    } else {
+        // Custom __instancecheck__ (runtime protocols etc.) may inspect the instance.
+        node->cache = NULL;
+    }
+}
+
+typedef struct {
+    Py_ssize_t node;
+    Py_ssize_t kid;
+    Py_ssize_t cache;
+    Py_ssize_t slot;
+    Py_ssize_t buffer;
+    Py_ssize_t literal;
+    PyObject *refs;         // {declared key: node index} while its rule is being emitted
+} EmitCursor;
+
+static Py_ssize_t rule_emit(RuleObject *r, PyObject *rule, EmitCursor *at);
+
+// Fills an OP_LITERAL node's identity table and its {value: (equal allowed values, ...)}
+// dict. Strings are swapped for their interned copies, which the dict keeps alive.
+// Errors (unhashable values, memory) are left set and checked after emit.
+static void literal_table_init(RuleObject *r, RuleNode *node, PyObject *values, EmitCursor *at) {
+    size_t size = dispatch_table_size(PyTuple_GET_SIZE(values));
+    node->literals = &r->literals[at->literal];
+    node->dispatch_mask = size - 1;
+    at->literal += (Py_ssize_t)size;
+    if (PyErr_Occurred()) return;
+
+    PyObject *table = PyDict_New();
+    if (table == NULL) return;
+    if ((r->tables == NULL && (r->tables = PyList_New(0)) == NULL) || PyList_Append(r->tables, table) < 0) {
+        Py_DECREF(table);
+        return;
+    }
+    Py_DECREF(table);  // owned by r->tables
+    node->table = table;
+
+    for (Py_ssize_t k = 0; k < PyTuple_GET_SIZE(values); k++) {
+        PyObject *value = Py_NewRef(PyTuple_GET_ITEM(values, k));
+        if (PyUnicode_CheckExact(value)) PyUnicode_InternInPlace(&value);
+        // Values equal to an earlier one (1 and True) share its entry
+        PyObject *equal = PyDict_GetItemWithError(table, value);
+        PyObject *key = equal != NULL ? PyTuple_GET_ITEM(equal, 0) : value;
+        PyObject *candidates = equal == NULL && PyErr_Occurred() ? NULL : PyTuple_Pack(1, value);
+        if (candidates != NULL && equal != NULL) Py_SETREF(candidates, PySequence_Concat(equal, candidates));
+        int res = candidates == NULL ? -1 : PyDict_SetItem(table, key, candidates);
+        Py_XDECREF(candidates);
+        if (res == 0) {
+            size_t i = pointer_hash(value) & node->dispatch_mask;
+            while (node->literals[i] != NULL && node->literals[i] != value) i = (i + 1) & node->dispatch_mask;
+            node->literals[i] = value;  // kept alive by the dict or the rule's source
+        }
+        Py_DECREF(value);
+        if (res < 0) {
+            if (PyErr_ExceptionMatches(PyExc_TypeError)) {
+                PyErr_Format(PyExc_TypeError, "Literal values must be hashable, got %R", PyTuple_GET_ITEM(values, k));
+            }
+            return;
+        }
+    }
+}
+
+static void rule_emit_branches(RuleObject *r, RuleNode *node, PyObject *branches, EmitCursor *at) {
+    node->n_kids = PyTuple_GET_SIZE(branches);
+    node->kids = at->kid;
+    at->kid += node->n_kids;
+    for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+        r->kids[node->kids + i] = rule_emit(r, PyTuple_GET_ITEM(branches, i), at);
+    }
+}
+
+// (OP_REF, (key, rule)): binds key to the node the rule is about to be emitted at, so
+// the back-references inside the rule become edges to that node.
+static Py_ssize_t rule_emit_declaration(RuleObject *r, PyObject *decl, EmitCursor *at) {
+    PyObject *key = PyTuple_GET_ITEM(decl, 0);
+    PyObject *outer = NULL;  // a shadowed declaration of the same key
+    int bound = 0;
+    if (!PyErr_Occurred() && (at->refs != NULL || (at->refs = PyDict_New()) != NULL)) {
+        PyObject *index = PyLong_FromSsize_t(at->node);
+        outer = Py_XNewRef(PyDict_GetItemWithError(at->refs, key));
+        bound = index != NULL && !PyErr_Occurred() && PyDict_SetItem(at->refs, key, index) == 0;
+        Py_XDECREF(index);
+    }
+    Py_ssize_t idx = rule_emit(r, PyTuple_GET_ITEM(decl, 1), at);
+    if (bound && !PyErr_Occurred()) {
+        if (outer != NULL) PyDict_SetItem(at->refs, key, outer);
+        else PyDict_DelItem(at->refs, key);
+    }
+    Py_XDECREF(outer);
+    return idx;
+}
+
+static Py_ssize_t rule_emit(RuleObject *r, PyObject *rule, EmitCursor *at) {
+    PyObject *arg = PyTuple_GET_ITEM(rule, 1);
+    int op = (int)PyLong_AsLong(PyTuple_GET_ITEM(rule, 0));
+    if (op == OP_REF && PyTuple_Check(arg)) return rule_emit_declaration(r, arg, at);
+
+    Py_ssize_t idx = at->node++;
+    RuleNode *node = &r->nodes[idx];
+    node->op = op;
+    node->n_kids = 0;
+    node->kids = at->kid;
+    node->arg = arg;
+    node->type = PyType_Check(arg) ? (PyTypeObject *)arg : NULL;
+
+    switch (node->op) {
+        case OP_ANY:
+        case OP_EXACT:
+            node->flags |= NODE_TYPE_DETERMINED;
+            break;
+        case OP_INSTANCE:
+            node->cache = &r->caches[at->cache++];
+            instance_cache_policy(node);
+            break;
+        case OP_LIST:
+        case OP_SET:
+        case OP_TUPLE_VAR:
+            if (arg == Py_None) break;
+            node->n_kids = 1;
+            at->kid += 1;
+            r->kids[node->kids] = rule_emit(r, arg, at);
+            if (node->op != OP_SET) {
+                const RuleNode *item = &r->nodes[r->kids[node->kids]];
+                if ((item->op == OP_EXACT || item->op == OP_INSTANCE) && item->type != NULL) node->flags |= NODE_HOMOGENEOUS;
+            }
+            break;
+        case OP_DICT:
+            if (arg == Py_None) break;
+            node->n_kids = 2;
+            at->kid += 2;
+            r->kids[node->kids] = rule_emit(r, PyTuple_GET_ITEM(arg, 0), at);
+            r->kids[node->kids + 1] = rule_emit(r, PyTuple_GET_ITEM(arg, 1), at);
+            break;
+        case OP_UNION:
+            node->cache = &r->caches[at->cache++];
+            rule_emit_branches(r, node, arg, at);
+            break;
+        case OP_TUPLE_FIXED:
+            rule_emit_branches(r, node, arg, at);
+            break;
+        case OP_UNION_DISPATCH: {
+            PyObject *table = PyTuple_GET_ITEM(arg, 1);
+            rule_emit_branches(r, node, PyTuple_GET_ITEM(arg, 0), at);
+            size_t size = dispatch_table_size(PyDict_GET_SIZE(table));
+            node->dispatch = &r->slots[at->slot];
+            node->dispatch_mask = size - 1;
+            at->slot += (Py_ssize_t)size;
+
+            PyObject *key, *value;
+            Py_ssize_t pos = 0;
+            while (PyDict_Next(table, &pos, &key, &value)) {
+                size_t i = dispatch_hash((PyTypeObject *)key) & node->dispatch_mask;
+                while (node->dispatch[i].type != NULL) i = (i + 1) & node->dispatch_mask;
+                node->dispatch[i].type = (PyTypeObject *)key;
+                node->dispatch[i].kid = r->kids[node->kids + PyLong_AsSsize_t(value)];
+            }
+            break;
+        }
+        case OP_TAGGED_UNION:
+            node->arg = PyTuple_GET_ITEM(arg, 0);
+            node->table = PyTuple_GET_ITEM(arg, 1);
+            if (PyObject_IsTrue(PyTuple_GET_ITEM(arg, 3))) node->flags |= NODE_TAG_MAPPING;
+            rule_emit_branches(r, node, PyTuple_GET_ITEM(arg, 2), at);
+            break;
+        case OP_BUFFER: {
+            PyObject *tp = PyTuple_GET_ITEM(arg, 0);
+            node->type = tp == Py_None ? NULL : (PyTypeObject *)tp;
+            node->buffer = &r->buffers[at->buffer++];
+            buffer_spec_init(node->buffer, arg);  // can only fail on memory; checked after emit
+            break;
+        }
+        case OP_LITERAL:
+            literal_table_init(r, node, arg, at);
+            break;
+        case OP_TYPED_DICT:
+            node->arg = PyTuple_GET_ITEM(arg, 0);
+            node->table = PyTuple_GET_ITEM(arg, 1);
+            rule_emit_branches(r, node, PyTuple_GET_ITEM(arg, 2), at);
+            break;
+        case OP_NAMED_TUPLE:
+            node->type = (PyTypeObject *)PyTuple_GET_ITEM(arg, 0);
+            rule_emit_branches(r, node, PyTuple_GET_ITEM(arg, 1), at);
+            break;
+        case OP_DATACLASS:
+            node->type = (PyTypeObject *)PyTuple_GET_ITEM(arg, 0);
+            node->arg = PyTuple_GET_ITEM(arg, 1);
+            node->n_kids = PyTuple_GET_SIZE(node->arg);
+            at->kid += 2 * node->n_kids;  // kids, then field offsets, ahead of the children's own kids
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                RULE_FIELD_OFFSET(r, node, i) = member_slot_offset(_PyType_Lookup(node->type, PyTuple_GET_ITEM(node->arg, i)));
+                r->kids[node->kids + i] = rule_emit(r, PyTuple_GET_ITEM(PyTuple_GET_ITEM(arg, 2), i), at);
+            }
+            break;
+        case OP_PROTOCOL:
+            node->type = (PyTypeObject *)PyTuple_GET_ITEM(arg, 0);
+            node->arg = PyTuple_GET_ITEM(arg, 1);
+            node->cache = &r->caches[at->cache++];
+            break;
+        case OP_REF: {
+            PyObject *index = PyErr_Occurred() || at->refs == NULL ? NULL : PyDict_GetItemWithError(at->refs, arg);
+            Py_ssize_t target = index != NULL ? PyLong_AsSsize_t(index) : -1;
+            if (target < 0 && !PyErr_Occurred()) {
+                PyErr_Format(PyExc_ValueError, "OP_REF %R is not inside a declaration of it", arg);
+            } else if (target == idx) {
+                PyErr_Format(PyExc_ValueError, "recursive rule %R refers only to itself", arg);
+            }
+            node->n_kids = 1;
+            at->kid += 1;
+            r->kids[node->kids] = target < 0 ? 0 : target;
+            node->flags |= NODE_RECURSIVE;
+            return idx;
+        }
+    }
+    // A back-reference anywhere below makes the depth of this node's check data-dependent
+    for (Py_ssize_t i = 0; i < node->n_kids && !(node->flags & NODE_RECURSIVE); i++) {
+        node->flags |= RULE_KID(r, node, i)->flags & NODE_RECURSIVE;
+    }
+    return idx;
+}
+
+static PyObject *lower_rule_object(PyObject *source) {
+    RuleSizes n = {0, 0, 0, 0, 0, 0};
+    if (rule_measure(source, &n) < 0) return NULL;
+
+    RuleObject *r = PyObject_GC_New(RuleObject, RuleType);
+    if (r == NULL) return NULL;
+    // Nodes, caches, dispatch slots and the kid table share one zeroed allocation,
+    // ordered by decreasing alignment.
+    r->tables = NULL;
+    r->nodes = PyMem_Calloc(1, n.nodes * sizeof(RuleNode) + n.caches * sizeof(InlineCache)
+                               + n.slots * sizeof(DispatchSlot) + n.buffers * sizeof(BufferSpec)
+                               + n.literals * sizeof(PyObject *) + n.kids * sizeof(Py_ssize_t));
+    if (r->nodes == NULL) {
+        r->source = NULL;
+        Py_DECREF(r);
+        return PyErr_NoMemory();
+    }
+    r->caches = (InlineCache *)(r->nodes + n.nodes);
+    r->slots = (DispatchSlot *)(r->caches + n.caches);
+    r->buffers = (BufferSpec *)(r->slots + n.slots);
+    r->literals = (PyObject **)(r->buffers + n.buffers);
+    r->kids = (Py_ssize_t *)(r->literals + n.literals);
+    r->n_nodes = n.nodes;
+    Py_INCREF(source);
+    r->source = source;
+
+    EmitCursor at = {0, 0, 0, 0, 0, 0, NULL};
+    rule_emit(r, source, &at);
+    Py_XDECREF(at.refs);
+    if (PyErr_Occurred()) {
+        Py_DECREF(r);
+        return NULL;
+    }
+
+    PyObject_GC_Track(r);
+    return (PyObject *)r;
+}
+
+// Accepts a lowered Rule, None, or a raw (op, arg) tuple; returns a new reference
+// to the Rule (or None) that the C objects should store.
+static PyObject *as_rule(PyObject *rule) {
+    if (rule == Py_None || Rule_Check(rule)) {
+        Py_INCREF(rule);
+        return rule;
+    }
+    return lower_rule_object(rule);
+}
+
+// Rebuilds a (name, expected, rule) definition so its rule is a lowered Rule.
+static PyObject *as_rule_def(PyObject *rule_def, Py_ssize_t rule_pos) {
+    if (rule_def == Py_None) {
+        Py_INCREF(rule_def);
+        return rule_def;
+    }
+    if (!PyTuple_Check(rule_def) || PyTuple_GET_SIZE(rule_def) <= rule_pos) {
+        PyErr_Format(PyExc_TypeError, "malformed guardian rule definition %R", rule_def);
+        return NULL;
+    }
+    PyObject *rule = PyTuple_GET_ITEM(rule_def, rule_pos);
+    if (rule == Py_None || Rule_Check(rule)) {
+        Py_INCREF(rule_def);
+        return rule_def;
+    }
+    PyObject *lowered = lower_rule_object(rule);
+    if (lowered == NULL) return NULL;
+    PyObject *res = PyTuple_New(PyTuple_GET_SIZE(rule_def));
+    if (res == NULL) {
+        Py_DECREF(lowered);
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(rule_def); i++) {
+        PyObject *item = (i == rule_pos) ? lowered : PyTuple_GET_ITEM(rule_def, i);
+        if (i != rule_pos) Py_INCREF(item);
+        PyTuple_SET_ITEM(res, i, item);
+    }
+    return res;
+}
+
+// Checks against a rule that may still be a raw tuple (e.g. a hand-edited
+// __shield_rules__ entry), lowering it on the fly.
+static int check_any_rule(PyObject *obj, PyObject *rule) {
+    if (likely(rule == Py_None || Rule_Check(rule))) return fast_check_type(obj, rule);
+    PyObject *lowered = lower_rule_object(rule);
+    if (lowered == NULL) return -1;
+    int res = fast_check_type(obj, lowered);
+    Py_DECREF(lowered);
+    return res;
+}
+
+static void Rule_dealloc(RuleObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    Py_XDECREF(self->source);
+    Py_XDECREF(self->tables);
+    PyMem_Free(self->nodes);
+    PyObject_GC_Del(self);
+    Py_DECREF(tp);
+}
+
+static int Rule_traverse(RuleObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->source);
+    Py_VISIT(self->tables);
+    return 0;
+}
+
+static PyObject *Rule_repr(RuleObject *self) {
+    return PyUnicode_FromFormat("Rule(%R)", self->source);
+}
+
+static PyObject *Rule_check(RuleObject *self, PyObject *obj) {
+    int res = check_node(self, self->nodes, obj);
+    if (res < 0) return NULL;
+    return PyBool_FromLong(res);
+}
+
+static PyMethodDef Rule_methods[] = {
+    {"check", (PyCFunction)Rule_check, METH_O, "Return True if the object satisfies this rule"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMemberDef Rule_members[] = {
+    {"source", T_OBJECT, offsetof(RuleObject, source), READONLY, "The (op, arg) tuple this program was lowered from"},
+    {"node_count", T_PYSSIZET, offsetof(RuleObject, n_nodes), READONLY, "Number of instructions in the program"},
+    {NULL}
+};
+
+static PyType_Slot Rule_slots[] = {
+    {Py_tp_dealloc, Rule_dealloc},
+    {Py_tp_traverse, Rule_traverse},
+    {Py_tp_repr, Rule_repr},
+    {Py_tp_methods, Rule_methods},
+    {Py_tp_members, Rule_members},
+    {0, NULL}
+};
+
+static PyType_Spec Rule_spec = {
+    .name = "guardian._guardian_core.Rule",
+    .basicsize = sizeof(RuleObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = Rule_slots,
+};
+
+static PyObject* lower_rule(PyObject *module, PyObject *rule) {
+    return as_rule(rule);
+}
+
+// --- STRUCTURED TYPE ERRORS ---
+// A rejection only records what failed: the rule, the rejected value and who was
+// checking it. Nothing is rendered at raise time, so a hostile multi-megabyte payload
+// costs one allocation to reject. `.path` / `.value` re-walk the rule on first access
+// to find the innermost failing element, and str() renders a reprlib-bounded message.
+
+typedef struct {
+    PyBaseExceptionObject base;
+    PyObject *subject;    // message head, e.g. "Variable 'x'"; NULL for plain-message errors
+    PyObject *name;       // parameter / field name, or None
+    PyObject *expected;   // display name of the expected type (or the hint, until formatted)
+    PyObject *rule;       // compiled rule the value failed
+    PyObject *root;       // the rejected value
+    PyObject *path;       // tuple of keys / indices from root to value; NULL until resolved
+    PyObject *prefix;     // tuple of fields from an ingested document down to root (from_dict), or NULL
+    PyObject *attr_steps; // bytes flagging the path entries that are attribute names, or NULL
+    PyObject *value;      // innermost offending object; NULL until resolved
+    PyObject *message;    // rendered on first str()
+} GuardianTypeErrorObject;
+
+static PyTypeObject *GuardianTypeErrorType;
+static PyObject *ReprlibRepr;       // reprlib.repr, imported on first render
+static PyObject *CompileProgram;    // guardian._compiler.compile_program, imported on first use
+static PyObject *FormatTypeName;    // guardian._compiler.format_type_name
+
+static int load_compiler(void) {
+    if (FT_LOAD_PTR(FormatTypeName) != NULL) return 0;
+    PyObject *compiler = PyImport_ImportModule("guardian._compiler");
+    if (compiler == NULL) return -1;
+    PyObject *compile = PyObject_GetAttrString(compiler, "compile_program");
+    PyObject *format = compile ? PyObject_GetAttrString(compiler, "format_type_name") : NULL;
+    Py_DECREF(compiler);
+    if (format == NULL) {
+        Py_XDECREF(compile);
+        return -1;
+    }
+    publish_once(&CompileProgram, compile);
+    publish_once(&FormatTypeName, format);  // last: its presence is what callers test
+    return 0;
+}
+
+// Signatures and field tables keep the hint itself where a message needs the expected
+// type's name; it is formatted only when a failure is reported. Strings pass through.
+static PyObject *expected_display(PyObject *expected) {
+    if (PyUnicode_Check(expected)) return Py_NewRef(expected);
+    if (load_compiler() < 0) return NULL;
+    return PyObject_CallOneArg(FormatTypeName, expected);
+}
+
+// True if obj has the container shape node checks, so a failure must lie inside it.
+static int node_shape_matches(const RuleObject *r, const RuleNode *node, PyObject *obj) {
+    switch (node->op) {
+        case OP_REF: return node_shape_matches(r, RULE_KID(r, node, 0), obj);
+        case OP_LIST: return PyList_Check(obj);
+        case OP_DICT: return PyDict_Check(obj);
+        case OP_SET: return PyAnySet_Check(obj);
+        case OP_TUPLE_VAR: return PyTuple_Check(obj);
+        case OP_TUPLE_FIXED: return PyTuple_Check(obj) && PyTuple_GET_SIZE(obj) == node->n_kids;
+        case OP_TYPED_DICT: return PyDict_Check(obj);
+        case OP_NAMED_TUPLE: return PyObject_TypeCheck(obj, node->type) && PyTuple_GET_SIZE(obj) == node->n_kids;
+        case OP_DATACLASS: return PyObject_TypeCheck(obj, node->type);
+    }
+    return 0;
+}
+
+// One step of the failure search: if obj fails node because of a part of it, sets
+// *next to the rule that part fails, *child to the part and *segment to its key or
+// index (NULL when the part has no address, e.g. a dict key or set member).
+// Leaves *next NULL when obj itself is the innermost failure. Returns 1 when the
+// segment is an attribute name rather than a key.
+// check_node for the failure search. trail holds the nodes and objects the search has
+// passed through, so data that loops back to one of them passes as it did in the check.
+static int locate_check(const RuleObject *r, const RuleNode *node, PyObject *obj, const DeepVisit *trail, Py_ssize_t n_trail) {
+    if (node->flags & NODE_RECURSIVE) return check_deep(r, node, obj, trail, n_trail);
+    return check_node(r, node, obj);
+}
+
+static int locate_step(const RuleObject *r, const RuleNode *node, PyObject *obj, const DeepVisit *trail, Py_ssize_t n_trail,
+                       const RuleNode **next, PyObject **child, PyObject **segment) {
+    switch (node->op) {
+        case OP_LIST:
+        case OP_TUPLE_VAR:
+        case OP_TUPLE_FIXED:
+        case OP_NAMED_TUPLE: {
+            if (!node_shape_matches(r, node, obj) || node->n_kids == 0) return 0;
+            int positional = node->op == OP_TUPLE_FIXED || node->op == OP_NAMED_TUPLE;
+            PyObject *item;
+            for (Py_ssize_t i = 0; (item = sequence_item_ref(obj, i)) != NULL; i++) {
+                const RuleNode *item_rule = RULE_KID(r, node, positional ? i : 0);
+                int res = locate_check(r, item_rule, item, trail, n_trail);
+                if (res == 0) {
+                    *segment = PyLong_FromSsize_t(i);
+                    *next = item_rule;
+                    *child = item;
+                    return *segment == NULL ? -1 : 0;
+                }
+                Py_DECREF(item);
+                if (res < 0) return -1;
+            }
+            return 0;
+        }
+        case OP_DICT: {
+            if (!PyDict_Check(obj) || node->n_kids == 0) return 0;
+            PyObject *key, *value;
+            Py_ssize_t pos = 0;
+            while (dict_next_ref(obj, &pos, &key, &value)) {
+                int res = locate_check(r, RULE_KID(r, node, 0), key, trail, n_trail);
+                if (res == 0) {
+                    *next = RULE_KID(r, node, 0);
+                    *child = key;
+                    Py_DECREF(value);
+                    return 0;
+                }
+                if (res > 0) res = locate_check(r, RULE_KID(r, node, 1), value, trail, n_trail);
+                if (res == 0) {
+                    *next = RULE_KID(r, node, 1);
+                    *child = value;
+                    *segment = key;
+                    return 0;
+                }
+                Py_DECREF(key);
+                Py_DECREF(value);
+                if (res < 0) return -1;
+            }
+            return 0;
+        }
+        case OP_SET: {
+            if (!PyAnySet_Check(obj) || node->n_kids == 0) return 0;
+            PyObject *iter = PyObject_GetIter(obj);
+            if (iter == NULL) return -1;
+            PyObject *item;
+            while ((item = PyIter_Next(iter))) {
+                int res = locate_check(r, RULE_KID(r, node, 0), item, trail, n_trail);
+                if (res == 0) {
+                    *next = RULE_KID(r, node, 0);
+                    *child = item;
+                    break;
+                }
+                Py_DECREF(item);
+                if (res < 0) break;
+            }
+            Py_DECREF(iter);
+            return PyErr_Occurred() ? -1 : 0;
+        }
+        case OP_UNION:
+        case OP_UNION_DISPATCH: {
+            // Descend only when a single branch has obj's container shape (e.g. the
+            // list[int] side of `list[int] | None`); otherwise obj is the failure.
+            const RuleNode *match = NULL;
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                const RuleNode *branch = RULE_KID(r, node, i);
+                if (!node_shape_matches(r, branch, obj)) continue;
+                if (match != NULL) return 0;
+                match = branch;
+            }
+            if (match != NULL) {
+                *next = match;
+                *child = Py_NewRef(obj);
+            }
+            return 0;
+        }
+        case OP_TAGGED_UNION: {
+            Py_ssize_t index;
+            int res = tagged_union_branch(node, obj, &index);
+            if (res > 0) {
+                *next = RULE_KID(r, node, index);
+                *child = Py_NewRef(obj);
+            }
+            return res < 0 ? -1 : 0;
+        }
+        case OP_REF:
+            *next = RULE_KID(r, node, 0);
+            *child = Py_NewRef(obj);
+            return 0;
+        case OP_TYPED_DICT:
+        case OP_DATACLASS: {
+            // A missing key or attribute leaves obj itself as the failure
+            if (!node_shape_matches(r, node, obj)) return 0;
+            int attr = node->op == OP_DATACLASS;
+            for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+                PyObject *name = PyTuple_GET_ITEM(node->arg, i), *value;
+                int found;
+                if (attr) {
+                    found = lookup_attr(obj, name, &value);
+                } else {
+                    found = PyDict_GetItemRef(obj, name, &value);
+                    if (found == 0 && PyTuple_GET_ITEM(node->table, i) != Py_True) continue;
+                }
+                if (found <= 0) return found;
+                int res = locate_check(r, RULE_KID(r, node, i), value, trail, n_trail);
+                if (res == 0) {
+                    *next = RULE_KID(r, node, i);
+                    *child = value;
+                    *segment = Py_NewRef(name);
+                    return attr;
+                }
+                Py_DECREF(value);
+                if (res < 0) return -1;
+            }
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// Fills in path / value by walking from the root down to the innermost failure.
+static int type_error_resolve(GuardianTypeErrorObject *self) {
+    if (self->path != NULL) return 0;
+    PyObject *segments = PyList_New(0);
+    if (segments == NULL) return -1;
+    PyObject *obj = Py_NewRef(self->root != NULL ? self->root : Py_None);
+    char *attrs = NULL;  // attrs[i]: path[i] is an attribute name
+    int any_attr = 0;
+    if (self->rule != NULL && Rule_Check(self->rule)) {
+        const RuleObject *r = (const RuleObject *)self->rule;
+        const RuleNode *node = r->nodes;
+        // Acyclic rules descend a node per step; recursive ones may take up to MaxDepth
+        // expansions, and the trail holds a strong reference to every object passed.
+        Py_ssize_t capacity = r->n_nodes, n_trail = 0, expansions = 0, limit = FT_LOAD_SSIZE(MaxDepth);
+        DeepVisit *trail = PyMem_Malloc(capacity * sizeof(DeepVisit));
+        attrs = PyMem_Malloc(capacity);
+        int res = trail != NULL && attrs != NULL ? 0 : -1;
+        if (res < 0) PyErr_NoMemory();
+        while (res >= 0 && node != NULL && (node->op != OP_REF || ++expansions <= limit)) {
+            if (n_trail == capacity) {
+                DeepVisit *more_trail = PyMem_Realloc(trail, 2 * capacity * sizeof(DeepVisit));
+                if (more_trail != NULL) trail = more_trail;
+                char *more_attrs = more_trail != NULL ? PyMem_Realloc(attrs, 2 * capacity) : NULL;
+                if (more_attrs == NULL) {
+                    PyErr_NoMemory();
+                    res = -1;
+                    break;
+                }
+                attrs = more_attrs;
+                capacity *= 2;
+            }
+            trail[n_trail].node = node;
+            trail[n_trail++].obj = Py_NewRef(obj);
+            const RuleNode *next = NULL;
+            PyObject *child = NULL, *segment = NULL;
+            res = locate_step(r, node, obj, trail, n_trail, &next, &child, &segment);
+            if (res >= 0 && segment != NULL) {
+                attrs[PyList_GET_SIZE(segments)] = (char)res;
+                any_attr |= res;
+                res = PyList_Append(segments, segment);
+            }
+            Py_XDECREF(segment);
+            if (res < 0) {
+                Py_XDECREF(child);
+                break;
+            }
+            if (next != NULL) Py_SETREF(obj, child);
+            node = next;
+        }
+        for (Py_ssize_t i = 0; i < n_trail; i++) Py_DECREF(trail[i].obj);
+        PyMem_Free(trail);
+        if (res < 0) {
+            Py_DECREF(obj);
+            Py_DECREF(segments);
+            PyMem_Free(attrs);
+            return -1;
+        }
+    }
+    if (any_attr) self->attr_steps = PyBytes_FromStringAndSize(attrs, PyList_GET_SIZE(segments));
+    PyMem_Free(attrs);
+    self->path = any_attr && self->attr_steps == NULL ? NULL : PyList_AsTuple(segments);
+    Py_DECREF(segments);
+    if (self->path == NULL) {
+        Py_CLEAR(self->attr_steps);
+        Py_DECREF(obj);
+        return -1;
+    }
+    self->value = obj;
+    return 0;
+}
+
+// A structured GuardianTypeError, not yet raised: `subject` expected `expected_name`.
+static PyObject *new_rule_error(PyObject *subject, PyObject *name, PyObject *expected_name, PyObject *rule, PyObject *val) {
+    GuardianTypeErrorObject *exc = (GuardianTypeErrorObject *)PyObject_CallNoArgs(GuardianTypeError);
+    if (exc == NULL) return NULL;
+    exc->subject = Py_NewRef(subject);
+    exc->name = Py_NewRef(name);
+    exc->expected = Py_NewRef(expected_name);
+    exc->rule = Py_NewRef(rule);
+    exc->root = Py_NewRef(val);
+    return (PyObject *)exc;
+}
+
+// Raises a structured GuardianTypeError: `subject` expected `expected_name`.
+static void raise_rule_error(PyObject *subject, PyObject *name, PyObject *expected_name, PyObject *rule, PyObject *val) {
+    PyObject *exc = new_rule_error(subject, name, expected_name, rule, val);
+    if (exc == NULL) return;
+    PyErr_SetObject(GuardianTypeError, exc);
+    Py_DECREF(exc);
+}
+
+static void raise_type_error(PyObject *param_name, PyObject *expected_name, PyObject *rule, PyObject *val) {
+    PyObject *subject = PyUnicode_FromFormat("Variable '%U'", param_name);
+    if (subject == NULL) return;
+    raise_rule_error(subject, param_name, expected_name, rule, val);
+    Py_DECREF(subject);
+}
+
+// "lines[1].sku" for field segments, outermost first: names are dotted, indices bracketed.
+static PyObject *field_location(PyObject *segments) {
+    PyObject *location = PyUnicode_FromString("");
+    for (Py_ssize_t i = 0; location != NULL && i < PySequence_Fast_GET_SIZE(segments); i++) {
+        PyObject *seg = PySequence_Fast_GET_ITEM(segments, i);
+        if (PyUnicode_Check(seg)) {
+            Py_SETREF(location, PyUnicode_FromFormat(i == 0 ? "%U%U" : "%U.%U", location, seg));
+        } else if (PyLong_Check(seg)) {
+            Py_SETREF(location, PyUnicode_FromFormat("%U[%S]", location, seg));
+        } else {
+            Py_SETREF(location, PyUnicode_FromFormat("%U[%R]", location, seg));
+        }
+    }
+    return location;
+}
+
+// "name['sensor_A'][2]", or "order.customer['id']" through attributes; an ingest
+// prefix replaces the name, e.g. "lines[1].tags[0]".
+static PyObject *type_error_location(GuardianTypeErrorObject *self) {
+    PyObject *location = self->prefix != NULL ? field_location(self->prefix)
+                       : self->name != Py_None ? PyObject_Str(self->name) : PyUnicode_FromString("value");
+    const char *attrs = self->attr_steps != NULL ? PyBytes_AS_STRING(self->attr_steps) : NULL;
+    for (Py_ssize_t i = 0; location != NULL && i < PyTuple_GET_SIZE(self->path); i++) {
+        PyObject *segment = PyTuple_GET_ITEM(self->path, i);
+        Py_SETREF(location, attrs != NULL && attrs[i] ? PyUnicode_FromFormat("%U.%U", location, segment)
+                                                       : PyUnicode_FromFormat("%U[%R]", location, segment));
+    }
+    return location;
+}
+
+// Formats the expected hint into its display name in place.
+static int type_error_format_expected(GuardianTypeErrorObject *self) {
+    if (self->expected == NULL || PyUnicode_Check(self->expected)) return 0;
+    PyObject *name = expected_display(self->expected);
+    if (name == NULL) return -1;
+    Py_SETREF(self->expected, name);
+    return 0;
+}
+
+static PyObject *type_error_render(GuardianTypeErrorObject *self) {
+    if (type_error_resolve(self) < 0 || type_error_format_expected(self) < 0) return NULL;
+    if (FT_LOAD_PTR(ReprlibRepr) == NULL) {
+        PyObject *reprlib = PyImport_ImportModule("reprlib");
+        if (reprlib == NULL) return NULL;
+        PyObject *repr = PyObject_GetAttrString(reprlib, "repr");
+        Py_DECREF(reprlib);
+        if (repr == NULL) return NULL;
+        publish_once(&ReprlibRepr, repr);
+    }
+    PyObject *shown = PyObject_CallOneArg(ReprlibRepr, self->value);
+    if (shown == NULL) {
+        // e.g. an int past the str-conversion digit limit, or a raising __repr__
+        PyErr_Clear();
+        shown = PyUnicode_FromFormat("<%s object at %p>", _PyType_Name(Py_TYPE(self->value)), self->value);
+        if (shown == NULL) return NULL;
+    }
+    PyObject *message;
+    if (PyTuple_GET_SIZE(self->path) == 0 && self->prefix == NULL) {
+        message = PyUnicode_FromFormat("%U expected %U, got %s (%U)", self->subject, self->expected,
+                                       _PyType_Name(Py_TYPE(self->value)), shown);
+    } else {
+        PyObject *location = type_error_location(self);
+        message = location == NULL ? NULL : PyUnicode_FromFormat("%U expected %U, got %s (%U) at %U", self->subject,
+                                                                 self->expected, _PyType_Name(Py_TYPE(self->value)),
+                                                                 shown, location);
+        Py_XDECREF(location);
+    }
+    Py_DECREF(shown);
+    return message;
+}
+
+static PyObject *GuardianTypeError_str(GuardianTypeErrorObject *self) {
+    // Errors raised with a message (from Python, or re-raised with a location prefix) keep it
+    if (self->subject == NULL || PyTuple_GET_SIZE(self->base.args) != 0) {
+        return ((PyTypeObject *)PyExc_TypeError)->tp_str((PyObject *)self);
+    }
+    if (self->message == NULL) self->message = type_error_render(self);
+    return Py_XNewRef(self->message);
+}
+
+static PyObject *GuardianTypeError_repr(GuardianTypeErrorObject *self) {
+    if (self->subject == NULL || PyTuple_GET_SIZE(self->base.args) != 0) {
+        return ((PyTypeObject *)PyExc_TypeError)->tp_repr((PyObject *)self);
+    }
+    PyObject *message = GuardianTypeError_str(self);
+    PyObject *repr = message == NULL ? NULL : PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(self)), message);
+    Py_XDECREF(message);
+    return repr;
+}
+
+static PyObject *GuardianTypeError_get_path(GuardianTypeErrorObject *self, void *closure) {
+    if (self->path == NULL && self->subject == NULL) return Py_NewRef(EmptyTuple);
+    if (type_error_resolve(self) < 0) return NULL;
+    if (self->prefix != NULL) return PySequence_Concat(self->prefix, self->path);
+    return Py_NewRef(self->path);
+}
+
+static int GuardianTypeError_set_path(GuardianTypeErrorObject *self, PyObject *value, void *closure) {
+    if (value == NULL || !PyTuple_Check(value)) {
+        PyErr_SetString(PyExc_TypeError, "path must be a tuple");
+        return -1;
+    }
+    Py_XSETREF(self->path, Py_NewRef(value));
+    Py_CLEAR(self->prefix);
+    Py_CLEAR(self->attr_steps);
+    if (self->value == NULL) self->value = Py_NewRef(self->root != NULL ? self->root : Py_None);
+    return 0;
+}
+
+static PyObject *GuardianTypeError_get_expected(GuardianTypeErrorObject *self, void *closure) {
+    if (type_error_format_expected(self) < 0) return NULL;
+    return Py_NewRef(self->expected != NULL ? self->expected : Py_None);
+}
+
+static PyObject *GuardianTypeError_get_value(GuardianTypeErrorObject *self, void *closure) {
+    if (self->subject == NULL) return Py_NewRef(self->value != NULL ? self->value : Py_None);
+    if (type_error_resolve(self) < 0) return NULL;
+    return Py_NewRef(self->value);
+}
+
+// Pickles as a plain-message error: the rule and offending objects stay behind.
+static PyObject *GuardianTypeError_reduce(GuardianTypeErrorObject *self, PyObject *Py_UNUSED(ignored)) {
+    PyObject *message = PyObject_Str((PyObject *)self);
+    PyObject *path = message == NULL ? NULL : GuardianTypeError_get_path(self, NULL);
+    PyObject *result = path == NULL ? NULL : Py_BuildValue("O(O){sO}", Py_TYPE(self), message, "path", path);
+    Py_XDECREF(message);
+    Py_XDECREF(path);
+    return result;
+}
+
+static PyMethodDef GuardianTypeError_methods[] = {
+    {"__reduce__", (PyCFunction)GuardianTypeError_reduce, METH_NOARGS, NULL},
+    {NULL}
+};
+
+static int GuardianTypeError_traverse(GuardianTypeErrorObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->name);
+    Py_VISIT(self->expected);
+    Py_VISIT(self->rule);
+    Py_VISIT(self->root);
+    Py_VISIT(self->path);
+    Py_VISIT(self->prefix);
+    Py_VISIT(self->value);
+    return ((PyTypeObject *)PyExc_TypeError)->tp_traverse((PyObject *)self, visit, arg);
+}
+
+static int GuardianTypeError_clear(GuardianTypeErrorObject *self) {
+    Py_CLEAR(self->subject);
+    Py_CLEAR(self->name);
+    Py_CLEAR(self->expected);
+    Py_CLEAR(self->rule);
+    Py_CLEAR(self->root);
+    Py_CLEAR(self->path);
+    Py_CLEAR(self->prefix);
+    Py_CLEAR(self->attr_steps);
+    Py_CLEAR(self->value);
+    Py_CLEAR(self->message);
+    return ((PyTypeObject *)PyExc_TypeError)->tp_clear((PyObject *)self);
+}
+
+static void GuardianTypeError_dealloc(GuardianTypeErrorObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    GuardianTypeError_clear(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyMemberDef GuardianTypeError_members[] = {
+    {"name", T_OBJECT, offsetof(GuardianTypeErrorObject, name), READONLY, "Name of the checked parameter or field, if any"},
+    {"rule", T_OBJECT, offsetof(GuardianTypeErrorObject, rule), READONLY, "The compiled rule the value failed"},
+    {NULL}
+};
+
+static PyGetSetDef GuardianTypeError_getset[] = {
+    {"path", (getter)GuardianTypeError_get_path, (setter)GuardianTypeError_set_path,
+     "Keys / indices from the checked value to the offending element, e.g. ('sensor_A', 2); "
+     "from_dict / from_json errors start at the ingested document", NULL},
+    {"value", (getter)GuardianTypeError_get_value, NULL, "The innermost offending object", NULL},
+    {"expected", (getter)GuardianTypeError_get_expected, NULL, "Display name of the expected type", NULL},
+    {NULL}
+};
+
+static PyType_Slot GuardianTypeError_slots[] = {
+    {Py_tp_doc, "A value failed a guardian type check."},
+    {Py_tp_dealloc, GuardianTypeError_dealloc},
+    {Py_tp_traverse, GuardianTypeError_traverse},
+    {Py_tp_clear, GuardianTypeError_clear},
+    {Py_tp_repr, GuardianTypeError_repr},
+    {Py_tp_str, GuardianTypeError_str},
+    {Py_tp_methods, GuardianTypeError_methods},
+    {Py_tp_members, GuardianTypeError_members},
+    {Py_tp_getset, GuardianTypeError_getset},
+    {0, NULL}
+};
+
+static PyType_Spec GuardianTypeError_spec = {  // based on TypeError at init
+    .name = "guardian.GuardianTypeError",
+    .basicsize = sizeof(GuardianTypeErrorObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = GuardianTypeError_slots,
+};
+
+// --- GUARDED CONTAINERS ---
+// GuardedList / GuardedDict / GuardedSet are list, dict and set subclasses bound to
+// compiled element rules. Every mutator that can introduce a new element validates
+// it first.
+//
+// That does not make the contents trustworthy on its own: the base type's methods
+// (list.__setitem__(gl, 0, x), dict.__setitem__, set.add) and C code writing through
+// PyList_SetItem, PyDict_SetItem, ... bypass the checks. Boundaries therefore scan a
+// guarded container like any other, unless its owner sets `trusted`, asserting that no
+// such writes happen. A trusted container whose bound rules subsume a boundary's
+// element rules is accepted without a scan, after one rescan when it is first trusted.
+// Its length is also compared with a snapshot taken after the last checked mutation,
+// and a mismatch costs another rescan. Out-of-band writes that keep the length where
+// the snapshot expects it (replacing an element) are not detected on trusted
+// containers.
+
+typedef struct {
+    PyObject *hints;            // tuple of element hints, kept for repr and pickling
+    PyObject *rules[2];         // item rule, or key and value rules
+    PyObject *names[2];         // formatted hint names for error messages
+    PyObject *accepted;         // last Rule proven to be satisfied by the bound rules...
+    Py_ssize_t accepted_node;   // ...through this container node of it
+    Py_ssize_t verified_len;    // length after the last checked mutation or rescan; -1: rescan
+    int trusted;                // opted in to boundary acceptance without a scan
+} GuardBinding;
+
+typedef struct {
+    PyListObject list;
+    GuardBinding bind;
+} GuardedListObject;
+
+typedef struct {
+    PyDictObject dict;
+    GuardBinding bind;
+} GuardedDictObject;
+
+typedef struct {
+    PySetObject set;
+    GuardBinding bind;
+} GuardedSetObject;
+
+// Compiles an element hint through compile_program, whose cache shares the Rule.
+static int compile_element_hint(PyObject *hint, PyObject **rule, PyObject **name) {
+    if (load_compiler() < 0) return -1;
+    *rule = PyObject_CallOneArg(CompileProgram, hint);
+    if (*rule == NULL) return -1;
+    *name = PyObject_CallOneArg(FormatTypeName, hint);
+    if (*name == NULL) {
+        Py_CLEAR(*rule);
+        return -1;
+    }
+    if (!Rule_Check(*rule) || !PyUnicode_Check(*name)) {
+        PyErr_Format(PyExc_TypeError, "cannot bind a guarded container to %R", hint);
+        Py_CLEAR(*rule);
+        Py_CLEAR(*name);
+        return -1;
+    }
+    return 0;
+}
+
+static int binding_init(GuardBinding *b, PyObject *hints) {
+    b->hints = Py_NewRef(hints);
+    b->verified_len = 0;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(hints); i++) {
+        if (compile_element_hint(PyTuple_GET_ITEM(hints, i), &b->rules[i], &b->names[i]) < 0) return -1;
+    }
+    return 0;
+}
+
+static int binding_traverse(GuardBinding *b, visitproc visit, void *arg) {
+    Py_VISIT(b->hints);
+    Py_VISIT(b->rules[0]);
+    Py_VISIT(b->rules[1]);
+    Py_VISIT(b->names[0]);
+    Py_VISIT(b->names[1]);
+    Py_VISIT(b->accepted);
+    return 0;
+}
+
+static void binding_clear(GuardBinding *b) {
+    Py_CLEAR(b->hints);
+    Py_CLEAR(b->rules[0]);
+    Py_CLEAR(b->rules[1]);
+    Py_CLEAR(b->names[0]);
+    Py_CLEAR(b->names[1]);
+    Py_CLEAR(b->accepted);
+}
+
+// Validates one element against bound rule `which`; raises GuardianTypeError on a mismatch.
+static int binding_check(PyObject *self, GuardBinding *b, int which, const char *role, PyObject *value) {
+    int res = fast_check_type(value, b->rules[which]);
+    if (likely(res > 0)) return 0;
+    if (res == 0) {
+        PyObject *subject = PyUnicode_FromFormat("%s %s", _PyType_Name(Py_TYPE(self)), role);
+        PyObject *name = PyUnicode_FromString(role);
+        if (subject != NULL && name != NULL) raise_rule_error(subject, name, b->names[which], b->rules[which], value);
+        Py_XDECREF(subject);
+        Py_XDECREF(name);
+    }
+    return -1;
+}
+
+// Called after a checked mutation took the container from `before` to `after` elements.
+// The snapshot only follows along if nothing else changed the length in between.
+static inline void binding_sync(GuardBinding *b, Py_ssize_t before, Py_ssize_t after) {
+    b->verified_len = b->verified_len == before ? after : -1;
+}
+
+static int binding_check_seq(PyObject *self, GuardBinding *b, PyObject *seq) {
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+        if (binding_check(self, b, 0, "item", PySequence_Fast_GET_ITEM(seq, i)) < 0) return -1;
+    }
+    return 0;
+}
+
+// True if every value node `a` of rule `ra` accepts is also accepted by node `b` of `rb`,
+// *and* that verdict cannot change while the value sits in the container. Verdicts that
+// depend on mutable state (nested plain containers, tag attributes, custom
+// __instancecheck__) are never reused, so those shapes keep their element scan.
+static int node_subsumes(const RuleObject *ra, const RuleNode *a, const RuleObject *rb, const RuleNode *b) {
+    if (b->op == OP_ANY) return 1;
+    switch (b->op) {
+        case OP_UNION:
+        case OP_UNION_DISPATCH:
+            if (a->op == OP_UNION || a->op == OP_UNION_DISPATCH) break;
+            for (Py_ssize_t i = 0; i < b->n_kids; i++) {
+                if (node_subsumes(ra, a, rb, RULE_KID(rb, b, i))) return 1;
+            }
+            return 0;
+    }
+    switch (a->op) {
+        case OP_UNION:
+        case OP_UNION_DISPATCH:
+            for (Py_ssize_t i = 0; i < a->n_kids; i++) {
+                if (!node_subsumes(ra, RULE_KID(ra, a, i), rb, b)) return 0;
+            }
+            return 1;
+        case OP_EXACT:
+        case OP_INSTANCE: {
+            if (a->type == NULL || (b->op != OP_EXACT && b->op != OP_INSTANCE) || b->type == NULL) return 0;
+            PyObject *a_meta = (PyObject *)Py_TYPE(a->type), *b_meta = (PyObject *)Py_TYPE(b->type);
+            if (a->op == OP_INSTANCE && a_meta != (PyObject *)&PyType_Type && a_meta != AbcMetaType) return 0;
+            if (b->op == OP_EXACT) return a->op == OP_EXACT && a->type == b->type;
+            if (a->type == b->type) return 1;
+            // A real subclass passes isinstance() for plain classes and ABCs alike.
+            return (b_meta == (PyObject *)&PyType_Type || b_meta == AbcMetaType) && PyType_IsSubtype(a->type, b->type);
+        }
+        case OP_TUPLE_VAR:
+            if (b->op != OP_TUPLE_VAR) return 0;
+            return node_subsumes(ra, RULE_KID(ra, a, 0), rb, RULE_KID(rb, b, 0));
+        case OP_TUPLE_FIXED:
+            if (b->op == OP_TUPLE_VAR) {
+                for (Py_ssize_t i = 0; i < a->n_kids; i++) {
+                    if (!node_subsumes(ra, RULE_KID(ra, a, i), rb, RULE_KID(rb, b, 0))) return 0;
+                }
+                return 1;
+            }
+            if (b->op != OP_TUPLE_FIXED || a->n_kids != b->n_kids) return 0;
+            for (Py_ssize_t i = 0; i < a->n_kids; i++) {
+                if (!node_subsumes(ra, RULE_KID(ra, a, i), rb, RULE_KID(rb, b, i))) return 0;
+            }
+            return 1;
+        case OP_LITERAL: {
+            if (b->op != OP_LITERAL) return 0;
+            if (a->arg == b->arg) return 1;
+            for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(a->arg); i++) {
+                int res = literal_lookup(b, PyTuple_GET_ITEM(a->arg, i));
+                if (res <= 0) {
+                    if (res < 0) PyErr_Clear();
+                    return 0;
+                }
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Fast path for check_node: 1 if the bound rules subsume the container node's element
+// rules, 0 if the caller must scan the elements as usual.
+static int binding_accepts(GuardBinding *b, const RuleObject *r, const RuleNode *node) {
+    Py_ssize_t index = node - r->nodes;
+    if (b->accepted == (PyObject *)r && b->accepted_node == index) return 1;
+    for (Py_ssize_t i = 0; i < node->n_kids; i++) {
+        if (b->rules[i] == NULL) return 0;
+        const RuleObject *bound = (const RuleObject *)b->rules[i];
+        if (!node_subsumes(bound, bound->nodes, r, RULE_KID(r, node, i))) return 0;
+    }
+    Py_XSETREF(b->accepted, Py_NewRef((PyObject *)r));
+    b->accepted_node = index;
+    return 1;
+}
+
+static PyObject *binding_repr(PyObject *self, GuardBinding *b, PyObject *contents) {
+    if (contents == NULL) return NULL;
+    PyObject *res = b->names[1] != NULL
+        ? PyUnicode_FromFormat("%s[%U, %U](%U)", _PyType_Name(Py_TYPE(self)), b->names[0], b->names[1], contents)
+        : PyUnicode_FromFormat("%s[%U](%U)", _PyType_Name(Py_TYPE(self)), b->names[0], contents);
+    Py_DECREF(contents);
+    return res;
+}
+
+// Rebuilds the container as cls(*hints, plain_copy) so the binding survives pickle and copy.
+static PyObject *binding_reduce(PyObject *self, GuardBinding *b, PyTypeObject *base) {
+    PyObject *plain = PyObject_CallOneArg((PyObject *)base, self);
+    if (plain == NULL) return NULL;
+    Py_ssize_t n = PyTuple_GET_SIZE(b->hints);
+    PyObject *args = PyTuple_New(n + 1);
+    if (args == NULL) {
+        Py_DECREF(plain);
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) PyTuple_SET_ITEM(args, i, Py_NewRef(PyTuple_GET_ITEM(b->hints, i)));
+    PyTuple_SET_ITEM(args, n, plain);
+    return Py_BuildValue("(ON)", (PyObject *)Py_TYPE(self), args);
+}
+
+// Calls an unbound method of the builtin base type, e.g. set.symmetric_difference_update(self, other).
+static PyObject *call_base_method(PyTypeObject *base, const char *name, PyObject *self, PyObject *arg) {
+    PyObject *attr = PyUnicode_InternFromString(name);
+    if (attr == NULL) return NULL;
+    PyObject *method = _PyType_Lookup(base, attr);
+    Py_DECREF(attr);
+    if (method == NULL) return PyErr_Format(PyExc_AttributeError, "%s has no method %s", base->tp_name, name);
+    return PyObject_CallFunctionObjArgs(method, self, arg, NULL);
+}
+
+static PyObject *binding_hint(GuardBinding *b, Py_ssize_t i) {
+    return Py_NewRef(PyTuple_GET_ITEM(b->hints, i));
+}
+
+// `trusted`, shared by the three types; the closure is the binding's offset in the object.
+static PyObject *binding_get_trusted(PyObject *self, void *offset) {
+    GuardBinding *b = (GuardBinding *)((char *)self + (Py_ssize_t)offset);
+    int trusted;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    trusted = b->trusted;
+    Py_END_CRITICAL_SECTION();
+    return PyBool_FromLong(trusted);
+}
+
+static int binding_set_trusted(PyObject *self, PyObject *value, void *offset) {
+    GuardBinding *b = (GuardBinding *)((char *)self + (Py_ssize_t)offset);
+    int trusted = value != NULL ? PyObject_IsTrue(value) : -1;
+    if (trusted < 0) {
+        if (value == NULL) PyErr_SetString(PyExc_AttributeError, "cannot delete trusted");
+        return -1;
+    }
+    Py_BEGIN_CRITICAL_SECTION(self);
+    b->trusted = trusted;
+    b->verified_len = -1;  // the contents are rescanned before they are first trusted
+    Py_END_CRITICAL_SECTION();
+    return 0;
+}
+
+#define BINDING_TRUSTED_DOC \
+    "If True, a boundary whose element types cover the bound ones accepts the container without scanning it.\n" \
+    "Only set it when nothing writes around the validating methods: list.__setitem__(c, i, x), dict.__setitem__,\n" \
+    "set.add and C-level writes bypass validation, and a bypassing write that keeps the length is never noticed.\n" \
+    "Not preserved by pickle or copy."
+
+#define BINDING_TRUSTED_GETSET(type) \
+    {"trusted", binding_get_trusted, binding_set_trusted, BINDING_TRUSTED_DOC, (void *)offsetof(type, bind)}
+
+// Splits (hint..., rest...) constructor arguments; returns the hints tuple.
+static PyObject *binding_hints_from_args(PyTypeObject *type, PyObject *args, Py_ssize_t n_hints) {
+    if (PyTuple_GET_SIZE(args) < n_hints) {
+        PyErr_Format(PyExc_TypeError, "%s() needs %zd element type argument%s",
+                     _PyType_Name(type), n_hints, n_hints == 1 ? "" : "s");
+        return NULL;
+    }
+    return PyTuple_GetSlice(args, 0, n_hints);
+}
+
+// GuardedList
+
+static PyTypeObject *GuardedListType;
+
+#define GuardedList_Check(op) (!PyList_CheckExact(op) && PyObject_TypeCheck(op, GuardedListType))
+
+static PyObject *GuardedList_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    PyObject *hints = binding_hints_from_args(type, args, 1);
+    if (hints == NULL) return NULL;
+    GuardedListObject *self = (GuardedListObject *)PyList_Type.tp_new(type, EmptyTuple, NULL);
+    if (self == NULL || binding_init(&self->bind, hints) < 0) {
+        Py_XDECREF(self);
+        Py_DECREF(hints);
+        return NULL;
+    }
+    Py_DECREF(hints);
+    return (PyObject *)self;
+}
+
+static int GuardedList_init(GuardedListObject *self, PyObject *args, PyObject *kwds) {
+    PyObject *hint, *iterable = NULL;
+    if (!PyArg_ParseTuple(args, "O|O:GuardedList", &hint, &iterable)) return -1;
+    if (kwds != NULL && PyDict_GET_SIZE(kwds) > 0) {
+        PyErr_SetString(PyExc_TypeError, "GuardedList() takes no keyword arguments");
+        return -1;
+    }
+    PyObject *seq = iterable != NULL ? PySequence_Fast(iterable, "GuardedList() argument must be iterable") : PyList_New(0);
+    if (seq == NULL) return -1;
+    int res = binding_check_seq((PyObject *)self, &self->bind, seq);
+    if (res == 0) res = PyList_SetSlice((PyObject *)self, 0, PY_SSIZE_T_MAX, seq);
+    if (res == 0) self->bind.verified_len = PyList_GET_SIZE(self);  // every element was just replaced
+    Py_DECREF(seq);
+    return res;
+}
+
+static int GuardedList_traverse(GuardedListObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    int res = PyList_Type.tp_traverse((PyObject *)self, visit, arg);
+    return res ? res : binding_traverse(&self->bind, visit, arg);
+}
+
+static int GuardedList_clear(GuardedListObject *self) {
+    binding_clear(&self->bind);
+    return PyList_Type.tp_clear((PyObject *)self);
+}
+
+static void GuardedList_dealloc(GuardedListObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    binding_clear(&self->bind);
+    PyList_Type.tp_dealloc((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *GuardedList_repr(GuardedListObject *self) {
+    return binding_repr((PyObject *)self, &self->bind, PyList_Type.tp_repr((PyObject *)self));
+}
+
+static PyObject *GuardedList_append(GuardedListObject *self, PyObject *value) {
+    if (binding_check((PyObject *)self, &self->bind, 0, "item", value) < 0) return NULL;
+    Py_ssize_t before = PyList_GET_SIZE(self);
+    if (PyList_Append((PyObject *)self, value) < 0) return NULL;
+    binding_sync(&self->bind, before, PyList_GET_SIZE(self));
+    Py_RETURN_NONE;
+}
+
+static PyObject *GuardedList_extend(GuardedListObject *self, PyObject *iterable) {
+    PyObject *seq = PySequence_Fast(iterable, "GuardedList.extend() argument must be iterable");
+    if (seq == NULL) return NULL;
+    Py_ssize_t n = PyList_GET_SIZE(self);
+    int res = binding_check_seq((PyObject *)self, &self->bind, seq);
+    if (res == 0) res = PyList_SetSlice((PyObject *)self, n, n, seq);
+    if (res == 0) binding_sync(&self->bind, n, PyList_GET_SIZE(self));
+    Py_DECREF(seq);
+    if (res < 0) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *GuardedList_insert(GuardedListObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    if (nargs != 2) return PyErr_Format(PyExc_TypeError, "insert expected 2 arguments, got %zd", nargs);
+    Py_ssize_t index = PyNumber_AsSsize_t(args[0], PyExc_OverflowError);
+    if (index == -1 && PyErr_Occurred()) return NULL;
+    if (binding_check((PyObject *)self, &self->bind, 0, "item", args[1]) < 0) return NULL;
+    Py_ssize_t before = PyList_GET_SIZE(self);
+    if (PyList_Insert((PyObject *)self, index, args[1]) < 0) return NULL;
+    binding_sync(&self->bind, before, PyList_GET_SIZE(self));
+    Py_RETURN_NONE;
+}
+
+static int GuardedList_ass_subscript(GuardedListObject *self, PyObject *key, PyObject *value) {
+    Py_ssize_t before = PyList_GET_SIZE(self);
+    int res;
+    if (value != NULL && PySlice_Check(key)) {
+        PyObject *seq = PySequence_Fast(value, "can only assign an iterable");
+        if (seq == NULL) return -1;
+        res = binding_check_seq((PyObject *)self, &self->bind, seq);
+        if (res == 0) res = PyList_Type.tp_as_mapping->mp_ass_subscript((PyObject *)self, key, seq);
+        Py_DECREF(seq);
+    } else {
+        if (value != NULL && binding_check((PyObject *)self, &self->bind, 0, "item", value) < 0) return -1;
+        res = PyList_Type.tp_as_mapping->mp_ass_subscript((PyObject *)self, key, value);
+    }
+    if (res == 0) binding_sync(&self->bind, before, PyList_GET_SIZE(self));
+    return res;
+}
+
+static int GuardedList_ass_item(GuardedListObject *self, Py_ssize_t index, PyObject *value) {
+    if (value != NULL && binding_check((PyObject *)self, &self->bind, 0, "item", value) < 0) return -1;
+    Py_ssize_t before = PyList_GET_SIZE(self);
+    int res = PyList_Type.tp_as_sequence->sq_ass_item((PyObject *)self, index, value);
+    if (res == 0) binding_sync(&self->bind, before, PyList_GET_SIZE(self));
+    return res;
+}
+
+static PyObject *GuardedList_inplace_concat(GuardedListObject *self, PyObject *other) {
+    PyObject *res = GuardedList_extend(self, other);
+    if (res == NULL) return NULL;
+    Py_DECREF(res);
+    return Py_NewRef((PyObject *)self);
+}
+
+static PyObject *GuardedList_reduce(GuardedListObject *self, PyObject *Py_UNUSED(ignored)) {
+    return binding_reduce((PyObject *)self, &self->bind, &PyList_Type);
+}
+
+static PyObject *GuardedList_item_type(GuardedListObject *self, void *closure) {
+    return binding_hint(&self->bind, 0);
+}
+
+static PyMethodDef GuardedList_methods[] = {
+    {"append", (PyCFunction)GuardedList_append, METH_O, "Validate and append an item"},
+    {"extend", (PyCFunction)GuardedList_extend, METH_O, "Validate every item, then extend the list"},
+    {"insert", (PyCFunction)(void(*)(void))GuardedList_insert, METH_FASTCALL, "Validate and insert an item before index"},
+    {"__reduce__", (PyCFunction)GuardedList_reduce, METH_NOARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef GuardedList_getset[] = {
+    {"item_type", (getter)GuardedList_item_type, NULL, "The element type hint the list is bound to", NULL},
+    BINDING_TRUSTED_GETSET(GuardedListObject),
+    {NULL}
+};
+
+static PyType_Slot GuardedList_slots[] = {
+    {Py_tp_doc, "GuardedList(item_type, iterable=())\n--\n\nA list that validates every item it receives against item_type.\n"
+                "Boundaries scan it unless trusted is set; see trusted for the writes validation cannot see."},
+    {Py_tp_new, GuardedList_new},
+    {Py_tp_init, GuardedList_init},
+    {Py_tp_dealloc, GuardedList_dealloc},
+    {Py_tp_traverse, GuardedList_traverse},
+    {Py_tp_clear, GuardedList_clear},
+    {Py_tp_repr, GuardedList_repr},
+    {Py_tp_methods, GuardedList_methods},
+    {Py_tp_getset, GuardedList_getset},
+    {Py_sq_ass_item, GuardedList_ass_item},
+    {Py_sq_inplace_concat, GuardedList_inplace_concat},
+    {Py_mp_ass_subscript, GuardedList_ass_subscript},
+    {0, NULL}
+};
+
+static PyType_Spec GuardedList_spec = {  // based on list at init
+    .name = "guardian.GuardedList",
+    .basicsize = sizeof(GuardedListObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = GuardedList_slots,
+};
+
+// GuardedDict
+
+static PyTypeObject *GuardedDictType;
+
+#define GuardedDict_Check(op) (!PyDict_CheckExact(op) && PyObject_TypeCheck(op, GuardedDictType))
+
+static int GuardedDict_check_item(GuardedDictObject *self, PyObject *key, PyObject *value) {
+    if (binding_check((PyObject *)self, &self->bind, 0, "key", key) < 0) return -1;
+    return binding_check((PyObject *)self, &self->bind, 1, "value", value);
+}
+
+// Materializes dict-update arguments into a plain dict, validates it, then merges it in.
+static int GuardedDict_merge(GuardedDictObject *self, PyObject *args, PyObject *kwds) {
+    PyObject *items = PyObject_Call((PyObject *)&PyDict_Type, args, kwds);
+    if (items == NULL) return -1;
+    PyObject *key, *value;
+    Py_ssize_t pos = 0;
+    int res = 0;
+    while (res == 0 && PyDict_Next(items, &pos, &key, &value)) res = GuardedDict_check_item(self, key, value);
+    Py_ssize_t before = PyDict_GET_SIZE(self);
+    if (res == 0) res = PyDict_Update((PyObject *)self, items);
+    if (res == 0) binding_sync(&self->bind, before, PyDict_GET_SIZE(self));
+    Py_DECREF(items);
+    return res;
+}
+
+static PyObject *GuardedDict_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    PyObject *hints = binding_hints_from_args(type, args, 2);
+    if (hints == NULL) return NULL;
+    GuardedDictObject *self = (GuardedDictObject *)PyDict_Type.tp_new(type, EmptyTuple, NULL);
+    if (self == NULL || binding_init(&self->bind, hints) < 0) {
+        Py_XDECREF(self);
+        Py_DECREF(hints);
+        return NULL;
+    }
+    Py_DECREF(hints);
+    return (PyObject *)self;
+}
+
+static int GuardedDict_init(GuardedDictObject *self, PyObject *args, PyObject *kwds) {
+    if (PyTuple_GET_SIZE(args) > 3) {
+        PyErr_Format(PyExc_TypeError, "GuardedDict expected at most 3 arguments, got %zd", PyTuple_GET_SIZE(args));
+        return -1;
+    }
+    PyObject *rest = PyTuple_GetSlice(args, 2, 3);
+    if (rest == NULL) return -1;
+    int res = GuardedDict_merge(self, rest, kwds);
+    Py_DECREF(rest);
+    return res;
+}
+
+static int GuardedDict_traverse(GuardedDictObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    int res = PyDict_Type.tp_traverse((PyObject *)self, visit, arg);
+    return res ? res : binding_traverse(&self->bind, visit, arg);
+}
+
+static int GuardedDict_clear(GuardedDictObject *self) {
+    binding_clear(&self->bind);
+    return PyDict_Type.tp_clear((PyObject *)self);
+}
+
+static void GuardedDict_dealloc(GuardedDictObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    binding_clear(&self->bind);
+    PyDict_Type.tp_dealloc((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *GuardedDict_repr(GuardedDictObject *self) {
+    return binding_repr((PyObject *)self, &self->bind, PyDict_Type.tp_repr((PyObject *)self));
+}
+
+static int GuardedDict_ass_subscript(GuardedDictObject *self, PyObject *key, PyObject *value) {
+    if (value != NULL && GuardedDict_check_item(self, key, value) < 0) return -1;
+    Py_ssize_t before = PyDict_GET_SIZE(self);
+    int res = PyDict_Type.tp_as_mapping->mp_ass_subscript((PyObject *)self, key, value);
+    if (res == 0) binding_sync(&self->bind, before, PyDict_GET_SIZE(self));
+    return res;
+}
+
+static PyObject *GuardedDict_update(GuardedDictObject *self, PyObject *args, PyObject *kwds) {
+    if (PyTuple_GET_SIZE(args) > 1) {
+        return PyErr_Format(PyExc_TypeError, "update expected at most 1 argument, got %zd", PyTuple_GET_SIZE(args));
+    }
+    if (GuardedDict_merge(self, args, kwds) < 0) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *GuardedDict_setdefault(GuardedDictObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    if (nargs < 1 || nargs > 2) return PyErr_Format(PyExc_TypeError, "setdefault expected 1 or 2 arguments, got %zd", nargs);
+    PyObject *value = PyDict_GetItemWithError((PyObject *)self, args[0]);
+    if (value != NULL) return Py_NewRef(value);
+    if (PyErr_Occurred()) return NULL;
+    PyObject *fallback = nargs == 2 ? args[1] : Py_None;
+    if (GuardedDict_check_item(self, args[0], fallback) < 0) return NULL;
+    Py_ssize_t before = PyDict_GET_SIZE(self);
+    value = PyDict_SetDefault((PyObject *)self, args[0], fallback);
+    if (value != NULL) binding_sync(&self->bind, before, PyDict_GET_SIZE(self));
+    return Py_XNewRef(value);
+}
+
+static PyObject *GuardedDict_inplace_or(GuardedDictObject *self, PyObject *other) {
+    PyObject *args = PyTuple_Pack(1, other);
+    if (args == NULL) return NULL;
+    int res = GuardedDict_merge(self, args, NULL);
+    Py_DECREF(args);
+    if (res < 0) return NULL;
+    return Py_NewRef((PyObject *)self);
+}
+
+static PyObject *GuardedDict_reduce(GuardedDictObject *self, PyObject *Py_UNUSED(ignored)) {
+    return binding_reduce((PyObject *)self, &self->bind, &PyDict_Type);
+}
+
+static PyObject *GuardedDict_key_type(GuardedDictObject *self, void *closure) {
+    return binding_hint(&self->bind, 0);
+}
+
+static PyObject *GuardedDict_value_type(GuardedDictObject *self, void *closure) {
+    return binding_hint(&self->bind, 1);
+}
+
+static PyMethodDef GuardedDict_methods[] = {
+    {"update", (PyCFunction)(void(*)(void))GuardedDict_update, METH_VARARGS | METH_KEYWORDS, "Validate every item, then update the dict"},
+    {"setdefault", (PyCFunction)(void(*)(void))GuardedDict_setdefault, METH_FASTCALL, "Validate and insert the default if key is missing"},
+    {"__reduce__", (PyCFunction)GuardedDict_reduce, METH_NOARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef GuardedDict_getset[] = {
+    {"key_type", (getter)GuardedDict_key_type, NULL, "The key type hint the dict is bound to", NULL},
+    {"value_type", (getter)GuardedDict_value_type, NULL, "The value type hint the dict is bound to", NULL},
+    BINDING_TRUSTED_GETSET(GuardedDictObject),
+    {NULL}
+};
+
+static PyType_Slot GuardedDict_slots[] = {
+    {Py_tp_doc, "GuardedDict(key_type, value_type, mapping=(), **kwargs)\n--\n\n"
+                "A dict that validates every key and value it receives.\n"
+                "Boundaries scan it unless trusted is set; see trusted for the writes validation cannot see."},
+    {Py_tp_new, GuardedDict_new},
+    {Py_tp_init, GuardedDict_init},
+    {Py_tp_dealloc, GuardedDict_dealloc},
+    {Py_tp_traverse, GuardedDict_traverse},
+    {Py_tp_clear, GuardedDict_clear},
+    {Py_tp_repr, GuardedDict_repr},
+    {Py_tp_methods, GuardedDict_methods},
+    {Py_tp_getset, GuardedDict_getset},
+    {Py_mp_ass_subscript, GuardedDict_ass_subscript},
+    {Py_nb_inplace_or, GuardedDict_inplace_or},
+    {0, NULL}
+};
+
+static PyType_Spec GuardedDict_spec = {  // based on dict at init
+    .name = "guardian.GuardedDict",
+    .basicsize = sizeof(GuardedDictObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = GuardedDict_slots,
+};
+
+// GuardedSet
+
+static PyTypeObject *GuardedSetType;
+
+#define GuardedSet_Check(op) (!PyAnySet_CheckExact(op) && PyObject_TypeCheck(op, GuardedSetType))
+
+// Validates every item of iterable, then adds them all.
+static int GuardedSet_add_all(GuardedSetObject *self, PyObject *iterable) {
+    PyObject *seq = PySequence_Fast(iterable, "GuardedSet argument must be iterable");
+    if (seq == NULL) return -1;
+    int res = binding_check_seq((PyObject *)self, &self->bind, seq);
+    Py_ssize_t before = PySet_GET_SIZE(self);
+    for (Py_ssize_t i = 0; res == 0 && i < PySequence_Fast_GET_SIZE(seq); i++) {
+        res = PySet_Add((PyObject *)self, PySequence_Fast_GET_ITEM(seq, i));
+    }
+    binding_sync(&self->bind, before, PySet_GET_SIZE(self));  // a partial add only added checked items
+    Py_DECREF(seq);
+    return res;
+}
+
+static PyObject *GuardedSet_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    PyObject *hints = binding_hints_from_args(type, args, 1);
+    if (hints == NULL) return NULL;
+    GuardedSetObject *self = (GuardedSetObject *)PySet_Type.tp_new(type, EmptyTuple, NULL);
+    if (self == NULL || binding_init(&self->bind, hints) < 0) {
+        Py_XDECREF(self);
+        Py_DECREF(hints);
+        return NULL;
+    }
+    Py_DECREF(hints);
+    return (PyObject *)self;
+}
+
+static int GuardedSet_init(GuardedSetObject *self, PyObject *args, PyObject *kwds) {
+    PyObject *hint, *iterable = NULL;
+    if (!PyArg_ParseTuple(args, "O|O:GuardedSet", &hint, &iterable)) return -1;
+    if (kwds != NULL && PyDict_GET_SIZE(kwds) > 0) {
+        PyErr_SetString(PyExc_TypeError, "GuardedSet() takes no keyword arguments");
+        return -1;
+    }
+    if (PySet_Clear((PyObject *)self) < 0) return -1;
+    self->bind.verified_len = 0;
+    return iterable != NULL ? GuardedSet_add_all(self, iterable) : 0;
+}
+
+static int GuardedSet_traverse(GuardedSetObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    int res = PySet_Type.tp_traverse((PyObject *)self, visit, arg);
+    return res ? res : binding_traverse(&self->bind, visit, arg);
+}
+
+static int GuardedSet_clear(GuardedSetObject *self) {
+    binding_clear(&self->bind);
+    return PySet_Type.tp_clear((PyObject *)self);
+}
+
+static void GuardedSet_dealloc(GuardedSetObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    binding_clear(&self->bind);
+    PySet_Type.tp_dealloc((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *GuardedSet_repr(GuardedSetObject *self) {
+    PyObject *items = PySequence_List((PyObject *)self);
+    if (items == NULL) return NULL;
+    PyObject *contents = PyList_GET_SIZE(items) > 0 ? PyObject_Repr(items) : PyUnicode_FromString("");
+    Py_DECREF(items);
+    return binding_repr((PyObject *)self, &self->bind, contents);
+}
+
+static PyObject *GuardedSet_add(GuardedSetObject *self, PyObject *item) {
+    if (binding_check((PyObject *)self, &self->bind, 0, "item", item) < 0) return NULL;
+    Py_ssize_t before = PySet_GET_SIZE(self);
+    if (PySet_Add((PyObject *)self, item) < 0) return NULL;
+    binding_sync(&self->bind, before, PySet_GET_SIZE(self));
+    Py_RETURN_NONE;
+}
+
+static PyObject *GuardedSet_update(GuardedSetObject *self, PyObject *args) {
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(args); i++) {
+        if (GuardedSet_add_all(self, PyTuple_GET_ITEM(args, i)) < 0) return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *GuardedSet_symmetric_difference_update(GuardedSetObject *self, PyObject *other) {
+    // Only the items of other that are not already present get added.
+    PyObject *seq = PySequence_Fast(other, "GuardedSet argument must be iterable");
+    if (seq == NULL) return NULL;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        int present = PySet_Contains((PyObject *)self, item);
+        if (present < 0 || (!present && binding_check((PyObject *)self, &self->bind, 0, "item", item) < 0)) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+    Py_ssize_t before = PySet_GET_SIZE(self);
+    PyObject *res = call_base_method(&PySet_Type, "symmetric_difference_update", (PyObject *)self, seq);
+    if (res != NULL) binding_sync(&self->bind, before, PySet_GET_SIZE(self));
+    Py_DECREF(seq);
+    return res;
+}
+
+static PyObject *GuardedSet_inplace_or(GuardedSetObject *self, PyObject *other) {
+    if (!PyAnySet_Check(other)) Py_RETURN_NOTIMPLEMENTED;
+    if (GuardedSet_add_all(self, other) < 0) return NULL;
+    return Py_NewRef((PyObject *)self);
+}
+
+static PyObject *GuardedSet_inplace_xor(GuardedSetObject *self, PyObject *other) {
+    if (!PyAnySet_Check(other)) Py_RETURN_NOTIMPLEMENTED;
+    PyObject *res = GuardedSet_symmetric_difference_update(self, other);
+    if (res == NULL) return NULL;
+    Py_DECREF(res);
+    return Py_NewRef((PyObject *)self);
+}
+
+static PyObject *GuardedSet_reduce(GuardedSetObject *self, PyObject *Py_UNUSED(ignored)) {
+    return binding_reduce((PyObject *)self, &self->bind, &PyList_Type);
+}
+
+static PyObject *GuardedSet_item_type(GuardedSetObject *self, void *closure) {
+    return binding_hint(&self->bind, 0);
+}
+
+static PyMethodDef GuardedSet_methods[] = {
+    {"add", (PyCFunction)GuardedSet_add, METH_O, "Validate and add an item"},
+    {"update", (PyCFunction)GuardedSet_update, METH_VARARGS, "Validate every item, then add them all"},
+    {"symmetric_difference_update", (PyCFunction)GuardedSet_symmetric_difference_update, METH_O,
+     "Validate the items that would be added, then update with the symmetric difference"},
+    {"__reduce__", (PyCFunction)GuardedSet_reduce, METH_NOARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef GuardedSet_getset[] = {
+    {"item_type", (getter)GuardedSet_item_type, NULL, "The element type hint the set is bound to", NULL},
+    BINDING_TRUSTED_GETSET(GuardedSetObject),
+    {NULL}
+};
+
+static PyType_Slot GuardedSet_slots[] = {
+    {Py_tp_doc, "GuardedSet(item_type, iterable=())\n--\n\nA set that validates every item it receives against item_type.\n"
+                "Boundaries scan it unless trusted is set; see trusted for the writes validation cannot see."},
+    {Py_tp_new, GuardedSet_new},
+    {Py_tp_init, GuardedSet_init},
+    {Py_tp_dealloc, GuardedSet_dealloc},
+    {Py_tp_traverse, GuardedSet_traverse},
+    {Py_tp_clear, GuardedSet_clear},
+    {Py_tp_repr, GuardedSet_repr},
+    {Py_tp_methods, GuardedSet_methods},
+    {Py_tp_getset, GuardedSet_getset},
+    {Py_nb_inplace_or, GuardedSet_inplace_or},
+    {Py_nb_inplace_xor, GuardedSet_inplace_xor},
+    {0, NULL}
+};
+
+static PyType_Spec GuardedSet_spec = {  // based on set at init
+    .name = "guardian.GuardedSet",
+    .basicsize = sizeof(GuardedSetObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = GuardedSet_slots,
+};
+
+static Py_ssize_t guarded_len(PyObject *obj, int op) {
+    return op == OP_LIST ? PyList_GET_SIZE(obj) : op == OP_DICT ? PyDict_GET_SIZE(obj) : PySet_GET_SIZE(obj);
+}
+
+// Checks every element against the bound rules after the container's length moved behind
+// the checked methods' back; 1 retakes the snapshot, 0 leaves it to the caller's scan.
+static int binding_rescan(PyObject *obj, GuardBinding *b, int op) {
+    int res = 1;
+    if (op == OP_LIST) {
+        PyObject *item;
+        for (Py_ssize_t i = 0; res > 0 && (item = sequence_item_ref(obj, i)) != NULL; i++) {
+            res = fast_check_type(item, b->rules[0]);
+            Py_DECREF(item);
+        }
+    } else if (op == OP_DICT) {
+        PyObject *key, *value;
+        Py_ssize_t pos = 0;
+        while (res > 0 && dict_next_ref(obj, &pos, &key, &value)) {
+            res = fast_check_type(key, b->rules[0]);
+            if (res > 0) res = fast_check_type(value, b->rules[1]);
+            Py_DECREF(key);
+            Py_DECREF(value);
+        }
+    } else {
+        PyObject *iter = PyObject_GetIter(obj), *item;
+        if (iter == NULL) return -1;
+        while (res > 0 && (item = PyIter_Next(iter)) != NULL) {
+            res = fast_check_type(item, b->rules[0]);
+            Py_DECREF(item);
+        }
+        Py_DECREF(iter);
+        if (res > 0 && PyErr_Occurred()) res = -1;
+    }
+    if (res > 0) b->verified_len = guarded_len(obj, op);
+    return res < 0 ? -1 : res;
+}
+
+// check_node fast path: a trusted guarded container whose bound rules subsume the
+// node's element rules needs no element scan. 1: accepted, 0: scan as usual, -1: error.
+static int guarded_accepts(PyObject *obj, const RuleObject *r, const RuleNode *node) {
+    GuardBinding *b = NULL;
+    if (node->op == OP_LIST && GuardedList_Check(obj)) b = &((GuardedListObject *)obj)->bind;
+    else if (node->op == OP_DICT && GuardedDict_Check(obj)) b = &((GuardedDictObject *)obj)->bind;
+    else if (node->op == OP_SET && GuardedSet_Check(obj)) b = &((GuardedSetObject *)obj)->bind;
+    if (b == NULL || b->rules[0] == NULL) return 0;
+    int res, stale = 0;
+    Py_BEGIN_CRITICAL_SECTION(obj);  // the memo is two words, updated together
+    res = b->trusted ? binding_accepts(b, r, node) : 0;
+    stale = res > 0 && guarded_len(obj, node->op) != b->verified_len;
+    Py_END_CRITICAL_SECTION();
+    return stale ? binding_rescan(obj, b, node->op) : res;
+}
+
+// --- SHIELD OWNERSHIP ---
+// A private attribute may only be written by code the class itself defines, on the
+// object that code was called on. The code objects of a class's methods (and of its
+// bases) are registered once at class creation, together with the code nested in
+// them (closures, lambdas, comprehensions). An access check looks at the immediate
+// caller: a method must be the class's own and have the target as its first argument
+// (`self`, or `cls` for class attributes), so one instance cannot rebind another's
+// private state. Nested code defers to the frame that called it, which must pass the
+// same test. Functions attached to the class after creation are not owners.
+//
+// Ownership verdicts are memoized per code object in a small direct-mapped cache, so
+// a repeat write from the same method costs a pointer compare and a read of its first
+// fast local. Each entry is one word, the code pointer with the verdict in its low
+// bits, so concurrent writers on a free-threaded build can only replace an entry,
+// never tear it.
+
+#define OWNER_CACHE_SIZE 8
+#define OWNER_METHOD 0x1   // the code object is one of the class's own functions...
+#define OWNER_NESTED 0x2   // ...or was compiled inside one
+#define OWNER_BITS   ((uintptr_t)3)
+
+// (uintptr_t)code | verdict. The code object is borrowed: owners are pinned by
+// owner_codes, and a miss is only ever compared against.
+typedef uintptr_t OwnerVerdict;
+
+#define ATTR_PRIVATE 0x1   // single-underscore name: writes need ownership
+#define ATTR_DUNDER  0x2   // __dunder__ name: never access-checked
+
+// One slot of the per-class attribute table, keyed by interned attribute name.
+typedef struct {
+    PyObject *name;         // NULL marks an empty slot
+    Py_hash_t hash;
+    PyObject *rule;         // Rule or None
+    PyObject *expected;
+    int flags;
+    Py_ssize_t offset;      // member slot offset for slotted models, 0 for dict storage
+} ShieldAttr;
+
+// An open-addressed snapshot of __shield_rules__, never modified once published. A
+// class whose rules change drops its table and keeps the old one on its retired list
+// until the class itself goes away, so an assignment still validating against it
+// (suspended in Python code, or on another thread) never reads freed memory.
+typedef struct ShieldAttrTable {
+    struct ShieldAttrTable *retired;
+    size_t mask;
+    ShieldAttr slots[];
+} ShieldAttrTable;
+
+typedef struct {
+    PyHeapTypeObject ht;
+    PyObject *owner_codes;      // tuple of method code objects sorted by address
+    PyObject *nested_codes;     // tuple of code nested in those methods, sorted by address
+    OwnerVerdict verdicts[OWNER_CACHE_SIZE];
+    ShieldAttrTable *attrs;     // built on first use and after the class or its bases change
+    ShieldAttrTable *retired;   // superseded tables, freed with the class
+    PyObject *stats;            // StatsRecord, created on the first counted assignment
+} ShieldClassObject;
+
+static PyTypeObject ShieldMetaType;
+
+#define ShieldClass_Check(tp) PyObject_TypeCheck((PyObject *)(tp), &ShieldMetaType)
+
+static int owner_codes_contain(PyObject *owner_codes, PyObject *code) {
+    if (owner_codes == NULL) return 0;
+    Py_ssize_t lo = 0, hi = PyTuple_GET_SIZE(owner_codes);
+    while (lo < hi) {
+        Py_ssize_t mid = (lo + hi) / 2;
+        PyObject *item = PyTuple_GET_ITEM(owner_codes, mid);
+        if (item == code) return 1;
+        if ((uintptr_t)item < (uintptr_t)code) lo = mid + 1;
+        else hi = mid;
+    }
+    return 0;
+}
+
+// 0, OWNER_METHOD, or OWNER_METHOD | OWNER_NESTED for a code object.
+static int owner_verdict(ShieldClassObject *cls, PyObject *code) {
+    OwnerVerdict *slot = &cls->verdicts[((uintptr_t)code >> 4) % OWNER_CACHE_SIZE];
+    OwnerVerdict cached = FT_LOAD_UINTPTR(*slot);
+    if (likely((cached & ~OWNER_BITS) == (uintptr_t)code)) return (int)(cached & OWNER_BITS);
+
+    int verdict = owner_codes_contain(cls->owner_codes, code) ? OWNER_METHOD
+                : owner_codes_contain(cls->nested_codes, code) ? OWNER_METHOD | OWNER_NESTED : 0;
+    FT_STORE_UINTPTR(*slot, (uintptr_t)code | (uintptr_t)verdict);
+    return verdict;
+}
+
+// 1 if the frame's first argument is target. For a class attribute an instance or a
+// subclass of the class also counts, so `Account._total += 1` works from __init__.
+static int frame_receiver_is(PyFrameObject *frame, PyCodeObject *code, PyObject *target, int class_level) {
+    if (code->co_argcount == 0) return 0;
+    PyObject *name = PyTuple_GET_ITEM(code->co_localsplusnames, 0);
+#if PY_VERSION_HEX >= 0x030C0000
+    PyObject *receiver = PyFrame_GetVar(frame, name);  // the fast-local (or cell) slot, no mapping built
+#else
+    PyObject *locals = PyFrame_GetLocals(frame);
+    PyObject *receiver = locals != NULL ? PyObject_GetItem(locals, name) : NULL;
+    Py_XDECREF(locals);
+#endif
+    if (receiver == NULL) {
+        PyErr_Clear();  // rebound or deleted: not the receiver
+        return 0;
+    }
+    int res = receiver == target;
+    if (!res && class_level) {
+        res = PyType_Check(receiver) ? PyType_IsSubtype((PyTypeObject *)receiver, (PyTypeObject *)target)
+                                     : PyObject_TypeCheck(receiver, (PyTypeObject *)target);
+    }
+    Py_DECREF(receiver);
+    return res;
+}
+
+// May the running code write the private attributes of target (an instance of owner,
+// or owner itself when class_level is set)?
+static int check_internal_access(PyTypeObject *owner, PyObject *target, int class_level) {
+    if (!ShieldClass_Check(owner)) return 0;
+    ShieldClassObject *cls = (ShieldClassObject *)owner;
+
+    PyFrameObject *frame = PyEval_GetFrame();  // borrowed; the walk below holds its own references
+    Py_XINCREF(frame);
+    int allowed = 0;
+    while (frame != NULL) {
+        PyCodeObject *code = PyFrame_GetCode(frame);
+        Py_DECREF(code);  // still referenced by the executing frame
+        int verdict = owner_verdict(cls, (PyObject *)code);
+        if (!(verdict & OWNER_NESTED)) {
+            if (verdict) allowed = frame_receiver_is(frame, code, target, class_level);
+            break;
+        }
+        Py_SETREF(frame, PyFrame_GetBack(frame));
+    }
+    Py_XDECREF(frame);
+    return allowed;
+}
+
+static int compare_addresses(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)*(PyObject *const *)a, y = (uintptr_t)*(PyObject *const *)b;
+    return (x > y) - (x < y);
+}
+
+// A tuple of the code objects in codes, sorted by address for owner_codes_contain.
+static PyObject *sorted_codes(PyObject *codes) {
+    PyObject *sorted = PySequence_Tuple(codes);
+    if (sorted == NULL) return NULL;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(sorted); i++) {
+        if (!PyCode_Check(PyTuple_GET_ITEM(sorted, i))) {
+            PyErr_Format(PyExc_TypeError, "expected code objects, got %R", PyTuple_GET_ITEM(sorted, i));
+            Py_DECREF(sorted);
+            return NULL;
+        }
+    }
+    qsort(&PyTuple_GET_ITEM(sorted, 0), PyTuple_GET_SIZE(sorted), sizeof(PyObject *), compare_addresses);
+    return sorted;
+}
+
+// register_shield_owners(cls, methods, nested=()): records the code objects allowed to
+// write the private attributes of cls and its instances, and the code nested in them.
+static PyObject* register_shield_owners(PyObject *module, PyObject *args) {
+    PyObject *cls, *codes, *nested = EmptyTuple;
+    if (!PyArg_ParseTuple(args, "O!O|O", &ShieldMetaType, &cls, &codes, &nested)) return NULL;
+
+    PyObject *owner_codes = sorted_codes(codes);
+    PyObject *nested_codes = owner_codes != NULL ? sorted_codes(nested) : NULL;
+    if (nested_codes == NULL) {
+        Py_XDECREF(owner_codes);
+        return NULL;
+    }
+
+    // Called while the class is being created, before other threads can reach it
+    ShieldClassObject *shield_cls = (ShieldClassObject *)cls;
+    Py_XSETREF(shield_cls->owner_codes, owner_codes);
+    Py_XSETREF(shield_cls->nested_codes, nested_codes);
+    for (int i = 0; i < OWNER_CACHE_SIZE; i++) FT_STORE_UINTPTR(shield_cls->verdicts[i], 0);
+    Py_RETURN_NONE;
+}
+
+// --- SHIELD ATTRIBUTE TABLE ---
+
+static PyObject *str___shield_rules__;
+static PyObject *str___bases__;
+
+static int attr_name_flags(PyObject *name) {
+    Py_ssize_t len = PyUnicode_GET_LENGTH(name);
+    if (len == 0 || PyUnicode_READ_CHAR(name, 0) != '_') return 0;
+    if (len >= 4 && PyUnicode_READ_CHAR(name, 1) == '_'
+            && PyUnicode_READ_CHAR(name, len - 1) == '_' && PyUnicode_READ_CHAR(name, len - 2) == '_') {
+        return ATTR_DUNDER;
+    }
+    return ATTR_PRIVATE;
+}
+
+static void shield_table_free(ShieldAttrTable *table) {
+    for (size_t i = 0; i <= table->mask; i++) {
+        Py_XDECREF(table->slots[i].name);
+        Py_XDECREF(table->slots[i].rule);
+        Py_XDECREF(table->slots[i].expected);
+    }
+    PyMem_Free(table);
+}
+
+static void shield_table_retire(ShieldClassObject *cls, ShieldAttrTable *table) {
+    table->retired = FT_LOAD_PTR(cls->retired);
+    while (!FT_CAS_PTR(cls->retired, table->retired, table)) {}
+}
+
+// Frees the current and every retired table; only once no assignment can be running.
+static void shield_attrs_free(ShieldClassObject *cls) {
+    ShieldAttrTable *table = cls->attrs;
+    cls->attrs = NULL;
+    if (table != NULL) shield_table_free(table);
+    for (table = cls->retired, cls->retired = NULL; table != NULL;) {
+        ShieldAttrTable *next = table->retired;
+        shield_table_free(table);
+        table = next;
+    }
+}
+
+// Snapshots the class's __shield_rules__ into a new table and publishes it, unless
+// another thread published one first; returns the class's table, or NULL on error.
+static ShieldAttrTable *shield_attrs_build(ShieldClassObject *cls) {
+    PyObject *rules = PyDict_GetItemWithError(((PyTypeObject *)cls)->tp_dict, str___shield_rules__);
+    if (rules == NULL && PyErr_Occurred()) return NULL;
+    if (rules != NULL && !PyDict_Check(rules)) {
+        PyErr_Format(PyExc_TypeError, "__shield_rules__ must be a dict, got %R", rules);
+        return NULL;
+    }
+
+    // No rules: a single empty slot, so every lookup misses
+    size_t size = rules == NULL ? 1 : 8;
+    while (rules != NULL && size < (size_t)PyDict_GET_SIZE(rules) * 2) size <<= 1;
+    ShieldAttrTable *table = PyMem_Calloc(1, sizeof(ShieldAttrTable) + size * sizeof(ShieldAttr));
+    if (table == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    table->mask = size - 1;
+
+    PyObject *key, *rule_def;
+    Py_ssize_t pos = 0;
+    while (rules != NULL && PyDict_Next(rules, &pos, &key, &rule_def)) {
+        if (!PyUnicode_CheckExact(key) || !PyTuple_Check(rule_def) || PyTuple_GET_SIZE(rule_def) < 2) {
+            PyErr_Format(PyExc_TypeError, "malformed __shield_rules__ entry %R: %R", key, rule_def);
+            shield_table_free(table);
+            return NULL;
+        }
+        Py_hash_t hash = PyObject_Hash(key);
+        PyObject *rule = as_rule(PyTuple_GET_ITEM(rule_def, 0));
+        if (hash == -1 || rule == NULL) {
+            shield_table_free(table);
+            return NULL;
+        }
+        Py_INCREF(key);
+        PyUnicode_InternInPlace(&key);
+
+        size_t i = (size_t)hash & table->mask;
+        while (table->slots[i].name != NULL) i = (i + 1) & table->mask;
+        ShieldAttr *attr = &table->slots[i];
+        attr->name = key;
+        attr->hash = hash;
+        attr->rule = rule;
+        attr->expected = Py_NewRef(PyTuple_GET_ITEM(rule_def, 1));
+        attr->flags = attr_name_flags(key);
+        attr->offset = member_slot_offset(_PyType_Lookup((PyTypeObject *)cls, key));
+    }
+
+    ShieldAttrTable *current = NULL;
+    if (FT_CAS_PTR(cls->attrs, current, table)) return table;
+    shield_table_free(table);  // never published, so nobody else can hold it
+    return current;
+}
+
+static const ShieldAttr *shield_attrs_lookup(ShieldClassObject *cls, PyObject *name) {
+    ShieldAttrTable *table = FT_LOAD_PTR(cls->attrs);
+    if (unlikely(table == NULL) && (table = shield_attrs_build(cls)) == NULL) return NULL;
+    Py_hash_t hash = PyObject_Hash(name);  // cached on str objects
+    size_t i = (size_t)hash & table->mask;
+    for (;;) {
+        const ShieldAttr *attr = &table->slots[i];
+        if (attr->name == name) return attr;
+        if (attr->name == NULL) return NULL;
+        // Names built at runtime (setattr with a computed string) are not interned.
+        if (attr->hash == hash && PyUnicode_Compare(attr->name, name) == 0) return attr;
+        i = (i + 1) & table->mask;
+    }
+}
+
+// Drops the cached table of cls and of every class derived from it.
+static int shield_attrs_invalidate(PyObject *cls) {
+    if (ShieldClass_Check(cls)) {
+        ShieldClassObject *shield_cls = (ShieldClassObject *)cls;
+        ShieldAttrTable *table = FT_EXCHANGE_PTR(shield_cls->attrs, NULL);
+        if (table != NULL) shield_table_retire(shield_cls, table);
+    }
+    PyObject *subclasses = PyObject_CallMethod(cls, "__subclasses__", NULL);
+    if (subclasses == NULL) return -1;
+    for (Py_ssize_t i = 0; i < PyList_GET_SIZE(subclasses); i++) {
+        if (shield_attrs_invalidate(PyList_GET_ITEM(subclasses, i)) < 0) {
+            Py_DECREF(subclasses);
+            return -1;
+        }
+    }
+    Py_DECREF(subclasses);
+    return 0;
+}
+
+// ShieldBase subclasses created without ShieldMeta have no native table and keep
+// resolving __shield_rules__ through the type dict.
+static int shield_setattro_untabled(PyObject *self, PyObject *name, PyObject *value) {
+    if (attr_name_flags(name) & ATTR_PRIVATE) {
+        PyErr_Format(GuardianAccessError, "External access denied: Cannot modify protected/private attribute '%U'.", name);
+        return -1;
+    }
+    if (value != NULL) {
+        // Static types (a bare ShieldBase) keep no tp_dict on 3.12+ and carry no rules
+        PyTypeObject *tp = Py_TYPE(self);
+        PyObject *rules_dict = PyType_HasFeature(tp, Py_TPFLAGS_HEAPTYPE) ? PyDict_GetItemWithError(tp->tp_dict, str___shield_rules__) : NULL;
+        PyObject *rule_def = rules_dict && PyDict_Check(rules_dict) ? PyDict_GetItemWithError(rules_dict, name) : NULL;
+        if (rule_def) {
+            int ok = check_any_rule(value, PyTuple_GET_ITEM(rule_def, 0));
+            if (unlikely(ok <= 0)) {
+                if (ok == 0) raise_type_error(name, PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 0), value);
+                return -1;
+            }
+        } else if (PyErr_Occurred()) {
+            return -1;
+        }
+    }
+    return PyObject_GenericSetAttr(self, name, value);
+}
+
+static int shield_setattro(PyObject *self, PyObject *name, PyObject *value) {
+    PyTypeObject *type = Py_TYPE(self);
+    if (unlikely(!PyUnicode_CheckExact(name) || !ShieldClass_Check(type))) {
+        if (!PyUnicode_Check(name)) return PyObject_GenericSetAttr(self, name, value);
+        return shield_setattro_untabled(self, name, value);
+    }
+
+    ShieldClassObject *cls = (ShieldClassObject *)type;
+    const ShieldAttr *attr = shield_attrs_lookup(cls, name);
+    if (attr == NULL && PyErr_Occurred()) return -1;
+
+    int flags = attr ? attr->flags : attr_name_flags(name);
+    if (unlikely(flags & ATTR_PRIVATE)) {
+        if (!check_internal_access(type, self, 0)) {
+            PyErr_Format(GuardianAccessError, "External access denied: Cannot modify protected/private attribute '%U'.", name);
+            return -1;
+        }
+    }
+
+    if (attr != NULL) {
+        if (likely(value != NULL)) {
+            int ok = STATS_ON() ? counted_check(&cls->stats, "shield", (PyObject *)cls, NULL, value, attr->rule)
+                                : fast_check_type(value, attr->rule);
+            if (unlikely(ok <= 0)) {
+                if (ok == 0) raise_type_error(name, attr->expected, attr->rule, value);
+                return -1;
+            }
+        }
+        if (attr->offset) return slot_store(self, attr->offset, name, value);
+    }
+
+    return PyObject_GenericSetAttr(self, name, value);
+}
+
+
+static PyTypeObject ShieldBaseType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "guardian._guardian_core.ShieldBase",
+    .tp_basicsize = sizeof(PyObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_getattro = PyObject_GenericGetAttr,  // <--- BYPASS CUSTOM LOGIC ENTIRELY
+    .tp_setattro = shield_setattro,          // Keep the write protection
+    .tp_new = PyType_GenericNew,
+};
+
+// --- CORE OBJECTS ---
+// Checks a vectorcall's arguments against a compiled signature (shared by @guard and @deepguard).
+static int check_call_args(PyObject *pos_rules, PyObject *kw_rules, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    Py_ssize_t n_pos = PyTuple_GET_SIZE(pos_rules);
+    for (Py_ssize_t i = 0; i < nargs && i < n_pos; i++) {
+        PyObject *rule_def = PyTuple_GET_ITEM(pos_rules, i);
+        if (rule_def != Py_None) {
+            int ok = fast_check_type(args[i], PyTuple_GET_ITEM(rule_def, 2));
+            if (unlikely(ok <= 0)) {
+                if (ok == 0) raise_type_error(PyTuple_GET_ITEM(rule_def, 0), PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 2), args[i]);
+                return -1;
+            }
+        }
+    }
+
+    if (unlikely(kwnames != NULL)) {
+        Py_ssize_t nkwargs = PyTuple_GET_SIZE(kwnames);
+        for (Py_ssize_t i = 0; i < nkwargs; i++) {
+            PyObject *kw = PyTuple_GET_ITEM(kwnames, i);
+            PyObject *val = args[nargs + i];
+
+            PyObject *rule_def = PyDict_GetItemWithError(kw_rules, kw);
+            if (rule_def) {
+                int ok = fast_check_type(val, PyTuple_GET_ITEM(rule_def, 2));
+                if (unlikely(ok <= 0)) {
+                    if (ok == 0) raise_type_error(kw, PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 2), val);
+                    return -1;
+                }
+            } else if (PyErr_Occurred()) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Checks a guarded function's result; steals `result` and returns NULL on a mismatch.
+static PyObject *check_call_result(PyObject *ret_rule, PyObject *ret_name, int check_return, PyObject *result) {
+    if (result && check_return && ret_rule != Py_None) {
+        int ok = fast_check_type(result, ret_rule);
+        if (unlikely(ok <= 0)) {
+            if (ok == 0) raise_type_error(str_return, ret_name, ret_rule, result);
+            Py_DECREF(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+// A positional parameter flattened out of its (name, expected, rule) definition.
+// Every pointer is borrowed from the guard's pos_rules tuple.
+typedef struct {
+    PyObject *name;
+    PyObject *expected;
+    PyObject *rule;         // NULL: unannotated
+    PyTypeObject *exact;    // the rule is a lone OP_EXACT node: checked by type pointer
+} GuardSlot;
+
+// The flow_slots of a coroutine or generator guard
+#define FLOW_RETURN 0   // the awaited result, or the generator's return value
+#define FLOW_YIELD 1
+#define FLOW_SEND 2
+
+typedef struct {
+    PyObject_HEAD
+    vectorcallfunc vectorcall;
+    PyObject *func;
+    PyObject *pos_rules;
+    PyObject *kw_rules;
+    PyObject *ret_rule;
+    PyObject *ret_name;
+    int check_return;
+    PyObject *stats;        // StatsRecord, created on the first counted call
+    PyObject *compiler;     // lazy guards: signature compiler, cleared once compiled
+    // Call-path copy of the signature, built by guard_specialize
+    Py_ssize_t n_slots;
+    GuardSlot *slots;
+    Py_ssize_t n_kw;
+    PyObject **kw_table;    // n_kw interned names followed by their rule definitions
+    PyTypeObject *ret_exact;
+    // Coroutine and generator functions: the (yield, send) definitions, or NULL. The
+    // return, yield and send checks their wrappers run are flattened into flow_slots.
+    PyObject *flow;
+    GuardSlot flow_slots[3];
+} GuardObject;
+
+static void Guard_dealloc(GuardObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyMem_Free(self->slots);
+    Py_XDECREF(self->func);
+    Py_XDECREF(self->pos_rules);
+    Py_XDECREF(self->kw_rules);
+    Py_XDECREF(self->ret_rule);
+    Py_XDECREF(self->ret_name);
+    Py_XDECREF(self->stats);
+    Py_XDECREF(self->compiler);
+    Py_XDECREF(self->flow);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+// THE FIX: Descriptor Protocol binds the C-object to instances (injects `self` into args)
+static PyObject *Guard_descr_get(PyObject *self, PyObject *obj, PyObject *type) {
+    if (obj == NULL || obj == Py_None) {
+        Py_INCREF(self);
+        return self;
+    }
+    return PyMethod_New(self, obj);
+}
+
+static PyObject* Guard_getattro(PyObject *self, PyObject *name) {
+    PyObject *res = PyObject_GenericGetAttr(self, name);
+    if (res != NULL) return res;
+    PyErr_Clear();
+    return PyObject_GetAttr(((GuardObject*)self)->func, name);
+}
+
+// The lone OP_EXACT type a rule reduces to, or NULL.
+static PyTypeObject *rule_exact_type(PyObject *rule) {
+    if (rule == NULL || !Rule_Check(rule)) return NULL;
+    const RuleObject *r = (const RuleObject *)rule;
+    return r->n_nodes == 1 && r->nodes[0].op == OP_EXACT ? r->nodes[0].type : NULL;
+}
+
+// Keyword names are matched by pointer first: the parameter names come from the code
+// object and call sites pass interned literals, so the dict is only a fallback.
+static inline PyObject *guard_kw_lookup(const GuardObject *self, PyObject *kw) {
+    for (Py_ssize_t i = 0; i < self->n_kw; i++) {
+        if (self->kw_table[i] == kw) return self->kw_table[self->n_kw + i];
+    }
+    return PyDict_GetItemWithError(self->kw_rules, kw);
+}
+
+static int guard_check_args(const GuardObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+    Py_ssize_t n = nargs < self->n_slots ? nargs : self->n_slots;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        const GuardSlot *slot = &self->slots[i];
+        if (slot->rule == NULL || Py_TYPE(args[i]) == slot->exact) continue;
+        int ok = fast_check_type(args[i], slot->rule);
+        if (unlikely(ok <= 0)) {
+            if (ok == 0) raise_type_error(slot->name, slot->expected, slot->rule, args[i]);
+            return -1;
+        }
+    }
+
+    if (unlikely(kwnames != NULL)) {
+        Py_ssize_t nkwargs = PyTuple_GET_SIZE(kwnames);
+        for (Py_ssize_t i = 0; i < nkwargs; i++) {
+            PyObject *kw = PyTuple_GET_ITEM(kwnames, i);
+            PyObject *val = args[nargs + i];
+            PyObject *rule_def = guard_kw_lookup(self, kw);
+            if (rule_def) {
+                int ok = fast_check_type(val, PyTuple_GET_ITEM(rule_def, 2));
+                if (unlikely(ok <= 0)) {
+                    if (ok == 0) raise_type_error(kw, PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 2), val);
+                    return -1;
+                }
+            } else if (PyErr_Occurred()) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Wraps a coroutine or generator so its checks run as it is driven (defined below).
+static PyObject *guard_flow(const GuardObject *self, PyObject *result);
+
+static inline PyObject *guard_result(const GuardObject *self, PyObject *result) {
+    if (result == NULL || Py_TYPE(result) == self->ret_exact) return result;
+    if (unlikely(self->flow != NULL)) return guard_flow(self, result);
+    if (!self->check_return) return result;
+    return check_call_result(self->ret_rule, self->ret_name, self->check_return, result);
+}
+
+// Guard_vectorcall with statistics on: only the checks are timed, not the function body.
+static PyObject *Guard_vectorcall_counted(GuardObject *self, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    StatsRecordObject *record = stats_record(&self->stats, "guard", self->func, NULL);
+    StatsSpan span;
+    stats_span_begin(&span, record);
+    int ok = check_call_args(self->pos_rules, self->kw_rules, args, PyVectorcall_NARGS(nargsf), kwnames);
+    stats_span_end(&span);
+    PyObject *result = NULL;
+    if (ok == 0) {
+        result = PyObject_Vectorcall(self->func, args, nargsf, kwnames);
+        if (result != NULL) {
+            stats_span_begin(&span, record);
+            result = guard_result(self, result);
+            stats_span_end(&span);
+            ok = result == NULL ? -1 : 0;
+        }
+    }
+    if (record != NULL) {
+        FT_ADD_U64(record->calls, 1);
+        FT_ADD_U64(record->failures, ok < 0);
+    }
+    return result;
+}
+
+static PyObject *Guard_vectorcall(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    GuardObject *self = (GuardObject *)self_obj;
+    if (STATS_ON()) return Guard_vectorcall_counted(self, args, nargsf, kwnames);
+    if (guard_check_args(self, args, PyVectorcall_NARGS(nargsf), kwnames) < 0) return NULL;
+    return guard_result(self, PyObject_Vectorcall(self->func, args, nargsf, kwnames));
+}
+
+// Specialized entry points: a positional call whose arguments pass the inline test goes
+// straight to the function; anything else (keywords, a mismatch, statistics) takes the
+// generic path above, which also raises the error.
+
+// Every annotated positional parameter is an exact primitive (int, str, float, ...).
+static PyObject *Guard_vectorcall_exact(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    GuardObject *self = (GuardObject *)self_obj;
+    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+    if (unlikely(kwnames != NULL || STATS_ON())) return Guard_vectorcall(self_obj, args, nargsf, kwnames);
+    Py_ssize_t n = nargs < self->n_slots ? nargs : self->n_slots;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyTypeObject *exact = self->slots[i].exact;
+        if (unlikely(exact != NULL && Py_TYPE(args[i]) != exact)) return Guard_vectorcall(self_obj, args, nargsf, kwnames);
+    }
+    return guard_result(self, PyObject_Vectorcall(self->func, args, nargsf, NULL));
+}
+
+// A single annotated positional parameter with any rule.
+static PyObject *Guard_vectorcall_single(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    GuardObject *self = (GuardObject *)self_obj;
+    if (unlikely(kwnames != NULL || PyVectorcall_NARGS(nargsf) != 1 || STATS_ON())) {
+        return Guard_vectorcall(self_obj, args, nargsf, kwnames);
+    }
+    const GuardSlot *slot = &self->slots[0];
+    int ok = fast_check_type(args[0], slot->rule);
+    if (unlikely(ok <= 0)) {
+        // The full check already ran (a user __instancecheck__ may have raised): report it
+        // here rather than re-running it on the generic path.
+        if (ok == 0) raise_type_error(slot->name, slot->expected, slot->rule, args[0]);
+        return NULL;
+    }
+    return guard_result(self, PyObject_Vectorcall(self->func, args, nargsf, NULL));
+}
+
+static void guard_slot_fill(GuardSlot *slot, PyObject *name, PyObject *expected, PyObject *rule) {
+    if (rule == Py_None) return;
+    slot->name = name;
+    slot->expected = expected;
+    slot->rule = rule;
+    slot->exact = rule_exact_type(rule);
+}
+
+// Flattens the lowered signature into the guard's C arrays and picks its entry point.
+static int guard_specialize(GuardObject *self) {
+    Py_ssize_t n_slots = PyTuple_GET_SIZE(self->pos_rules), n_kw = PyDict_GET_SIZE(self->kw_rules);
+    char *block = PyMem_Calloc(1, n_slots * sizeof(GuardSlot) + 2 * n_kw * sizeof(PyObject *) + 1);
+    if (block == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    GuardSlot *slots = (GuardSlot *)block;
+    PyObject **kw_table = (PyObject **)(block + n_slots * sizeof(GuardSlot));
+
+    int all_exact = 1;
+    Py_ssize_t annotated = 0;
+    for (Py_ssize_t i = 0; i < n_slots; i++) {
+        PyObject *rule_def = PyTuple_GET_ITEM(self->pos_rules, i);
+        if (rule_def == Py_None || PyTuple_GET_ITEM(rule_def, 2) == Py_None) continue;
+        guard_slot_fill(&slots[i], PyTuple_GET_ITEM(rule_def, 0), PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 2));
+        all_exact &= slots[i].exact != NULL;
+        annotated++;
+    }
+    PyObject *key, *rule_def;
+    Py_ssize_t pos = 0, i = 0;
+    while (PyDict_Next(self->kw_rules, &pos, &key, &rule_def)) {
+        kw_table[i] = key;
+        kw_table[n_kw + i] = rule_def;
+        i++;
+    }
+
+    // A coroutine or generator result is never the value its return rule describes
+    memset(self->flow_slots, 0, sizeof(self->flow_slots));
+    if (self->flow != NULL) {
+        if (self->check_return) guard_slot_fill(&self->flow_slots[FLOW_RETURN], str_return, self->ret_name, self->ret_rule);
+        for (int role = FLOW_YIELD; role <= FLOW_SEND; role++) {
+            PyObject *rule_def = PyTuple_GET_ITEM(self->flow, role - FLOW_YIELD);
+            if (rule_def == Py_None) continue;
+            guard_slot_fill(&self->flow_slots[role], PyTuple_GET_ITEM(rule_def, 0), PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 2));
+        }
+    }
+
+    PyMem_Free(self->slots);
+    self->slots = slots;
+    self->n_slots = n_slots;
+    self->kw_table = kw_table;
+    self->n_kw = n_kw;
+    self->ret_exact = self->check_return && self->flow == NULL ? rule_exact_type(self->ret_rule) : NULL;
+    vectorcallfunc entry = all_exact ? Guard_vectorcall_exact
+                         : n_slots == 1 && annotated == 1 ? Guard_vectorcall_single : Guard_vectorcall;
+    FT_STORE_PTR(self->vectorcall, entry);  // after the tables it reads
+    return 0;
+}
+
+// Forward declarations: lower a compiled signature (defined with make_guard below).
+static int lower_signature(PyObject *pos_rules, PyObject *kw_rules, PyObject *ret_rule,
+                           PyObject **out_pos, PyObject **out_kw, PyObject **out_ret);
+static int lower_flow(PyObject *flow, PyObject **out_flow);
+
+// A lazy guard carries only its function and a compiler callback until the first call.
+// compiler(func) returns (pos_rules, kw_rules, ret_rule, ret_name, check_return); once the
+// signature is in place the guard swaps in its specialized entry point and never comes back here.
+static int guard_compile_signature(GuardObject *self) {
+    PyObject *compiler = Py_NewRef(self->compiler);  // may be cleared by a racing call
+    PyObject *spec = PyObject_CallOneArg(compiler, self->func);
+    Py_DECREF(compiler);
+    if (spec == NULL) return -1;
+    PyObject *pos_rules, *kw_rules, *ret_rule, *ret_name, *flow = Py_None;
+    int check_return;
+    if (!PyTuple_Check(spec) || !PyArg_ParseTuple(spec, "OOOOp|O", &pos_rules, &kw_rules, &ret_rule, &ret_name, &check_return, &flow)) {
+        if (!PyErr_Occurred()) PyErr_SetString(PyExc_TypeError, "guard compiler must return a 5- or 6-tuple");
+        Py_DECREF(spec);
+        return -1;
+    }
+    PyObject *lowered_pos, *lowered_kw, *lowered_ret, *lowered_flow = NULL;
+    int res = lower_signature(pos_rules, kw_rules, ret_rule, &lowered_pos, &lowered_kw, &lowered_ret);
+    if (res == 0 && (res = lower_flow(flow, &lowered_flow)) < 0) {
+        Py_DECREF(lowered_pos);
+        Py_DECREF(lowered_kw);
+        Py_DECREF(lowered_ret);
+    }
+    if (res == 0 && self->pos_rules != NULL) {
+        // Another thread compiled the signature while the compiler ran; keep the first
+        Py_DECREF(lowered_pos);
+        Py_DECREF(lowered_kw);
+        Py_DECREF(lowered_ret);
+        Py_XDECREF(lowered_flow);
+    } else if (res == 0) {
+        self->pos_rules = lowered_pos;
+        self->kw_rules = lowered_kw;
+        self->ret_rule = lowered_ret;
+        self->ret_name = Py_NewRef(ret_name);
+        self->check_return = check_return;
+        self->flow = lowered_flow;
+        res = guard_specialize(self);
+        if (res < 0) {
+            Py_CLEAR(self->pos_rules);
+            Py_CLEAR(self->kw_rules);
+            Py_CLEAR(self->ret_rule);
+            Py_CLEAR(self->ret_name);
+            Py_CLEAR(self->flow);
+        } else {
+            // Cleared last: a compiler of NULL is what marks the signature as ready
+            PyObject *done = self->compiler;
+            FT_STORE_PTR(self->compiler, NULL);
+            Py_DECREF(done);
+        }
+    }
+    Py_DECREF(spec);
+    return res;
+}
+
+// First calls racing on a free-threaded build take turns here. The critical section
+// is released while the compiler runs Python code that blocks, just as the GIL is,
+// so guard_compile_signature still allows for a call that finished in between.
+static int Guard_compile(GuardObject *self) {
+    int res = 0;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    if (self->compiler != NULL) res = guard_compile_signature(self);
+    Py_END_CRITICAL_SECTION();
+    return res;
+}
+
+static PyObject *Guard_vectorcall_lazy(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    GuardObject *self = (GuardObject *)self_obj;
+    if (FT_LOAD_PTR(self->compiler) != NULL && Guard_compile(self) < 0) return NULL;
+    return self->vectorcall(self_obj, args, nargsf, kwnames);
+}
+
+static PyMemberDef Guard_members[] = {
+    {"__vectorcalloffset__", T_PYSSIZET, offsetof(GuardObject, vectorcall), READONLY, NULL},
+    {NULL}
+};
+
+static PyType_Slot Guard_slots[] = {
+    {Py_tp_dealloc, Guard_dealloc},
+    {Py_tp_call, PyVectorcall_Call},
+    {Py_tp_getattro, Guard_getattro},
+    {Py_tp_descr_get, Guard_descr_get}, // Binds method accurately
+    {Py_tp_members, Guard_members},
+    {0, NULL}
+};
+
+static PyType_Spec Guard_spec = {
+    .name = "guardian._guardian_core.Guard",
+    .basicsize = sizeof(GuardObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_VECTORCALL | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = Guard_slots,
+};
+
+static PyTypeObject *GuardType;
+
+// --- COROUTINE AND GENERATOR GUARDS ---
+// A guarded `async def` or generator function hands back its native coroutine or generator
+// wrapped in one of the objects below. Each step is forwarded with PyIter_Send, which resumes
+// the wrapped frame directly, so awaiting through a guard adds no Python frame. Values are
+// checked as they cross the boundary: the awaited result (or the generator's return value)
+// against the return rule, every yielded value against the yield rule and every value passed
+// to send() against the send rule. next() sends None, so a None sent is never checked.
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *inner;        // the coroutine, generator or async generator, or one step of an async generator
+    GuardObject *guard;     // holds the flow_slots
+    int role;               // coroutines: the slot checked against the final value
+} FlowObject;
+
+static PyTypeObject *GuardedCoroutineType;
+static PyTypeObject *GuardedGeneratorType;
+static PyTypeObject *GuardedAsyncGeneratorType;
+
+static int flow_check(const FlowObject *self, int role, PyObject *value) {
+    const GuardSlot *slot = &self->guard->flow_slots[role];
+    if (slot->rule == NULL || Py_TYPE(value) == slot->exact) return 0;
+    int ok = fast_check_type(value, slot->rule);
+    if (likely(ok == 1)) return 0;
+    if (ok == 0) raise_type_error(slot->name, slot->expected, slot->rule, value);
+    return -1;
+}
+
+// Steals `inner`.
+static PyObject *flow_new(PyTypeObject *type, PyObject *inner, GuardObject *guard, int role) {
+    FlowObject *self = PyObject_GC_New(FlowObject, type);
+    if (self == NULL) {
+        Py_DECREF(inner);
+        return NULL;
+    }
+    self->inner = inner;
+    self->guard = (GuardObject *)Py_NewRef(guard);
+    self->role = role;
+    PyObject_GC_Track(self);
+    return (PyObject *)self;
+}
+
+// Anything but a native coroutine or generator (say, a future returned by a function marked
+// as a coroutine) is returned unchecked: the rules describe values it never exposes.
+static PyObject *guard_flow(const GuardObject *self, PyObject *result) {
+    PyTypeObject *type = PyCoro_CheckExact(result) ? GuardedCoroutineType
+                       : PyGen_CheckExact(result) ? GuardedGeneratorType
+                       : PyAsyncGen_CheckExact(result) ? GuardedAsyncGeneratorType : NULL;
+    if (type == NULL) return result;
+    return flow_new(type, result, (GuardObject *)self, FLOW_RETURN);
+}
+
+// Checks the outcome of one step: a yielded value (generators only; a coroutine yields to
+// its event loop) or the final value. A rejected value is dropped and becomes the error.
+static PySendResult flow_finish(FlowObject *self, PySendResult status, PyObject **result) {
+    int role = status == PYGEN_RETURN ? self->role
+             : status == PYGEN_NEXT && Py_IS_TYPE(self, GuardedGeneratorType) ? FLOW_YIELD : -1;
+    if (role < 0 || flow_check(self, role, *result) == 0) return status;
+    Py_CLEAR(*result);
+    return PYGEN_ERROR;
+}
+
+static PySendResult Flow_am_send(PyObject *self_obj, PyObject *arg, PyObject **result) {
+    FlowObject *self = (FlowObject *)self_obj;
+    // What an event loop sends into a coroutine is none of the guard's business
+    if (arg != Py_None && Py_IS_TYPE(self, GuardedGeneratorType) && flow_check(self, FLOW_SEND, arg) < 0) {
+        *result = NULL;
+        return PYGEN_ERROR;
+    }
+    return flow_finish(self, PyIter_Send(self->inner, arg, result), result);
+}
+
+// The Python face of a step: the yielded value, or StopIteration carrying the final one.
+static PyObject *flow_result(PySendResult status, PyObject *result) {
+    if (status != PYGEN_RETURN) return result;
+    if (result == Py_None) {
+        PyErr_SetNone(PyExc_StopIteration);
+    } else {
+        PyObject *stop = PyObject_CallOneArg(PyExc_StopIteration, result);
+        if (stop != NULL) {
+            PyErr_SetObject(PyExc_StopIteration, stop);
+            Py_DECREF(stop);
+        }
+    }
+    Py_DECREF(result);
+    return NULL;
+}
+
+static PyObject *Flow_iternext(PyObject *self) {
+    PyObject *result;
+    PySendResult status = Flow_am_send(self, Py_None, &result);
+    // An iterator may end without raising, which spares `await` a StopIteration for None
+    if (status == PYGEN_RETURN && result == Py_None) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    return flow_result(status, result);
+}
+
+static PyObject *Flow_send(PyObject *self, PyObject *arg) {
+    PyObject *result;
+    PySendResult status = Flow_am_send(self, arg, &result);
+    return flow_result(status, result);
+}
+
+// throw() has no send-style C API: the StopIteration of a frame that returns is unpacked here.
+static PyObject *Flow_throw(PyObject *self_obj, PyObject *args) {
+    FlowObject *self = (FlowObject *)self_obj;
+    PyObject *throw = PyObject_GetAttrString(self->inner, "throw");
+    if (throw == NULL) return NULL;
+    PyObject *result = PyObject_Call(throw, args, NULL);
+    Py_DECREF(throw);
+    PySendResult status = PYGEN_NEXT;
+    if (result == NULL) {
+        if (!PyErr_ExceptionMatches(PyExc_StopIteration)) return NULL;
+        PyObject *exc_type, *exc, *tb;
+        PyErr_Fetch(&exc_type, &exc, &tb);
+        PyErr_NormalizeException(&exc_type, &exc, &tb);
+        result = exc != NULL ? PyObject_GetAttrString(exc, "value") : Py_NewRef(Py_None);
+        Py_XDECREF(exc_type);
+        Py_XDECREF(exc);
+        Py_XDECREF(tb);
+        if (result == NULL) return NULL;
+        status = PYGEN_RETURN;
+    }
+    status = flow_finish(self, status, &result);
+    return flow_result(status, result);
+}
+
+static PyObject *Flow_close(PyObject *self, PyObject *Py_UNUSED(ignored)) {
+    return PyObject_CallMethod(((FlowObject *)self)->inner, "close", NULL);
+}
+
+static PyObject *Flow_getattro(PyObject *self, PyObject *name) {
+    PyObject *res = PyObject_GenericGetAttr(self, name);
+    if (res != NULL) return res;
+    PyErr_Clear();
+    return PyObject_GetAttr(((FlowObject *)self)->inner, name);
+}
+
+static int Flow_traverse(FlowObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->inner);
+    return 0;
+}
+
+static void Flow_dealloc(FlowObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    Py_XDECREF(self->inner);
+    Py_XDECREF(self->guard);
+    PyObject_GC_Del(self);
+    Py_DECREF(tp);
+}
+
+static PyMethodDef Flow_methods[] = {
+    {"send", Flow_send, METH_O, "Send a value into the guarded frame"},
+    {"throw", Flow_throw, METH_VARARGS, "Raise an exception in the guarded frame"},
+    {"close", Flow_close, METH_NOARGS, "Close the guarded frame"},
+    {NULL}
+};
+
+// Async generators: every __anext__/asend/athrow awaitable is wrapped in a GuardedCoroutine
+// whose final value, the item the generator yields, is checked against the yield rule.
+static PyObject *flow_step(FlowObject *self, PyObject *awaitable) {
+    if (awaitable == NULL) return NULL;
+    return flow_new(GuardedCoroutineType, awaitable, self->guard, FLOW_YIELD);
+}
+
+static PyObject *Flow_anext(PyObject *self_obj) {
+    FlowObject *self = (FlowObject *)self_obj;
+    return flow_step(self, Py_TYPE(self->inner)->tp_as_async->am_anext(self->inner));
+}
+
+static PyObject *Flow_asend(PyObject *self_obj, PyObject *arg) {
+    FlowObject *self = (FlowObject *)self_obj;
+    if (arg != Py_None && flow_check(self, FLOW_SEND, arg) < 0) return NULL;
+    return flow_step(self, PyObject_CallMethod(self->inner, "asend", "O", arg));
+}
+
+static PyObject *Flow_athrow(PyObject *self_obj, PyObject *args) {
+    FlowObject *self = (FlowObject *)self_obj;
+    PyObject *athrow = PyObject_GetAttrString(self->inner, "athrow");
+    if (athrow == NULL) return NULL;
+    PyObject *awaitable = PyObject_Call(athrow, args, NULL);
+    Py_DECREF(athrow);
+    return flow_step(self, awaitable);
+}
+
+static PyObject *Flow_aclose(PyObject *self, PyObject *Py_UNUSED(ignored)) {
+    return PyObject_CallMethod(((FlowObject *)self)->inner, "aclose", NULL);
+}
+
+static PyMethodDef FlowAsync_methods[] = {
+    {"asend", Flow_asend, METH_O, "Send a value into the guarded async generator"},
+    {"athrow", Flow_athrow, METH_VARARGS, "Raise an exception in the guarded async generator"},
+    {"aclose", Flow_aclose, METH_NOARGS, "Close the guarded async generator"},
+    {NULL}
+};
+
+static PyType_Slot GuardedCoroutine_slots[] = {
+    {Py_tp_dealloc, Flow_dealloc},
+    {Py_tp_traverse, Flow_traverse},
+    {Py_tp_getattro, Flow_getattro},
+    {Py_am_await, PyObject_SelfIter},
+    {Py_am_send, Flow_am_send},
+    {Py_tp_iternext, Flow_iternext},
+    {Py_tp_methods, Flow_methods},
+    {0, NULL}
+};
+
+static PyType_Slot GuardedGenerator_slots[] = {
+    {Py_tp_dealloc, Flow_dealloc},
+    {Py_tp_traverse, Flow_traverse},
+    {Py_tp_getattro, Flow_getattro},
+    {Py_am_send, Flow_am_send},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, Flow_iternext},
+    {Py_tp_methods, Flow_methods},
+    {0, NULL}
+};
+
+static PyType_Slot GuardedAsyncGenerator_slots[] = {
+    {Py_tp_dealloc, Flow_dealloc},
+    {Py_tp_traverse, Flow_traverse},
+    {Py_tp_getattro, Flow_getattro},
+    {Py_am_aiter, PyObject_SelfIter},
+    {Py_am_anext, Flow_anext},
+    {Py_tp_methods, FlowAsync_methods},
+    {0, NULL}
+};
+
+#define FLOW_TYPE_FLAGS \
+    (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION)
+
+static PyType_Spec GuardedCoroutine_spec = {
+    .name = "guardian._guardian_core.GuardedCoroutine",
+    .basicsize = sizeof(FlowObject),
+    .flags = FLOW_TYPE_FLAGS,
+    .slots = GuardedCoroutine_slots,
+};
+
+static PyType_Spec GuardedGenerator_spec = {
+    .name = "guardian._guardian_core.GuardedGenerator",
+    .basicsize = sizeof(FlowObject),
+    .flags = FLOW_TYPE_FLAGS,
+    .slots = GuardedGenerator_slots,
+};
+
+static PyType_Spec GuardedAsyncGenerator_spec = {
+    .name = "guardian._guardian_core.GuardedAsyncGenerator",
+    .basicsize = sizeof(FlowObject),
+    .flags = FLOW_TYPE_FLAGS,
+    .slots = GuardedAsyncGenerator_slots,
+};
+
+// --- DEEPGUARD ---
+// On 3.12+ deepguard checks annotated locals from a sys.monitoring PY_RETURN callback that
+// is enabled for the guarded code object only (guard_set.py claims the tool id). Other
+// code runs unmonitored. Older interpreters, or a process with no free tool id, fall back
+// to a profiler scoped to the guarded call that saves, forwards to and restores whatever
+// profiler was installed before.
+
+typedef struct {
+    PyObject_HEAD
+    vectorcallfunc vectorcall;
+    PyObject *func;
+    PyObject *func_code;
+    PyObject *pos_rules;
+    PyObject *kw_rules;
+    PyObject *ret_rule;
+    PyObject *ret_name;
+    PyObject *local_rules;  // tuple of (name, expected, rule), names taken from the code object
+    int check_return;
+    int monitored;          // locals are checked by the sys.monitoring hook, not a profiler
+    PyObject *stats;        // StatsRecord, created on the first counted call
+} StrictGuardObject;
+
+static PyObject *MonitoredCodes;    // code object -> local_rules of its deepguard
+
+// Checks every annotated local of a returning frame. `lookup` reads one variable
+// (new reference, or NULL with the error set when it is unbound).
+static int check_frame_locals(PyObject *local_rules, PyObject *(*lookup)(void *, PyObject *), void *source) {
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(local_rules); i++) {
+        PyObject *entry = PyTuple_GET_ITEM(local_rules, i);
+        PyObject *name = PyTuple_GET_ITEM(entry, 0);
+        PyObject *expected = PyTuple_GET_ITEM(entry, 1);
+        PyObject *val = lookup(source, name);
+        if (val == NULL) {
+            if (!PyErr_ExceptionMatches(PyExc_NameError) && !PyErr_ExceptionMatches(PyExc_KeyError)) return -1;
+            // STRICT ENFORCEMENT: The variable was declared but never initialized
+            PyErr_Clear();
+            PyObject *display = expected_display(expected);
+            if (display == NULL) return -1;
+            PyErr_Format(GuardianInitializationError,
+                         "Variable '%U' was declared as %U but was never initialized before return.", name, display);
+            Py_DECREF(display);
+            return -1;
+        }
+        int ok = fast_check_type(val, PyTuple_GET_ITEM(entry, 2));
+        if (unlikely(ok <= 0)) {
+            if (ok == 0) raise_type_error(name, expected, PyTuple_GET_ITEM(entry, 2), val);
+            Py_DECREF(val);
+            return -1;
+        }
+        Py_DECREF(val);
+    }
+    return 0;
+}
+
+static PyObject *lookup_mapping(void *locals, PyObject *name) {
+    // PyObject_GetItem respects the PEP 667 FrameLocalsProxy as well as plain dicts
+    return PyObject_GetItem((PyObject *)locals, name);
+}
+
+#if PY_VERSION_HEX >= 0x030C0000
+static PyObject *lookup_frame_var(void *frame, PyObject *name) {
+    // Reads the fast-local (or cell) slot directly; no locals mapping is materialized
+    return PyFrame_GetVar((PyFrameObject *)frame, name);
+}
+#endif
+
+// deepguard_on_return(code, instruction_offset, retval): the sys.monitoring PY_RETURN callback
+static PyObject *deepguard_on_return(PyObject *module, PyObject *const *args, Py_ssize_t nargs) {
+    if (nargs < 1) {
+        PyErr_SetString(PyExc_TypeError, "deepguard_on_return expects (code, instruction_offset, retval)");
+        return NULL;
+    }
+#if PY_VERSION_HEX >= 0x030C0000
+    // A strong reference: the check may run arbitrary code (e.g. ABC hooks), and another
+    // thread may drop the entry meanwhile
+    PyObject *local_rules;
+    int found = PyDict_GetItemRef(MonitoredCodes, args[0], &local_rules);
+    if (found <= 0) return found < 0 ? NULL : Py_NewRef(Py_None);
+    PyFrameObject *frame = PyEval_GetFrame();   // borrowed: the returning frame, callbacks push none
+    if (frame == NULL) {
+        Py_DECREF(local_rules);
+        Py_RETURN_NONE;
+    }
+    int res = check_frame_locals(local_rules, lookup_frame_var, frame);
+    Py_DECREF(local_rules);
+    if (res < 0) return NULL;
+#endif
+    Py_RETURN_NONE;
+}
+
+// Per-call profiler state for the fallback path: the guard, plus the profiler it displaced
+typedef struct {
+    PyObject_HEAD
+    StrictGuardObject *guard;
+    Py_tracefunc prev_func;
+    PyObject *prev_obj;
+} ProfileScopeObject;
+
+static void ProfileScope_dealloc(ProfileScopeObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    Py_XDECREF(self->guard);
+    Py_XDECREF(self->prev_obj);
+    PyObject_Free(self);
+    Py_DECREF(tp);
+}
+
+static PyType_Slot ProfileScope_slots[] = {
+    {Py_tp_dealloc, ProfileScope_dealloc},
+    {0, NULL}
+};
+
+static PyType_Spec ProfileScope_spec = {
+    .name = "guardian._guardian_core.ProfileScope",
+    .basicsize = sizeof(ProfileScopeObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = ProfileScope_slots,
+};
+
+static PyTypeObject *ProfileScopeType;
+
+static int strict_trace_func(PyObject *obj, PyFrameObject *frame, int what, PyObject *arg) {
+    ProfileScopeObject *scope = (ProfileScopeObject *)obj;
+
+    // Keep the displaced profiler (or an outer deepguard) seeing every event
+    if (scope->prev_func != NULL && scope->prev_func(scope->prev_obj, frame, what, arg) < 0) return -1;
+
+    // arg is NULL when the frame is unwinding with an exception: leave that exception alone
+    if (what != PyTrace_RETURN || arg == NULL) return 0;
+
+    StrictGuardObject *self = scope->guard;
+    PyCodeObject *f_code = PyFrame_GetCode(frame);
+    int is_target = ((PyObject *)f_code == self->func_code);
+    Py_XDECREF(f_code);
+
+    if (!is_target) return 0;
+
+    PyObject *locals = PyFrame_GetLocals(frame);
+    if (!locals) return -1;
+    int res = check_frame_locals(self->local_rules, lookup_mapping, locals);
+    Py_DECREF(locals);
+    return res;
+}
+
+static PyObject* StrictGuard_getattro(PyObject *self, PyObject *name) {
+    PyObject *res = PyObject_GenericGetAttr(self, name);
+    if (res != NULL) return res;
+    PyErr_Clear();
+    return PyObject_GetAttr(((StrictGuardObject*)self)->func, name);
+}
+
+// Runs the deepguard's function with its locals checked on return.
+static PyObject *strict_guard_invoke(StrictGuardObject *self, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    PyObject *result;
+    if (self->monitored) {
+        result = PyObject_Vectorcall(self->func, args, nargsf, kwnames);
+    } else {
+        PyThreadState *tstate = PyThreadState_Get();
+        ProfileScopeObject *scope = PyObject_New(ProfileScopeObject, ProfileScopeType);
+        if (scope == NULL) return NULL;
+        scope->guard = (StrictGuardObject *)Py_NewRef(self);
+        scope->prev_func = tstate->c_profilefunc;
+        scope->prev_obj = Py_XNewRef(tstate->c_profileobj);
+
+        PyEval_SetProfile(strict_trace_func, (PyObject *)scope);
+        result = PyObject_Vectorcall(self->func, args, nargsf, kwnames);
+
+        // Restore the displaced profiler without clobbering a pending exception
+        PyObject *exc_type, *exc, *tb;
+        PyErr_Fetch(&exc_type, &exc, &tb);
+        PyEval_SetProfile(scope->prev_func, scope->prev_obj);
+        PyErr_Restore(exc_type, exc, tb);
+        Py_DECREF(scope);
+    }
+    return result;
+}
+
+static PyObject *StrictGuard_vectorcall_counted(StrictGuardObject *self, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    StatsRecordObject *record = stats_record(&self->stats, "deepguard", self->func, NULL);
+    StatsSpan span;
+    stats_span_begin(&span, record);
+    int ok = check_call_args(self->pos_rules, self->kw_rules, args, PyVectorcall_NARGS(nargsf), kwnames);
+    stats_span_end(&span);
+    PyObject *result = NULL;
+    if (ok == 0) {
+        result = strict_guard_invoke(self, args, nargsf, kwnames);
+        if (result != NULL) {
+            stats_span_begin(&span, record);
+            result = check_call_result(self->ret_rule, self->ret_name, self->check_return, result);
+            stats_span_end(&span);
+        }
+        // A GuardianTypeError from the locals check counts as a rejection too
+        ok = result == NULL && PyErr_ExceptionMatches(GuardianTypeError) ? -1 : 0;
+    }
+    if (record != NULL) {
+        FT_ADD_U64(record->calls, 1);
+        FT_ADD_U64(record->failures, ok < 0);
+    }
+    return result;
+}
+
+static PyObject *StrictGuard_vectorcall(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    StrictGuardObject *self = (StrictGuardObject *)self_obj;
+    if (STATS_ON()) return StrictGuard_vectorcall_counted(self, args, nargsf, kwnames);
+    if (check_call_args(self->pos_rules, self->kw_rules, args, PyVectorcall_NARGS(nargsf), kwnames) < 0) return NULL;
+    PyObject *result = strict_guard_invoke(self, args, nargsf, kwnames);
+    return check_call_result(self->ret_rule, self->ret_name, self->check_return, result);
+}
+
+static void StrictGuard_dealloc(StrictGuardObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    if (self->monitored && self->func_code != NULL) {
+        // Stop checking the code object, unless a newer deepguard of the same function took it over
+        PyObject *exc_type, *exc, *tb;
+        PyErr_Fetch(&exc_type, &exc, &tb);
+        PyObject *current = PyDict_GetItemWithError(MonitoredCodes, self->func_code);
+        if (current == self->local_rules && PyDict_DelItem(MonitoredCodes, self->func_code) < 0) PyErr_Clear();
+        PyErr_Clear();
+        PyErr_Restore(exc_type, exc, tb);
+    }
+    Py_XDECREF(self->func);
     Py_XDECREF(self->func_code);
     Py_XDECREF(self->pos_rules);
     Py_XDECREF(self->kw_rules);
     Py_XDECREF(self->ret_rule);
     Py_XDECREF(self->ret_name);
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    Py_XDECREF(self->local_rules);
+    Py_XDECREF(self->stats);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyMemberDef StrictGuard_members[] = {
+    {"__vectorcalloffset__", T_PYSSIZET, offsetof(StrictGuardObject, vectorcall), READONLY, NULL},
+    {NULL}
+};
+
+static PyType_Slot StrictGuard_slots[] = {
+    {Py_tp_dealloc, StrictGuard_dealloc},
+    {Py_tp_call, PyVectorcall_Call},
+    {Py_tp_getattro, StrictGuard_getattro},
+    {Py_tp_descr_get, Guard_descr_get},
+    {Py_tp_members, StrictGuard_members},
+    {0, NULL}
+};
+
+static PyType_Spec StrictGuard_spec = {
+    .name = "guardian._guardian_core.StrictGuard",
+    .basicsize = sizeof(StrictGuardObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_VECTORCALL | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = StrictGuard_slots,
+};
+
+static PyTypeObject *StrictGuardType;
+
+// Lowers every rule in a compiled signature to a Rule program. Returns new references.
+static int lower_signature(PyObject *pos_rules, PyObject *kw_rules, PyObject *ret_rule,
+                           PyObject **out_pos, PyObject **out_kw, PyObject **out_ret) {
+    if (!PyTuple_Check(pos_rules) || !PyDict_Check(kw_rules)) {
+        PyErr_SetString(PyExc_TypeError, "pos_rules must be a tuple and kw_rules a dict");
+        return -1;
+    }
+    PyObject *pos = PyTuple_New(PyTuple_GET_SIZE(pos_rules));
+    PyObject *kw = PyDict_New();
+    PyObject *ret = NULL;
+    if (pos == NULL || kw == NULL) goto error;
+
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(pos_rules); i++) {
+        PyObject *rule_def = as_rule_def(PyTuple_GET_ITEM(pos_rules, i), 2);
+        if (rule_def == NULL) goto error;
+        PyTuple_SET_ITEM(pos, i, rule_def);
+    }
+
+    PyObject *key, *value;
+    Py_ssize_t p = 0;
+    while (PyDict_Next(kw_rules, &p, &key, &value)) {
+        PyObject *rule_def = as_rule_def(value, 2);
+        if (rule_def == NULL) goto error;
+        int res = PyDict_SetItem(kw, key, rule_def);
+        Py_DECREF(rule_def);
+        if (res < 0) goto error;
+    }
+
+    ret = as_rule(ret_rule);
+    if (ret == NULL) goto error;
+
+    *out_pos = pos;
+    *out_kw = kw;
+    *out_ret = ret;
+    return 0;
+
+error:
+    Py_XDECREF(pos);
+    Py_XDECREF(kw);
+    return -1;
+}
+
+// flow: None, or the (yield, send) definitions of a coroutine or generator function,
+// each a (name, expected, rule) tuple or None; ret_rule then checks the final value.
+static int lower_flow(PyObject *flow, PyObject **out_flow) {
+    *out_flow = NULL;
+    if (flow == Py_None) return 0;
+    if (!PyTuple_Check(flow) || PyTuple_GET_SIZE(flow) != 2) {
+        PyErr_Format(PyExc_TypeError, "malformed guardian flow definition %R", flow);
+        return -1;
+    }
+    PyObject *yield_def = as_rule_def(PyTuple_GET_ITEM(flow, 0), 2);
+    PyObject *send_def = yield_def ? as_rule_def(PyTuple_GET_ITEM(flow, 1), 2) : NULL;
+    if (send_def != NULL) *out_flow = PyTuple_Pack(2, yield_def, send_def);
+    Py_XDECREF(yield_def);
+    Py_XDECREF(send_def);
+    return *out_flow == NULL ? -1 : 0;
+}
+
+static PyObject* make_guard(PyObject *module, PyObject *args) {
+    PyObject *func, *pos_rules, *kw_rules, *ret_rule, *ret_name, *flow = Py_None;
+    int check_return;
+    if (!PyArg_ParseTuple(args, "OOOOOp|O", &func, &pos_rules, &kw_rules, &ret_rule, &ret_name, &check_return, &flow)) return NULL;
+
+    PyObject *lowered_pos, *lowered_kw, *lowered_ret, *lowered_flow;
+    if (lower_signature(pos_rules, kw_rules, ret_rule, &lowered_pos, &lowered_kw, &lowered_ret) < 0) return NULL;
+
+    GuardObject *guard = lower_flow(flow, &lowered_flow) < 0 ? NULL : PyObject_New(GuardObject, GuardType);
+    if (guard == NULL) {
+        Py_DECREF(lowered_pos);
+        Py_DECREF(lowered_kw);
+        Py_DECREF(lowered_ret);
+        Py_XDECREF(lowered_flow);
+        return NULL;
+    }
+    Py_INCREF(func); Py_INCREF(ret_name);
+    guard->vectorcall = Guard_vectorcall;
+    guard->func = func;
+    guard->pos_rules = lowered_pos;
+    guard->kw_rules = lowered_kw;
+    guard->ret_rule = lowered_ret;
+    guard->ret_name = ret_name;
+    guard->check_return = check_return;
+    guard->stats = NULL;
+    guard->compiler = NULL;
+    guard->slots = NULL;
+    guard->flow = lowered_flow;
+    if (guard_specialize(guard) < 0) {
+        Py_DECREF(guard);
+        return NULL;
+    }
+
+    return (PyObject *)guard;
+}
+
+// make_lazy_guard(func, compiler): a guard whose signature is compiled on its first call.
+static PyObject* make_lazy_guard(PyObject *module, PyObject *args) {
+    PyObject *func, *compiler;
+    if (!PyArg_ParseTuple(args, "OO", &func, &compiler)) return NULL;
+    GuardObject *guard = PyObject_New(GuardObject, GuardType);
+    if (guard == NULL) return NULL;
+    guard->vectorcall = Guard_vectorcall_lazy;
+    guard->func = Py_NewRef(func);
+    guard->pos_rules = NULL;
+    guard->kw_rules = NULL;
+    guard->ret_rule = NULL;
+    guard->ret_name = NULL;
+    guard->check_return = 0;
+    guard->stats = NULL;
+    guard->compiler = Py_NewRef(compiler);
+    guard->n_slots = guard->n_kw = 0;
+    guard->slots = NULL;
+    guard->kw_table = NULL;
+    guard->ret_exact = NULL;
+    guard->flow = NULL;
+    memset(guard->flow_slots, 0, sizeof(guard->flow_slots));
+    return (PyObject *)guard;
+}
+
+// Builds the (name, expected, rule) table checked when the guarded frame returns.
+// Names are swapped for the code object's own name strings so frame lookups match by identity.
+static PyObject *build_local_rules(PyObject *code, PyObject *kw_rules) {
+    PyObject *varnames = PyObject_GetAttrString(code, "co_varnames");
+    PyObject *cellvars = varnames ? PyObject_GetAttrString(code, "co_cellvars") : NULL;
+    PyObject *table = cellvars ? PyTuple_New(PyDict_GET_SIZE(kw_rules)) : NULL;
+    if (table == NULL) goto done;
+
+    PyObject *key, *rule_def;
+    Py_ssize_t pos = 0, i = 0;
+    while (PyDict_Next(kw_rules, &pos, &key, &rule_def)) {
+        PyObject *name = key;
+        PyObject *pools[2] = {varnames, cellvars};
+        for (int p = 0; p < 2 && name == key; p++) {
+            for (Py_ssize_t j = 0; j < PyTuple_GET_SIZE(pools[p]); j++) {
+                int eq = PyUnicode_Compare(PyTuple_GET_ITEM(pools[p], j), key);
+                if (eq == 0) {
+                    name = PyTuple_GET_ITEM(pools[p], j);
+                    break;
+                }
+                if (eq == -1 && PyErr_Occurred()) goto error;
+            }
+        }
+        PyObject *entry = PyTuple_Pack(3, name, PyTuple_GET_ITEM(rule_def, 1), PyTuple_GET_ITEM(rule_def, 2));
+        if (entry == NULL) goto error;
+        PyTuple_SET_ITEM(table, i++, entry);
+    }
+    goto done;
+
+error:
+    Py_CLEAR(table);
+done:
+    Py_XDECREF(varnames);
+    Py_XDECREF(cellvars);
+    return table;
+}
+
+static PyObject* make_strictguard(PyObject *module, PyObject *args) {
+    PyObject *func, *pos_rules, *kw_rules, *ret_rule, *ret_name;
+    int check_return, monitored = 0;
+    if (!PyArg_ParseTuple(args, "OOOOOp|p", &func, &pos_rules, &kw_rules, &ret_rule, &ret_name, &check_return, &monitored)) return NULL;
+#if PY_VERSION_HEX < 0x030C0000
+    if (monitored) {
+        PyErr_SetString(PyExc_RuntimeError, "sys.monitoring deepguard requires Python 3.12+");
+        return NULL;
+    }
+#endif
+
+    PyObject *func_code = PyObject_GetAttrString(func, "__code__");
+    if (func_code == NULL) return NULL;
+
+    PyObject *lowered_pos, *lowered_kw, *lowered_ret;
+    if (lower_signature(pos_rules, kw_rules, ret_rule, &lowered_pos, &lowered_kw, &lowered_ret) < 0) {
+        Py_DECREF(func_code);
+        return NULL;
+    }
+    PyObject *local_rules = build_local_rules(func_code, lowered_kw);
+    StrictGuardObject *guard = local_rules == NULL ? NULL : PyObject_New(StrictGuardObject, StrictGuardType);
+    if (guard == NULL) {
+        Py_DECREF(func_code);
+        Py_DECREF(lowered_pos);
+        Py_DECREF(lowered_kw);
+        Py_DECREF(lowered_ret);
+        Py_XDECREF(local_rules);
+        return NULL;
+    }
+    Py_INCREF(func); Py_INCREF(ret_name);
+    guard->vectorcall = StrictGuard_vectorcall;
+    guard->func = func;
+    guard->func_code = func_code;
+    guard->pos_rules = lowered_pos;
+    guard->kw_rules = lowered_kw;
+    guard->ret_rule = lowered_ret;
+    guard->ret_name = ret_name;
+    guard->local_rules = local_rules;
+    guard->check_return = check_return;
+    guard->monitored = 0;  // set once the code object is registered, so dealloc only undoes that
+    guard->stats = NULL;
+    if (monitored) {
+        if (PyDict_SetItem(MonitoredCodes, func_code, local_rules) < 0) {
+            Py_DECREF(guard);
+            return NULL;
+        }
+        guard->monitored = 1;
+    }
+
+    return (PyObject *)guard;
+}
+
+// --- C FIELD DESCRIPTOR FOR DATACLASSES ---
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *name;
+    PyObject *storage;          // private attribute name, or the member descriptor of a slot
+    PyObject *rule;
+    PyObject *expected_name;
+    PyObject *custom_validator;
+    PyObject *json_key;         // b'"name":', pre-encoded for dump_json
+    Py_ssize_t offset;          // slot offset when storage is a member descriptor, else 0
+    PyTypeObject *owner;        // borrowed from the member descriptor: the slot's class
+    PyObject *stats;            // StatsRecord, created on the first counted store
+} CFieldDescriptorObject;
+
+static void CFieldDescriptor_dealloc(CFieldDescriptorObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    Py_XDECREF(self->name);
+    Py_XDECREF(self->storage);
+    Py_XDECREF(self->rule);
+    Py_XDECREF(self->expected_name);
+    Py_XDECREF(self->custom_validator);
+    Py_XDECREF(self->json_key);
+    Py_XDECREF(self->stats);
+    PyObject_GC_Del(self);
+    Py_DECREF(tp);
+}
+
+static int CFieldDescriptor_traverse(CFieldDescriptorObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->storage);
+    Py_VISIT(self->rule);
+    Py_VISIT(self->custom_validator);
+    return 0;
+}
+
+// Slot access is only safe on instances laid out by the slot's class.
+static int CFieldDescriptor_check_owner(CFieldDescriptorObject *self, PyObject *obj) {
+    if (likely(PyObject_TypeCheck(obj, self->owner))) return 0;
+    PyErr_Format(PyExc_TypeError, "descriptor '%U' for '%s' objects doesn't apply to a '%s' object",
+                 self->name, self->owner->tp_name, Py_TYPE(obj)->tp_name);
+    return -1;
+}
+
+// Reads a field value (new reference). The caller guarantees obj is laid out for the field's storage.
+static PyObject *field_load(CFieldDescriptorObject *self, PyObject *obj) {
+    if (self->offset) {
+        PyObject *value = slot_load(obj, self->offset);
+        if (unlikely(value == NULL)) {
+            PyErr_Format(PyExc_AttributeError, "'%s' object has no attribute '%U'", Py_TYPE(obj)->tp_name, self->name);
+            return NULL;
+        }
+        return Py_NewRef(value);
+    }
+    return PyObject_GenericGetAttr(obj, self->storage);
+}
+
+static PyObject *CFieldDescriptor_descr_get(PyObject *self_obj, PyObject *obj, PyObject *type) {
+    CFieldDescriptorObject *self = (CFieldDescriptorObject *)self_obj;
+    if (obj == NULL || obj == Py_None) {
+        Py_INCREF(self);
+        return self_obj;
+    }
+    if (self->offset && CFieldDescriptor_check_owner(self, obj) < 0) return NULL;
+    return field_load(self, obj);
+}
+
+// Validates a field value and stores it. The caller guarantees obj is laid out for the field's storage.
+static int field_store(CFieldDescriptorObject *self, PyObject *obj, PyObject *value) {
+    // 1. Fast Path Validation using existing C logic
+    int ok = STATS_ON() ? counted_check(&self->stats, "field", (PyObject *)Py_TYPE(obj), self->name, value, self->rule)
+                        : fast_check_type(value, self->rule);
+    if (unlikely(ok <= 0)) {
+        if (ok == 0) raise_type_error(self->name, self->expected_name, self->rule, value);
+        return -1;
+    }
+
+    // 2. Custom Validator Hook (if provided by user)
+    PyObject *final_value = value;
+    if (self->custom_validator != Py_None) {
+        PyObject *cls = (PyObject *)Py_TYPE(obj);
+        PyObject *args = PyTuple_Pack(2, cls, value);
+        final_value = PyObject_CallObject(self->custom_validator, args);
+        Py_DECREF(args);
+        
+        if (final_value == NULL) return -1; // Exception raised inside custom validator
+    } else {
+        Py_INCREF(final_value);
+    }
+
+    // 3. Store into the fixed slot, or under the private name in the instance dict
+    int res = self->offset ? slot_store(obj, self->offset, self->name, final_value)
+                           : PyObject_GenericSetAttr(obj, self->storage, final_value);
+    Py_DECREF(final_value);
+    return res;
+}
+
+static int CFieldDescriptor_descr_set(PyObject *self_obj, PyObject *obj, PyObject *value) {
+    CFieldDescriptorObject *self = (CFieldDescriptorObject *)self_obj;
+
+    if (unlikely(value == NULL)) {
+        PyErr_Format(PyExc_AttributeError, "Cannot delete guarded dataclass attribute '%U'", self->name);
+        return -1;
+    }
+    if (self->offset && CFieldDescriptor_check_owner(self, obj) < 0) return -1;
+    return field_store(self, obj, value);
+}
+
+static PyMemberDef CFieldDescriptor_members[] = {
+    {"__name__", T_OBJECT, offsetof(CFieldDescriptorObject, name), READONLY, "Field name"},
+    {"storage", T_OBJECT, offsetof(CFieldDescriptorObject, storage), READONLY, "Private attribute name or slot descriptor holding the value"},
+    {NULL}
+};
+
+static PyType_Slot CFieldDescriptor_slots[] = {
+    {Py_tp_dealloc, CFieldDescriptor_dealloc},
+    {Py_tp_traverse, CFieldDescriptor_traverse},
+    {Py_tp_descr_get, CFieldDescriptor_descr_get},
+    {Py_tp_descr_set, CFieldDescriptor_descr_set},
+    {Py_tp_members, CFieldDescriptor_members},
+    {0, NULL}
+};
+
+static PyType_Spec CFieldDescriptor_spec = {
+    .name = "guardian._guardian_core.CFieldDescriptor",
+    .basicsize = sizeof(CFieldDescriptorObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = CFieldDescriptor_slots,
+};
+
+static PyTypeObject *CFieldDescriptorType;
+
+// Factory function to instantiate the descriptor from Python.
+// `storage` is either the private attribute name to store under, or the member
+// descriptor of a __slots__ entry whose slot should hold the value directly.
+static PyObject* make_c_descriptor(PyObject *module, PyObject *args) {
+    PyObject *name, *storage, *rule, *expected_name, *custom_val;
+    if (!PyArg_ParseTuple(args, "OOOOO", &name, &storage, &rule, &expected_name, &custom_val)) return NULL;
+
+    Py_ssize_t offset = 0;
+    if (!PyUnicode_Check(storage)) {
+        offset = member_slot_offset(storage);
+        if (offset == 0) {
+            PyErr_Format(PyExc_TypeError, "storage must be an attribute name or a writable slot descriptor, got %R", storage);
+            return NULL;
+        }
+    }
+
+    if (!PyUnicode_Check(name)) {
+        PyErr_Format(PyExc_TypeError, "field name must be a str, got %R", name);
+        return NULL;
+    }
+    const char *utf8_name = PyUnicode_AsUTF8(name);
+    if (utf8_name == NULL) return NULL;
+    PyObject *json_key = PyBytes_FromFormat("\"%s\":", utf8_name);  // field names are identifiers: no escaping
+    if (json_key == NULL) return NULL;
+
+    PyObject *lowered = as_rule(rule);
+    if (lowered == NULL) {
+        Py_DECREF(json_key);
+        return NULL;
+    }
+
+    CFieldDescriptorObject *desc = PyObject_GC_New(CFieldDescriptorObject, CFieldDescriptorType);
+    if (desc == NULL) {
+        Py_DECREF(lowered);
+        Py_DECREF(json_key);
+        return NULL;
+    }
+    
+    Py_INCREF(name); Py_INCREF(storage);
+    Py_INCREF(expected_name); Py_INCREF(custom_val);
+    
+    desc->name = name;
+    desc->storage = storage;
+    desc->rule = lowered;
+    desc->expected_name = expected_name;
+    desc->custom_validator = custom_val;
+    desc->json_key = json_key;
+    // Interned names hit CPython's type attribute cache on every dict-storage access
+    PyUnicode_InternInPlace(&desc->name);
+    if (offset == 0) PyUnicode_InternInPlace(&desc->storage);
+    desc->offset = offset;
+    desc->owner = offset ? PyDescr_TYPE(storage) : NULL;
+    desc->stats = NULL;
+    
+    PyObject_GC_Track(desc);
+    return (PyObject *)desc;
+}
+
+// --- DATACLASS CONSTRUCTORS ---
+// A per-class __init__ that binds positional and keyword arguments, applies defaults,
+// and validates and stores every field through its CFieldDescriptor in a single pass.
+// It is a method descriptor, so `Cls(...)` calls it unbound with self as args[0].
+
+#define INIT_FIELD_PARAM    0x1     // accepted as an __init__ parameter
+#define INIT_FIELD_KW_ONLY  0x2
+#define INIT_FIELD_DEFAULT  0x4     // `fallback` is the default value
+#define INIT_FIELD_FACTORY  0x8     // `fallback` is a default_factory
+
+#define INIT_STACK_PARAMS 16
+
+typedef struct {
+    CFieldDescriptorObject *field;
+    PyObject *fallback;     // default value or factory, NULL when the field is required
+    PyObject *shape;        // nested dataclass layout used by from_dict/from_json, or NULL
+    int flags;
+    Py_ssize_t param;       // index into the parameter list, -1 for init=False fields
+} InitField;
+
+typedef struct {
+    PyObject_HEAD
+    vectorcallfunc vectorcall;
+    PyObject *qualname;     // "<Class qualname>.__init__" for error messages
+    PyObject *signature;    // inspect.Signature of the equivalent stdlib __init__
+    int post_init;
+    int call_class;         // from_dict/from_json construct through cls(**kwargs) (InitVar or custom __init__)
+    Py_ssize_t n_fields;
+    Py_ssize_t n_params;
+    Py_ssize_t n_positional;
+    InitField *fields;      // declaration order, which is the assignment order
+    Py_ssize_t *params;     // parameter index -> field index
+} DataclassInitObject;
+
+static PyObject *str___post_init__;
+
+static void DataclassInit_dealloc(DataclassInitObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    for (Py_ssize_t i = 0; i < self->n_fields; i++) {
+        Py_XDECREF(self->fields[i].field);
+        Py_XDECREF(self->fields[i].fallback);
+        Py_XDECREF(self->fields[i].shape);
+    }
+    PyMem_Free(self->fields);
+    Py_XDECREF(self->qualname);
+    Py_XDECREF(self->signature);
+    PyObject_GC_Del(self);
+    Py_DECREF(tp);
+}
+
+static int DataclassInit_traverse(DataclassInitObject *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    for (Py_ssize_t i = 0; i < self->n_fields; i++) {
+        Py_VISIT(self->fields[i].field);
+        Py_VISIT(self->fields[i].fallback);
+        Py_VISIT(self->fields[i].shape);
+    }
+    Py_VISIT(self->signature);
+    return 0;
+}
+
+static Py_ssize_t init_param_index(DataclassInitObject *self, PyObject *kwname) {
+    for (Py_ssize_t j = 0; j < self->n_params; j++) {
+        if (self->fields[self->params[j]].field->name == kwname) return j;
+    }
+    // Keyword names built at runtime (e.g. **dict unpacking of computed keys) are not interned
+    for (Py_ssize_t j = 0; j < self->n_params; j++) {
+        int eq = PyUnicode_Compare(self->fields[self->params[j]].field->name, kwname);
+        if (eq == 0) return j;
+        if (eq == -1 && PyErr_Occurred()) return -2;
+    }
+    return -1;
+}
+
+// Mirrors CPython's "missing N required positional arguments: 'a' and 'b'" message.
+static void init_raise_missing(DataclassInitObject *self, PyObject **values, int kw_only) {
+    PyObject *names = PyList_New(0);
+    if (names == NULL) return;
+    for (Py_ssize_t j = 0; j < self->n_params; j++) {
+        const InitField *f = &self->fields[self->params[j]];
+        if (values[j] != NULL || (f->flags & (INIT_FIELD_DEFAULT | INIT_FIELD_FACTORY))) continue;
+        if (!(f->flags & INIT_FIELD_KW_ONLY) != !kw_only) continue;
+        PyObject *quoted = PyUnicode_FromFormat("'%U'", f->field->name);
+        if (quoted == NULL || PyList_Append(names, quoted) < 0) {
+            Py_XDECREF(quoted);
+            Py_DECREF(names);
+            return;
+        }
+        Py_DECREF(quoted);
+    }
+    Py_ssize_t n = PyList_GET_SIZE(names);
+    PyObject *joined = NULL;
+    if (n == 1) {
+        joined = Py_NewRef(PyList_GET_ITEM(names, 0));
+    } else if (n == 2) {
+        joined = PyUnicode_FromFormat("%U and %U", PyList_GET_ITEM(names, 0), PyList_GET_ITEM(names, 1));
+    } else if (n > 2) {
+        PyObject *head = PyList_GetSlice(names, 0, n - 1);
+        PyObject *sep = PyUnicode_FromString(", ");
+        PyObject *body = (head && sep) ? PyUnicode_Join(sep, head) : NULL;
+        if (body) joined = PyUnicode_FromFormat("%U, and %U", body, PyList_GET_ITEM(names, n - 1));
+        Py_XDECREF(head);
+        Py_XDECREF(sep);
+        Py_XDECREF(body);
+    }
+    if (joined != NULL) {
+        PyErr_Format(PyExc_TypeError, "%U() missing %zd required %s argument%s: %U", self->qualname, n,
+                     kw_only ? "keyword-only" : "positional", n == 1 ? "" : "s", joined);
+        Py_DECREF(joined);
+    }
+    Py_DECREF(names);
+}
+
+// Checks required parameters, then validates and stores every field in declaration order
+// and runs __post_init__. `values` holds borrowed bound arguments (NULL when unbound);
+// parameters before `first_unbound` are known to be bound. A field that fails validation
+// is reported through `failed` when given.
+static int init_apply(DataclassInitObject *self, PyObject *obj, PyObject **values, Py_ssize_t first_unbound,
+                      CFieldDescriptorObject **failed) {
+    for (Py_ssize_t j = first_unbound; j < self->n_params; j++) {
+        const InitField *f = &self->fields[self->params[j]];
+        if (unlikely(values[j] == NULL && !(f->flags & (INIT_FIELD_DEFAULT | INIT_FIELD_FACTORY)))) {
+            init_raise_missing(self, values, f->flags & INIT_FIELD_KW_ONLY);
+            return -1;
+        }
+    }
+
+    for (Py_ssize_t i = 0; i < self->n_fields; i++) {
+        const InitField *f = &self->fields[i];
+        PyObject *value = f->param >= 0 ? values[f->param] : NULL;
+        int res;
+        if (value != NULL) {
+            res = field_store(f->field, obj, value);
+        } else if (f->flags & INIT_FIELD_FACTORY) {
+            value = PyObject_CallNoArgs(f->fallback);
+            if (value == NULL) return -1;
+            res = field_store(f->field, obj, value);
+            Py_DECREF(value);
+        } else {
+            res = field_store(f->field, obj, f->fallback);
+        }
+        if (unlikely(res < 0)) {
+            if (failed != NULL) *failed = f->field;
+            return -1;
+        }
+    }
+
+    // Hand over to __post_init__, looked up per instance like the stdlib init does
+    if (self->post_init) {
+        PyObject *ret = PyObject_CallMethodNoArgs(obj, str___post_init__);
+        if (ret == NULL) return -1;
+        Py_DECREF(ret);
+    }
+    return 0;
+}
+
+static PyObject *DataclassInit_vectorcall(PyObject *self_obj, PyObject *const *args, size_t nargsf, PyObject *kwnames) {
+    DataclassInitObject *self = (DataclassInitObject *)self_obj;
+    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+    if (unlikely(nargs < 1)) {
+        PyErr_Format(PyExc_TypeError, "%U() missing required argument 'self'", self->qualname);
+        return NULL;
+    }
+    PyObject *obj = args[0];
+    args++;
+    nargs--;
+    if (unlikely(nargs > self->n_positional)) {
+        PyErr_Format(PyExc_TypeError, "%U() takes %zd positional arguments but %zd were given",
+                     self->qualname, self->n_positional + 1, nargs + 1);
+        return NULL;
+    }
+
+    // 1. Bind arguments to parameters (borrowed references)
+    PyObject *stack_values[INIT_STACK_PARAMS];
+    PyObject **values = stack_values;
+    if (self->n_params > INIT_STACK_PARAMS) {
+        values = PyMem_Malloc(self->n_params * sizeof(PyObject *));
+        if (values == NULL) return PyErr_NoMemory();
+    }
+    PyObject *result = NULL;
+    Py_ssize_t j;
+    for (j = 0; j < nargs; j++) values[j] = args[j];
+    for (; j < self->n_params; j++) values[j] = NULL;
+
+    Py_ssize_t n_kw = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    for (Py_ssize_t k = 0; k < n_kw; k++) {
+        PyObject *kwname = PyTuple_GET_ITEM(kwnames, k);
+        Py_ssize_t idx = init_param_index(self, kwname);
+        if (unlikely(idx < 0)) {
+            if (idx == -1) {
+                PyErr_Format(PyExc_TypeError, "%U() got an unexpected keyword argument '%U'", self->qualname, kwname);
+            }
+            goto done;
+        }
+        if (unlikely(values[idx] != NULL)) {
+            PyErr_Format(PyExc_TypeError, "%U() got multiple values for argument '%U'", self->qualname, kwname);
+            goto done;
+        }
+        values[idx] = args[nargs + k];
+    }
+
+    if (init_apply(self, obj, values, nargs, NULL) == 0) result = Py_NewRef(Py_None);
+
+done:
+    if (values != stack_values) PyMem_Free(values);
+    return result;
+}
+
+static PyObject *DataclassInit_descr_get(PyObject *self, PyObject *obj, PyObject *type) {
+    if (obj == NULL || obj == Py_None) return Py_NewRef(self);
+    return PyMethod_New(self, obj);
+}
+
+static PyObject *DataclassInit_get_qualname(DataclassInitObject *self, void *closure) {
+    return Py_NewRef(self->qualname);
+}
+
+static PyObject *DataclassInit_get_name(DataclassInitObject *self, void *closure) {
+    return PyUnicode_FromString("__init__");
+}
+
+static PyGetSetDef DataclassInit_getset[] = {
+    {"__name__", (getter)DataclassInit_get_name, NULL, NULL, NULL},
+    {"__qualname__", (getter)DataclassInit_get_qualname, NULL, NULL, NULL},
+    {NULL}
+};
+
+static PyMemberDef DataclassInit_members[] = {
+    {"__signature__", T_OBJECT, offsetof(DataclassInitObject, signature), READONLY, NULL},
+    {"__vectorcalloffset__", T_PYSSIZET, offsetof(DataclassInitObject, vectorcall), READONLY, NULL},
+    {NULL}
+};
+
+static PyType_Slot DataclassInit_slots[] = {
+    {Py_tp_dealloc, DataclassInit_dealloc},
+    {Py_tp_traverse, DataclassInit_traverse},
+    {Py_tp_call, PyVectorcall_Call},
+    {Py_tp_descr_get, DataclassInit_descr_get},
+    {Py_tp_getset, DataclassInit_getset},
+    {Py_tp_members, DataclassInit_members},
+    {0, NULL}
+};
+
+static PyType_Spec DataclassInit_spec = {
+    .name = "guardian._guardian_core.DataclassInit",
+    .basicsize = sizeof(DataclassInitObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_HAVE_VECTORCALL | Py_TPFLAGS_METHOD_DESCRIPTOR
+             | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = DataclassInit_slots,
+};
+
+static PyTypeObject *DataclassInitType;
+
+// make_dataclass_init(qualname, fields, post_init, signature, call_class)
+// fields: sequence of (descriptor, flags, fallback, shape) in declaration order, where shape
+// describes nested dataclasses for from_dict/from_json: None, a dataclass, (shape,) for a
+// list of shape, or (None, shape) for a dict with shape values.
+static PyObject *make_dataclass_init(PyObject *module, PyObject *args) {
+    PyObject *qualname, *fields, *signature;
+    int post_init, call_class;
+    if (!PyArg_ParseTuple(args, "UOpOp", &qualname, &fields, &post_init, &signature, &call_class)) return NULL;
+
+    PyObject *seq = PySequence_Fast(fields, "fields must be a sequence");
+    if (seq == NULL) return NULL;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+
+    DataclassInitObject *self = PyObject_GC_New(DataclassInitObject, DataclassInitType);
+    if (self == NULL) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+    self->vectorcall = DataclassInit_vectorcall;
+    self->qualname = PyUnicode_FromFormat("%U.__init__", qualname);
+    self->signature = Py_NewRef(signature);
+    self->post_init = post_init;
+    self->call_class = call_class;
+    self->n_fields = 0;
+    self->n_params = 0;
+    self->n_positional = 0;
+    // One allocation: the fields, then the parameter map
+    self->fields = PyMem_Calloc(1, n * (sizeof(InitField) + sizeof(Py_ssize_t)) + 1);
+    if (self->qualname == NULL || self->fields == NULL) {
+        if (self->fields == NULL) PyErr_NoMemory();
+        goto error;
+    }
+    self->params = (Py_ssize_t *)(self->fields + n);
+
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *field, *fallback, *shape;
+        int flags;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(seq, i), "O!iOO;field entries are (descriptor, flags, fallback, shape)",
+                              CFieldDescriptorType, &field, &flags, &fallback, &shape)) {
+            goto error;
+        }
+        if (!(flags & (INIT_FIELD_PARAM | INIT_FIELD_DEFAULT | INIT_FIELD_FACTORY))) {
+            PyErr_Format(PyExc_ValueError, "init=False field %R needs a default", field);
+            goto error;
+        }
+        InitField *f = &self->fields[self->n_fields++];
+        f->field = (CFieldDescriptorObject *)Py_NewRef(field);
+        f->fallback = (flags & (INIT_FIELD_DEFAULT | INIT_FIELD_FACTORY)) ? Py_NewRef(fallback) : NULL;
+        f->shape = shape != Py_None ? Py_NewRef(shape) : NULL;
+        f->flags = flags;
+        f->param = -1;
+        PyUnicode_InternInPlace(&f->field->name);
+    }
+
+    // Positional-or-keyword parameters come first, keyword-only ones after, as in the stdlib
+    for (int pass = 0; pass < 2; pass++) {
+        for (Py_ssize_t i = 0; i < self->n_fields; i++) {
+            InitField *f = &self->fields[i];
+            if (!(f->flags & INIT_FIELD_PARAM) || !(f->flags & INIT_FIELD_KW_ONLY) != !pass) continue;
+            f->param = self->n_params;
+            self->params[self->n_params++] = i;
+        }
+        if (pass == 0) self->n_positional = self->n_params;
+    }
+
+    Py_DECREF(seq);
+    PyObject_GC_Track(self);
+    return (PyObject *)self;
+
+error:
+    Py_DECREF(seq);
+    Py_DECREF(self);
+    return NULL;
+}
+
+// --- SERIALIZATION ---
+// Guardian dataclasses publish their CFieldDescriptors as `__guardian_fields__`, so dumping
+// reads each value straight from its slot or private key. Dataclasses guardian did not
+// decorate fall back to dataclasses.fields().
+
+static PyObject *str___guardian_fields__;
+static PyObject *str___guardian_serialize__;
+static PyObject *str___dataclass_fields__;
+static PyObject *str_name;
+static PyObject *DataclassesFields;     // dataclasses.fields
+
+// The field table declared on tp itself (borrowed). Undecorated subclasses do not inherit it.
+static PyObject *guardian_field_table(PyTypeObject *tp) {
+    if (!PyType_HasFeature(tp, Py_TPFLAGS_HEAPTYPE)) return NULL;
+    PyObject *table = PyDict_GetItemWithError(tp->tp_dict, str___guardian_fields__);
+    return (table != NULL && PyTuple_CheckExact(table)) ? table : NULL;
+}
+
+static inline int is_dataclass_instance(PyObject *obj) {
+    PyTypeObject *tp = Py_TYPE(obj);
+    return PyType_HasFeature(tp, Py_TPFLAGS_HEAPTYPE) && !PyType_Check(obj)
+           && _PyType_Lookup(tp, str___dataclass_fields__) != NULL;
+}
+
+// Iterates the fields of a dataclass instance: either the guardian table, or dataclasses.fields()
+typedef struct {
+    PyObject *obj;
+    PyObject *table;        // guardian table (borrowed) or tuple of dataclasses.Field (owned)
+    int native;
+    Py_ssize_t pos;
+} FieldIter;
+
+static int field_iter_init(FieldIter *it, PyObject *obj) {
+    it->obj = obj;
+    it->pos = 0;
+    it->table = guardian_field_table(Py_TYPE(obj));
+    it->native = it->table != NULL;
+    if (it->native) return 0;
+    if (PyErr_Occurred()) return -1;
+    it->table = PyObject_CallOneArg(DataclassesFields, obj);
+    if (it->table == NULL) return -1;
+    if (!PyTuple_Check(it->table)) {
+        PyErr_SetString(PyExc_TypeError, "dataclasses.fields() did not return a tuple");
+        Py_CLEAR(it->table);
+        return -1;
+    }
+    return 0;
+}
+
+// Yields the next field's descriptor (native only, borrowed), name (new ref) and value (new ref).
+// Returns 1 on a field, 0 at the end, -1 on error.
+static int field_iter_next(FieldIter *it, CFieldDescriptorObject **desc, PyObject **name, PyObject **value) {
+    if (it->pos >= PyTuple_GET_SIZE(it->table)) return 0;
+    PyObject *entry = PyTuple_GET_ITEM(it->table, it->pos++);
+    if (it->native) {
+        *desc = (CFieldDescriptorObject *)entry;
+        *name = Py_NewRef((*desc)->name);
+        *value = field_load(*desc, it->obj);
+    } else {
+        *desc = NULL;
+        *name = PyObject_GetAttr(entry, str_name);
+        *value = *name ? PyObject_GetAttr(it->obj, *name) : NULL;
+    }
+    if (*value == NULL) {
+        Py_CLEAR(*name);
+        return -1;
+    }
+    return 1;
+}
+
+static void field_iter_clear(FieldIter *it) {
+    if (!it->native) Py_XDECREF(it->table);
+}
+
+// include/exclude follow dump_dict: an empty include set means "everything"
+static int field_selected(PyObject *name, PyObject *include, PyObject *exclude) {
+    if (include != NULL) {
+        int in = PySequence_Contains(include, name);
+        if (in <= 0) return in;
+    }
+    if (exclude != NULL) {
+        int out = PySequence_Contains(exclude, name);
+        if (out != 0) return out < 0 ? -1 : 0;
+    }
+    return 1;
+}
+
+static PyObject *dump_value(PyObject *value);
+
+static PyObject *dump_dataclass(PyObject *obj, PyObject *include, PyObject *exclude, int recursive, PyObject *overrides) {
+    if (_PyType_Lookup(Py_TYPE(obj), str___guardian_serialize__) != NULL) {
+        return PyObject_CallMethodNoArgs(obj, str___guardian_serialize__);
+    }
+
+    FieldIter it;
+    if (field_iter_init(&it, obj) < 0) return NULL;
+    PyObject *result = PyDict_New();
+    if (result == NULL) goto error;
+
+    CFieldDescriptorObject *desc;
+    PyObject *name, *value;
+    int more;
+    while ((more = field_iter_next(&it, &desc, &name, &value)) > 0) {
+        int selected = field_selected(name, include, exclude);
+        PyObject *out = NULL;
+        if (selected > 0) {
+            PyObject *override = overrides ? PyDict_GetItemWithError(overrides, name) : NULL;
+            if (override != NULL) {
+                out = Py_NewRef(override);
+            } else if (!PyErr_Occurred()) {
+                out = recursive ? dump_value(value) : Py_NewRef(value);
+            }
+        }
+        int res = selected < 0 || (selected > 0 && (out == NULL || PyDict_SetItem(result, name, out) < 0)) ? -1 : 0;
+        Py_XDECREF(out);
+        Py_DECREF(name);
+        Py_DECREF(value);
+        if (res < 0) goto error;
+    }
+    if (more < 0) goto error;
+
+    // Overrides that are not (selected) fields are appended
+    if (overrides != NULL) {
+        PyObject *key, *val;
+        Py_ssize_t pos = 0;
+        while (PyDict_Next(overrides, &pos, &key, &val)) {
+            int has = PyDict_Contains(result, key);
+            if (has < 0 || (has == 0 && PyDict_SetItem(result, key, val) < 0)) goto error;
+        }
+    }
+    field_iter_clear(&it);
+    return result;
+
+error:
+    field_iter_clear(&it);
+    Py_XDECREF(result);
+    return NULL;
+}
+
+// Converts nested dataclasses inside lists, tuples and dict values. Containers holding
+// nothing to convert are returned as-is rather than copied.
+static PyObject *dump_value(PyObject *value) {
+    PyTypeObject *tp = Py_TYPE(value);
+    if (tp == &PyUnicode_Type || tp == &PyLong_Type || tp == &PyFloat_Type || tp == &PyBool_Type || value == Py_None) {
+        return Py_NewRef(value);
+    }
+    if (Py_EnterRecursiveCall(" while dumping a dataclass")) return NULL;
+    PyObject *result = NULL;
+
+    if (tp == &PyList_Type || tp == &PyTuple_Type) {
+        int is_list = tp == &PyList_Type;
+        PyObject *copy = NULL;   // list, created on the first converted item
+        Py_ssize_t i;
+        for (i = 0; i < Py_SIZE(value); i++) {
+            PyObject *item = is_list ? PyList_GET_ITEM(value, i) : PyTuple_GET_ITEM(value, i);
+            Py_INCREF(item);
+            PyObject *conv = dump_value(item);
+            Py_DECREF(item);
+            if (conv == NULL) goto container_error;
+            if (copy == NULL && conv != item) {
+                if (is_list) {
+                    copy = PyList_GetSlice(value, 0, i);
+                } else {
+                    PyObject *head = PyTuple_GetSlice(value, 0, i);
+                    copy = head ? PySequence_List(head) : NULL;
+                    Py_XDECREF(head);
+                }
+                if (copy == NULL) {
+                    Py_DECREF(conv);
+                    goto container_error;
+                }
+            }
+            int res = copy ? PyList_Append(copy, conv) : 0;
+            Py_DECREF(conv);
+            if (res < 0) goto container_error;
+        }
+        if (copy == NULL) {
+            result = Py_NewRef(value);
+        } else {
+            result = is_list ? Py_NewRef(copy) : PyList_AsTuple(copy);
+        }
+container_error:
+        Py_XDECREF(copy);
+    } else if (tp == &PyDict_Type) {
+        PyObject *copy = NULL;
+        PyObject *key, *item;
+        Py_ssize_t pos = 0;
+        while (PyDict_Next(value, &pos, &key, &item)) {
+            Py_INCREF(item);
+            PyObject *conv = dump_value(item);
+            Py_DECREF(item);
+            if (conv == NULL) goto dict_error;
+            if (conv != item) {
+                if (copy == NULL && (copy = PyDict_Copy(value)) == NULL) {
+                    Py_DECREF(conv);
+                    goto dict_error;
+                }
+                if (PyDict_SetItem(copy, key, conv) < 0) {
+                    Py_DECREF(conv);
+                    goto dict_error;
+                }
+            }
+            Py_DECREF(conv);
+        }
+        result = Py_NewRef(copy ? copy : value);
+dict_error:
+        Py_XDECREF(copy);
+    } else if (is_dataclass_instance(value)) {
+        result = dump_dataclass(value, NULL, NULL, 1, NULL);
+    } else {
+        result = Py_NewRef(value);
+    }
+    Py_LeaveRecursiveCall();
+    return result;
+}
+
+// Growable byte buffer for dump_json; starts in caller-provided stack storage
+typedef struct {
+    char *data;
+    Py_ssize_t len;
+    Py_ssize_t cap;
+    int heap;
+} ByteBuf;
+
+static int bytebuf_grow(ByteBuf *b, Py_ssize_t extra) {
+    Py_ssize_t cap = b->cap;
+    while (cap - b->len < extra) {
+        if (cap > PY_SSIZE_T_MAX / 2) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        cap *= 2;
+    }
+    char *data = b->heap ? PyMem_Realloc(b->data, cap) : PyMem_Malloc(cap);
+    if (data == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (!b->heap) memcpy(data, b->data, b->len);
+    b->data = data;
+    b->cap = cap;
+    b->heap = 1;
+    return 0;
+}
+
+static inline int bytebuf_write(ByteBuf *b, const char *src, Py_ssize_t n) {
+    if (unlikely(b->cap - b->len < n) && bytebuf_grow(b, n) < 0) return -1;
+    memcpy(b->data + b->len, src, n);
+    b->len += n;
+    return 0;
+}
+
+static inline int bytebuf_putc(ByteBuf *b, char c) {
+    if (unlikely(b->len == b->cap) && bytebuf_grow(b, 1) < 0) return -1;
+    b->data[b->len++] = c;
+    return 0;
+}
+
+static int json_write_str(ByteBuf *b, PyObject *str) {
+    Py_ssize_t n;
+    const char *s = PyUnicode_AsUTF8AndSize(str, &n);
+    if (s == NULL || bytebuf_putc(b, '"') < 0) return -1;
+    Py_ssize_t run = 0;   // start of the pending run of bytes that need no escaping
+    for (Py_ssize_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (likely(c >= 0x20 && c != '"' && c != '\\')) continue;
+        if (bytebuf_write(b, s + run, i - run) < 0) return -1;
+        char esc[7] = {'\\', 0};
+        Py_ssize_t esc_len = 2;
+        switch (c) {
+            case '"': esc[1] = '"'; break;
+            case '\\': esc[1] = '\\'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            case '\b': esc[1] = 'b'; break;
+            case '\f': esc[1] = 'f'; break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                esc_len = 6;
+        }
+        if (bytebuf_write(b, esc, esc_len) < 0) return -1;
+        run = i + 1;
+    }
+    if (bytebuf_write(b, s + run, n - run) < 0) return -1;
+    return bytebuf_putc(b, '"');
+}
+
+// Scalars: returns 1 if written, 0 if value is not a JSON scalar, -1 on error
+static int json_write_scalar(ByteBuf *b, PyObject *value) {
+    if (value == Py_None) return bytebuf_write(b, "null", 4) < 0 ? -1 : 1;
+    if (value == Py_True) return bytebuf_write(b, "true", 4) < 0 ? -1 : 1;
+    if (value == Py_False) return bytebuf_write(b, "false", 5) < 0 ? -1 : 1;
+    if (PyUnicode_Check(value)) return json_write_str(b, value) < 0 ? -1 : 1;
+    if (PyLong_Check(value)) {
+        int overflow;
+        long long v = PyLong_AsLongLongAndOverflow(value, &overflow);
+        if (v == -1 && PyErr_Occurred()) return -1;
+        if (!overflow) {
+            char digits[24];
+            int n = snprintf(digits, sizeof(digits), "%lld", v);
+            return bytebuf_write(b, digits, n) < 0 ? -1 : 1;
+        }
+        PyObject *text = PyLong_Type.tp_repr(value);
+        if (text == NULL) return -1;
+        Py_ssize_t n;
+        const char *s = PyUnicode_AsUTF8AndSize(text, &n);
+        int res = (s == NULL || bytebuf_write(b, s, n) < 0) ? -1 : 1;
+        Py_DECREF(text);
+        return res;
+    }
+    if (PyFloat_Check(value)) {
+        double d = PyFloat_AS_DOUBLE(value);
+        // Same spellings as json.dumps for non-finite values
+        if (Py_IS_NAN(d)) return bytebuf_write(b, "NaN", 3) < 0 ? -1 : 1;
+        if (Py_IS_INFINITY(d)) return (d > 0 ? bytebuf_write(b, "Infinity", 8) : bytebuf_write(b, "-Infinity", 9)) < 0 ? -1 : 1;
+        char *text = PyOS_double_to_string(d, 'r', 0, Py_DTSF_ADD_DOT_0, NULL);
+        if (text == NULL) return -1;
+        int res = bytebuf_write(b, text, strlen(text)) < 0 ? -1 : 1;
+        PyMem_Free(text);
+        return res;
+    }
+    return 0;
+}
+
+static int json_write_value(ByteBuf *b, PyObject *value);
+
+static int json_write_dataclass(ByteBuf *b, PyObject *obj, PyObject *include, PyObject *exclude) {
+    if (_PyType_Lookup(Py_TYPE(obj), str___guardian_serialize__) != NULL) {
+        PyObject *custom = PyObject_CallMethodNoArgs(obj, str___guardian_serialize__);
+        if (custom == NULL) return -1;
+        int res = json_write_value(b, custom);
+        Py_DECREF(custom);
+        return res;
+    }
+
+    FieldIter it;
+    if (field_iter_init(&it, obj) < 0) return -1;
+    int res = bytebuf_putc(b, '{');
+    int first = 1;
+    CFieldDescriptorObject *desc;
+    PyObject *name, *value;
+    int more = 0;
+    while (res == 0 && (more = field_iter_next(&it, &desc, &name, &value)) > 0) {
+        int selected = (include || exclude) ? field_selected(name, include, exclude) : 1;
+        if (selected < 0) {
+            res = -1;
+        } else if (selected > 0) {
+            if (!first) res = bytebuf_putc(b, ',');
+            first = 0;
+            if (res == 0) {
+                if (desc != NULL) {
+                    res = bytebuf_write(b, PyBytes_AS_STRING(desc->json_key), PyBytes_GET_SIZE(desc->json_key));
+                } else if ((res = json_write_str(b, name)) == 0) {
+                    res = bytebuf_putc(b, ':');
+                }
+            }
+            if (res == 0) res = json_write_value(b, value);
+        }
+        Py_DECREF(name);
+        Py_DECREF(value);
+    }
+    field_iter_clear(&it);
+    if (more < 0) return -1;
+    return res < 0 ? -1 : bytebuf_putc(b, '}');
+}
+
+static int json_write_value(ByteBuf *b, PyObject *value) {
+    int scalar = json_write_scalar(b, value);
+    if (scalar != 0) return scalar < 0 ? -1 : 0;
+
+    if (Py_EnterRecursiveCall(" while encoding a JSON object")) return -1;
+    int res = 0;
+    if (PyList_Check(value) || PyTuple_Check(value)) {
+        res = bytebuf_putc(b, '[');
+        for (Py_ssize_t i = 0; res == 0 && i < Py_SIZE(value); i++) {
+            PyObject *item = PyList_Check(value) ? PyList_GET_ITEM(value, i) : PyTuple_GET_ITEM(value, i);
+            if (i > 0) res = bytebuf_putc(b, ',');
+            Py_INCREF(item);
+            if (res == 0) res = json_write_value(b, item);
+            Py_DECREF(item);
+        }
+        if (res == 0) res = bytebuf_putc(b, ']');
+    } else if (PyDict_Check(value)) {
+        PyObject *key, *item;
+        Py_ssize_t pos = 0;
+        int first = 1;
+        res = bytebuf_putc(b, '{');
+        while (res == 0 && PyDict_Next(value, &pos, &key, &item)) {
+            if (!first) res = bytebuf_putc(b, ',');
+            first = 0;
+            if (res < 0) break;
+            if (PyUnicode_Check(key)) {
+                res = json_write_str(b, key);
+            } else if (PyLong_Check(key) || PyFloat_Check(key) || key == Py_None) {
+                // json.dumps coerces these keys to their JSON spelling
+                res = bytebuf_putc(b, '"');
+                if (res == 0) res = json_write_scalar(b, key) < 0 ? -1 : 0;
+                if (res == 0) res = bytebuf_putc(b, '"');
+            } else {
+                PyErr_Format(PyExc_TypeError, "keys must be str, int, float, bool or None, not %s", Py_TYPE(key)->tp_name);
+                res = -1;
+            }
+            if (res == 0) res = bytebuf_putc(b, ':');
+            Py_INCREF(item);
+            if (res == 0) res = json_write_value(b, item);
+            Py_DECREF(item);
+        }
+        if (res == 0) res = bytebuf_putc(b, '}');
+    } else if (is_dataclass_instance(value)) {
+        res = json_write_dataclass(b, value, NULL, NULL);
+    } else {
+        PyErr_Format(PyExc_TypeError, "Object of type %s is not JSON serializable", Py_TYPE(value)->tp_name);
+        res = -1;
+    }
+    Py_LeaveRecursiveCall();
+    return res;
+}
+
+// Treats None and empty collections as "no filter", like the Python dump_dict did
+static int optional_filter(PyObject **arg) {
+    if (*arg == Py_None) {
+        *arg = NULL;
+        return 0;
+    }
+    int truth = PyObject_IsTrue(*arg);
+    if (truth < 0) return -1;
+    if (!truth) *arg = NULL;
+    return 0;
+}
+
+static PyObject *dump_dict(PyObject *module, PyObject *args) {
+    PyObject *obj, *include, *exclude, *overrides;
+    int recursive;
+    if (!PyArg_ParseTuple(args, "OOOpO!", &obj, &include, &exclude, &recursive, &PyDict_Type, &overrides)) return NULL;
+    if (optional_filter(&include) < 0 || optional_filter(&exclude) < 0) return NULL;
+    return dump_dataclass(obj, include, exclude, recursive, PyDict_GET_SIZE(overrides) ? overrides : NULL);
+}
+
+static PyObject *dump_json(PyObject *module, PyObject *args) {
+    PyObject *obj, *include, *exclude;
+    if (!PyArg_ParseTuple(args, "OOO", &obj, &include, &exclude)) return NULL;
+    if (optional_filter(&include) < 0 || optional_filter(&exclude) < 0) return NULL;
+
+    char stack[512];
+    ByteBuf b = {stack, 0, sizeof(stack), 0};
+    int res = is_dataclass_instance(obj) ? json_write_dataclass(&b, obj, include, exclude) : json_write_value(&b, obj);
+    PyObject *result = res < 0 ? NULL : PyBytes_FromStringAndSize(b.data, b.len);
+    if (b.heap) PyMem_Free(b.data);
+    return result;
+}
+
+// --- DESERIALIZATION ---
+// from_dict / from_json build guardian dataclasses through the same plan as the native
+// __init__ (published as `__guardian_init__`). Field shapes say where nested dataclasses
+// sit, so nested payloads are constructed in the same traversal. from_json binds object
+// members straight to parameters without materializing a dict per dataclass.
+
+static PyObject *str___guardian_init__;
+static PyObject *str_path;
+
+static DataclassInitObject *guardian_init_plan(PyTypeObject *tp) {
+    if (!PyType_HasFeature(tp, Py_TPFLAGS_HEAPTYPE)) return NULL;
+    PyObject *plan = PyDict_GetItemWithError(tp->tp_dict, str___guardian_init__);
+    return (plan != NULL && Py_IS_TYPE(plan, DataclassInitType)) ? (DataclassInitObject *)plan : NULL;
+}
+
+static DataclassInitObject *require_init_plan(PyObject *cls) {
+    DataclassInitObject *plan = PyType_Check(cls) ? guardian_init_plan((PyTypeObject *)cls) : NULL;
+    if (plan == NULL && !PyErr_Occurred()) {
+        PyErr_Format(PyExc_TypeError, "expected a guardian dataclass, got %R", cls);
+    }
+    return plan;
+}
+
+// Records one path segment (innermost first) for the error being propagated
+static void path_note(PyObject **path, PyObject *segment) {
+    PyObject *exc_type, *exc, *tb;
+    PyErr_Fetch(&exc_type, &exc, &tb);
+    if (*path == NULL) *path = PyList_New(0);
+    if (*path == NULL || PyList_Append(*path, segment) < 0) PyErr_Clear();
+    PyErr_Restore(exc_type, exc, tb);
+}
+
+static void path_note_index(PyObject **path, Py_ssize_t i) {
+    PyObject *index = PyLong_FromSsize_t(i);
+    if (index == NULL) return;
+    path_note(path, index);
+    Py_DECREF(index);
+}
+
+// Locates the pending error in the ingested document. A structured GuardianTypeError
+// keeps its identity: the field segments are prepended to its `.path` and the message
+// stays lazy, ending in "at lines[1].sku". Any other error is re-raised as
+// "lines[1].sku: <message>" with the original as __cause__ and the segments on `.path`.
+static void raise_with_path(PyObject *path) {
+    if (path == NULL || PyList_GET_SIZE(path) == 0) return;
+    PyObject *exc_type, *exc, *tb;
+    PyErr_Fetch(&exc_type, &exc, &tb);
+    PyErr_NormalizeException(&exc_type, &exc, &tb);
+    if (tb != NULL) PyException_SetTraceback(exc, tb);
+
+    PyObject *segments = PyList_GetSlice(path, 0, PyList_GET_SIZE(path));
+    PyObject *location = NULL, *message = NULL, *replacement = NULL;
+    if (segments == NULL || PyList_Reverse(segments) < 0) goto fallback;
+    if (PyObject_TypeCheck(exc, GuardianTypeErrorType) && ((GuardianTypeErrorObject *)exc)->subject != NULL
+            && PyTuple_GET_SIZE(((GuardianTypeErrorObject *)exc)->base.args) == 0) {
+        GuardianTypeErrorObject *error = (GuardianTypeErrorObject *)exc;
+        PyObject *prefix = PyList_AsTuple(segments);
+        if (prefix != NULL && error->prefix != NULL) Py_SETREF(prefix, PySequence_Concat(prefix, error->prefix));
+        if (prefix == NULL) goto fallback;
+        Py_XSETREF(error->prefix, prefix);
+        Py_CLEAR(error->message);
+        Py_DECREF(segments);
+        PyErr_Restore(exc_type, exc, tb);
+        return;
+    }
+    location = field_location(segments);
+    if (location == NULL) goto fallback;
+    message = PyUnicode_FromFormat("%U: %S", location, exc);
+    if (message == NULL) goto fallback;
+    replacement = PyObject_CallOneArg(exc_type, message);
+    if (replacement == NULL || !PyExceptionInstance_Check(replacement)) goto fallback;
+
+    PyObject *path_tuple = PyList_AsTuple(segments);
+    if (path_tuple != NULL) {
+        if (PyObject_SetAttr(replacement, str_path, path_tuple) < 0) PyErr_Clear();
+        Py_DECREF(path_tuple);
+    }
+    PyException_SetCause(replacement, exc);     // steals exc
+    PyErr_SetObject(exc_type, replacement);
+    Py_DECREF(exc_type);
+    Py_XDECREF(tb);
+    Py_DECREF(replacement);
+    Py_DECREF(segments);
+    Py_DECREF(location);
+    Py_DECREF(message);
+    return;
+
+fallback:
+    // Exception types whose constructor does not take a message keep their original form
+    PyErr_Clear();
+    Py_XDECREF(replacement);
+    Py_XDECREF(message);
+    Py_XDECREF(location);
+    Py_XDECREF(segments);
+    PyErr_Restore(exc_type, exc, tb);
+}
+
+static PyObject *plan_construct(DataclassInitObject *plan, PyTypeObject *cls, PyObject **values, PyObject **path) {
+    PyObject *obj = cls->tp_new(cls, EmptyTuple, NULL);
+    if (obj == NULL) return NULL;
+    CFieldDescriptorObject *failed = NULL;
+    if (init_apply(plan, obj, values, 0, &failed) < 0) {
+        if (failed != NULL) path_note(path, failed->name);
+        Py_CLEAR(obj);
+    }
+    return obj;
 }
 
-static PyTypeObject StrictGuardType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "guardian._guardian_core.StrictGuard",
-    .tp_basicsize = sizeof(StrictGuardObject),
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_VECTORCALL,
-    .tp_dealloc = (destructor)StrictGuard_dealloc,
-    .tp_call = PyVectorcall_Call,
-    .tp_getattro = StrictGuard_getattro,
-    .tp_descr_get = Guard_descr_get,
-};
+static PyObject *coerce_dataclass(PyTypeObject *cls, PyObject *data, PyObject **path);
 
-static PyObject* make_guard(PyObject *module, PyObject *args) {
-    PyObject *func, *pos_rules, *kw_rules, *ret_rule, *ret_name;
-    int check_return;
-    if (!PyArg_ParseTuple(args, "OOOOOp", &func, &pos_rules, &kw_rules, &ret_rule, &ret_name, &check_return)) return NULL;
+// Converts a plain value to the nested layout `shape` describes; anything that does not
+// match the shape is passed through for the field rule to judge.
+static PyObject *coerce_shape(PyObject *shape, PyObject *value, PyObject **path) {
+    if (shape == NULL) return Py_NewRef(value);
+    if (PyType_Check(shape)) {
+        if (!PyDict_Check(value)) return Py_NewRef(value);
+        return coerce_dataclass((PyTypeObject *)shape, value, path);
+    }
+    if (Py_EnterRecursiveCall(" while building a dataclass")) return NULL;
+    PyObject *result = NULL;
+    if (PyTuple_GET_SIZE(shape) == 1 && PyList_Check(value)) {
+        PyObject *inner = PyTuple_GET_ITEM(shape, 0);
+        result = PyList_New(0);
+        for (Py_ssize_t i = 0; result != NULL && i < PyList_GET_SIZE(value); i++) {
+            PyObject *item = PyList_GET_ITEM(value, i);
+            Py_INCREF(item);
+            PyObject *conv = coerce_shape(inner, item, path);
+            Py_DECREF(item);
+            if (conv == NULL) path_note_index(path, i);
+            if (conv == NULL || PyList_Append(result, conv) < 0) Py_CLEAR(result);
+            Py_XDECREF(conv);
+        }
+    } else if (PyTuple_GET_SIZE(shape) == 2 && PyDict_Check(value)) {
+        PyObject *inner = PyTuple_GET_ITEM(shape, 1);
+        PyObject *key, *item;
+        Py_ssize_t pos = 0;
+        result = PyDict_New();
+        while (result != NULL && PyDict_Next(value, &pos, &key, &item)) {
+            Py_INCREF(item);
+            PyObject *conv = coerce_shape(inner, item, path);
+            Py_DECREF(item);
+            if (conv == NULL) path_note(path, key);
+            if (conv == NULL || PyDict_SetItem(result, key, conv) < 0) Py_CLEAR(result);
+            Py_XDECREF(conv);
+        }
+    } else {
+        result = Py_NewRef(value);
+    }
+    Py_LeaveRecursiveCall();
+    return result;
+}
 
-    GuardObject *guard = PyObject_New(GuardObject, &GuardType);
-    Py_INCREF(func); Py_INCREF(pos_rules); Py_INCREF(kw_rules); Py_INCREF(ret_rule); Py_INCREF(ret_name);
-    guard->vectorcall = Guard_vectorcall;
-    guard->func = func;
-    guard->pos_rules = pos_rules;
-    guard->kw_rules = kw_rules;
-    guard->ret_rule = ret_rule;
-    guard->ret_name = ret_name;
-    guard->check_return = check_return;
+static PyObject *coerce_dataclass(PyTypeObject *cls, PyObject *data, PyObject **path) {
+    DataclassInitObject *plan = require_init_plan((PyObject *)cls);
+    if (plan == NULL) return NULL;
+    if (Py_EnterRecursiveCall(" while building a dataclass")) return NULL;
 
-    return (PyObject *)guard;
-}
+    PyObject *result = NULL;
+    PyObject *kwargs = NULL;
+    PyObject *stack_values[INIT_STACK_PARAMS] = {NULL};
+    PyObject **values = stack_values;
+    if (plan->n_params > INIT_STACK_PARAMS) {
+        values = PyMem_Calloc(plan->n_params, sizeof(PyObject *));
+        if (values == NULL) {
+            PyErr_NoMemory();
+            values = stack_values;
+            goto done;
+        }
+    }
+    if (plan->call_class && (kwargs = PyDict_New()) == NULL) goto done;
 
-static PyObject* make_strictguard(PyObject *module, PyObject *args) {
-    PyObject *func, *pos_rules, *kw_rules, *ret_rule, *ret_name;
-    int check_return;
-    if (!PyArg_ParseTuple(args, "OOOOOp", &func, &pos_rules, &kw_rules, &ret_rule, &ret_name, &check_return)) return NULL;
+    PyObject *key, *item;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(data, &pos, &key, &item)) {
+        Py_ssize_t idx = PyUnicode_Check(key) ? init_param_index(plan, key) : -1;
+        if (idx == -2) goto done;
+        PyObject *shape = idx >= 0 ? plan->fields[plan->params[idx]].shape : NULL;
+        if (idx < 0 && !plan->call_class) {
+            PyErr_Format(PyExc_TypeError, "%U() got an unexpected field %R", plan->qualname, key);
+            goto done;
+        }
+        Py_INCREF(item);
+        PyObject *conv = coerce_shape(shape, item, path);
+        Py_DECREF(item);
+        if (conv == NULL) {
+            path_note(path, key);
+            goto done;
+        }
+        if (kwargs != NULL) {
+            int res = PyDict_SetItem(kwargs, key, conv);
+            Py_DECREF(conv);
+            if (res < 0) goto done;
+        } else {
+            Py_XSETREF(values[idx], conv);
+        }
+    }
 
-    StrictGuardObject *guard = PyObject_New(StrictGuardObject, &StrictGuardType);
-    Py_INCREF(func); Py_INCREF(pos_rules); Py_INCREF(kw_rules); Py_INCREF(ret_rule); Py_INCREF(ret_name);
-    guard->vectorcall = StrictGuard_vectorcall;
-    guard->func = func;
-    guard->func_code = PyObject_GetAttrString(func, "__code__");
-    guard->pos_rules = pos_rules;
-    guard->kw_rules = kw_rules;
-    guard->ret_rule = ret_rule;
-    guard->ret_name = ret_name;
-    guard->check_return = check_return;
+    if (kwargs != NULL) {
+        result = PyObject_Call((PyObject *)cls, EmptyTuple, kwargs);
+    } else {
+        result = plan_construct(plan, cls, values, path);
+    }
 
-    return (PyObject *)guard;
+done:
+    for (Py_ssize_t j = 0; j < (values == stack_values ? INIT_STACK_PARAMS : plan->n_params); j++) Py_XDECREF(values[j]);
+    if (values != stack_values) PyMem_Free(values);
+    Py_XDECREF(kwargs);
+    Py_LeaveRecursiveCall();
+    return result;
 }
 
-// --- C FIELD DESCRIPTOR FOR DATACLASSES ---
+static PyObject *from_dict(PyObject *module, PyObject *args) {
+    PyObject *cls, *data;
+    if (!PyArg_ParseTuple(args, "OO!", &cls, &PyDict_Type, &data)) return NULL;
+    if (require_init_plan(cls) == NULL) return NULL;
+    PyObject *path = NULL;
+    PyObject *result = coerce_dataclass((PyTypeObject *)cls, data, &path);
+    if (result == NULL) raise_with_path(path);
+    Py_XDECREF(path);
+    return result;
+}
 
 typedef struct {
-    PyObject_HEAD
-    PyObject *name;
-    PyObject *private_name;
-    PyObject *rule;
-    PyObject *expected_name;
-    PyObject *custom_validator;
-} CFieldDescriptorObject;
+    const char *start;
+    const char *pos;
+    const char *end;
+} JsonParser;
 
-static void CFieldDescriptor_dealloc(CFieldDescriptorObject *self) {
-    Py_XDECREF(self->name);
-    Py_XDECREF(self->private_name);
-    Py_XDECREF(self->rule);
-    Py_XDECREF(self->expected_name);
-    Py_XDECREF(self->custom_validator);
-    Py_TYPE(self)->tp_free((PyObject *)self);
+static inline void json_skip_ws(JsonParser *p) {
+    while (p->pos < p->end && (*p->pos == ' ' || *p->pos == '\n' || *p->pos == '\r' || *p->pos == '\t')) p->pos++;
 }
 
-static PyObject *CFieldDescriptor_descr_get(PyObject *self, PyObject *obj, PyObject *type) {
-    if (obj == NULL || obj == Py_None) {
-        Py_INCREF(self);
-        return self;
+static PyObject *json_error(JsonParser *p, const char *what) {
+    PyErr_Format(PyExc_ValueError, "Invalid JSON at byte %zd: %s", (Py_ssize_t)(p->pos - p->start), what);
+    return NULL;
+}
+
+static inline int json_expect(JsonParser *p, char c) {
+    json_skip_ws(p);
+    if (p->pos < p->end && *p->pos == c) {
+        p->pos++;
+        return 1;
     }
-    return PyObject_GenericGetAttr(obj, ((CFieldDescriptorObject *)self)->private_name);
+    return 0;
 }
 
-static int CFieldDescriptor_descr_set(PyObject *self_obj, PyObject *obj, PyObject *value) {
-    CFieldDescriptorObject *self = (CFieldDescriptorObject *)self_obj;
+static int json_hex4(const char *s, unsigned *out) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = s[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+    *out = v;
+    return 0;
+}
 
-    if (unlikely(value == NULL)) {
-        PyErr_Format(PyExc_AttributeError, "Cannot delete guarded dataclass attribute '%U'", self->name);
-        return -1;
+// Parses a string starting at the opening quote
+static PyObject *json_parse_string(JsonParser *p) {
+    const char *s = ++p->pos;
+    const char *q = s;
+    while (q < p->end && *q != '"' && *q != '\\' && (unsigned char)*q >= 0x20) q++;
+    if (q < p->end && *q == '"') {
+        p->pos = q + 1;
+        return PyUnicode_DecodeUTF8(s, q - s, "strict");
     }
 
-    // 1. Fast Path Validation using existing C logic
-    if (unlikely(!fast_check_type(value, self->rule))) {
-        raise_type_error(self->name, self->expected_name, value);
-        return -1;
+    // Escapes present: unescape into a scratch buffer
+    char stack[256];
+    ByteBuf b = {stack, 0, sizeof(stack), 0};
+    PyObject *result = NULL;
+    if (bytebuf_write(&b, s, q - s) < 0) goto done;
+    p->pos = q;
+    while (1) {
+        if (p->pos >= p->end) {
+            json_error(p, "unterminated string");
+            goto done;
+        }
+        unsigned char c = (unsigned char)*p->pos;
+        if (c == '"') {
+            p->pos++;
+            break;
+        }
+        if (c < 0x20) {
+            json_error(p, "invalid control character in string");
+            goto done;
+        }
+        if (c != '\\') {
+            if (bytebuf_putc(&b, (char)c) < 0) goto done;
+            p->pos++;
+            continue;
+        }
+        if (p->end - p->pos < 2) {
+            json_error(p, "unterminated string");
+            goto done;
+        }
+        char e = p->pos[1];
+        p->pos += 2;
+        char simple = 0;
+        switch (e) {
+            case '"': simple = '"'; break;
+            case '\\': simple = '\\'; break;
+            case '/': simple = '/'; break;
+            case 'b': simple = '\b'; break;
+            case 'f': simple = '\f'; break;
+            case 'n': simple = '\n'; break;
+            case 'r': simple = '\r'; break;
+            case 't': simple = '\t'; break;
+            case 'u': break;
+            default:
+                p->pos -= 2;
+                json_error(p, "invalid escape");
+                goto done;
+        }
+        if (simple) {
+            if (bytebuf_putc(&b, simple) < 0) goto done;
+            continue;
+        }
+        unsigned cp;
+        if (p->end - p->pos < 4 || json_hex4(p->pos, &cp) < 0) {
+            json_error(p, "invalid \\u escape");
+            goto done;
+        }
+        p->pos += 4;
+        unsigned low;
+        if (cp >= 0xD800 && cp <= 0xDBFF && p->end - p->pos >= 6 && p->pos[0] == '\\' && p->pos[1] == 'u'
+                && json_hex4(p->pos + 2, &low) == 0 && low >= 0xDC00 && low <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            p->pos += 6;
+        }
+        // Encode as UTF-8; lone surrogates survive through "surrogatepass", as in json.loads
+        char utf8[4];
+        int n;
+        if (cp < 0x80) { utf8[0] = (char)cp; n = 1; }
+        else if (cp < 0x800) { utf8[0] = (char)(0xC0 | (cp >> 6)); utf8[1] = (char)(0x80 | (cp & 0x3F)); n = 2; }
+        else if (cp < 0x10000) {
+            utf8[0] = (char)(0xE0 | (cp >> 12)); utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            utf8[2] = (char)(0x80 | (cp & 0x3F)); n = 3;
+        } else {
+            utf8[0] = (char)(0xF0 | (cp >> 18)); utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+            utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); utf8[3] = (char)(0x80 | (cp & 0x3F)); n = 4;
+        }
+        if (bytebuf_write(&b, utf8, n) < 0) goto done;
     }
+    result = PyUnicode_DecodeUTF8(b.data, b.len, "surrogatepass");
 
-    // 2. Custom Validator Hook (if provided by user)
-    PyObject *final_value = value;
-    if (self->custom_validator != Py_None) {
-        PyObject *cls = (PyObject *)Py_TYPE(obj);
-        PyObject *args = PyTuple_Pack(2, cls, value);
-        final_value = PyObject_CallObject(self->custom_validator, args);
-        Py_DECREF(args);
-        
-        if (final_value == NULL) return -1; // Exception raised inside custom validator
+done:
+    if (b.heap) PyMem_Free(b.data);
+    return result;
+}
+
+static PyObject *json_parse_number(JsonParser *p) {
+    const char *s = p->pos, *q = s;
+    int is_float = 0;
+    if (q < p->end && *q == '-') q++;
+    if (q < p->end && *q == '0') {
+        q++;
+    } else if (q < p->end && *q >= '1' && *q <= '9') {
+        while (q < p->end && *q >= '0' && *q <= '9') q++;
     } else {
-        Py_INCREF(final_value);
+        return json_error(p, "expecting value");
+    }
+    if (q < p->end && *q == '.' && q + 1 < p->end && q[1] >= '0' && q[1] <= '9') {
+        is_float = 1;
+        q++;
+        while (q < p->end && *q >= '0' && *q <= '9') q++;
     }
+    if (q < p->end && (*q == 'e' || *q == 'E')) {
+        const char *e = q + 1;
+        if (e < p->end && (*e == '+' || *e == '-')) e++;
+        if (e < p->end && *e >= '0' && *e <= '9') {
+            is_float = 1;
+            q = e;
+            while (q < p->end && *q >= '0' && *q <= '9') q++;
+        }
+    }
+    p->pos = q;
+    Py_ssize_t n = q - s;
 
-    // 3. Set the attribute bypasses Python dict lookup
-    int res = PyObject_GenericSetAttr(obj, self->private_name, final_value);
-    Py_DECREF(final_value);
+    if (!is_float && n <= 18) {
+        long long v = 0;
+        const char *d = s + (*s == '-');
+        for (; d < q; d++) v = v * 10 + (*d - '0');
+        return PyLong_FromLongLong(*s == '-' ? -v : v);
+    }
+    // Slow paths need a NUL-terminated copy
+    char stack[64];
+    char *text = n < (Py_ssize_t)sizeof(stack) ? stack : PyMem_Malloc(n + 1);
+    if (text == NULL) return PyErr_NoMemory();
+    memcpy(text, s, n);
+    text[n] = '\0';
+    PyObject *result;
+    if (is_float) {
+        double d = PyOS_string_to_double(text, NULL, NULL);
+        result = (d == -1.0 && PyErr_Occurred()) ? NULL : PyFloat_FromDouble(d);
+    } else {
+        result = PyLong_FromString(text, NULL, 10);
+    }
+    if (text != stack) PyMem_Free(text);
+    return result;
+}
+
+static inline int json_literal(JsonParser *p, const char *word, Py_ssize_t n) {
+    if (p->end - p->pos >= n && memcmp(p->pos, word, n) == 0) {
+        p->pos += n;
+        return 1;
+    }
+    return 0;
+}
+
+static PyObject *json_parse_value(JsonParser *p, PyObject *shape, PyObject **path);
+
+// Parses an object into a dataclass described by plan, binding members directly to parameters
+static PyObject *json_parse_dataclass(JsonParser *p, PyTypeObject *cls, PyObject **path) {
+    DataclassInitObject *plan = require_init_plan((PyObject *)cls);
+    if (plan == NULL) return NULL;
+
+    PyObject *result = NULL;
+    PyObject *kwargs = NULL;
+    PyObject *stack_values[INIT_STACK_PARAMS] = {NULL};
+    PyObject **values = stack_values;
+    if (plan->n_params > INIT_STACK_PARAMS) {
+        values = PyMem_Calloc(plan->n_params, sizeof(PyObject *));
+        if (values == NULL) {
+            PyErr_NoMemory();
+            values = stack_values;
+            goto done;
+        }
+    }
+    if (plan->call_class && (kwargs = PyDict_New()) == NULL) goto done;
+
+    p->pos++;  // '{'
+    if (json_expect(p, '}')) goto build;
+    while (1) {
+        json_skip_ws(p);
+        if (p->pos >= p->end || *p->pos != '"') {
+            json_error(p, "expecting property name enclosed in double quotes");
+            goto done;
+        }
+        // Fast match of the raw key against the pre-encoded field keys ('"name":')
+        Py_ssize_t idx = -1;
+        const char *key_end = p->pos + 1;
+        while (key_end < p->end && *key_end != '"' && *key_end != '\\') key_end++;
+        PyObject *key = NULL;
+        if (key_end < p->end && *key_end == '"' && !plan->call_class) {
+            Py_ssize_t raw_len = key_end + 1 - p->pos;
+            for (Py_ssize_t j = 0; j < plan->n_params; j++) {
+                PyObject *json_key = plan->fields[plan->params[j]].field->json_key;
+                if (PyBytes_GET_SIZE(json_key) - 1 == raw_len && memcmp(PyBytes_AS_STRING(json_key), p->pos, raw_len) == 0) {
+                    idx = j;
+                    key = Py_NewRef(plan->fields[plan->params[j]].field->name);
+                    p->pos = key_end + 1;
+                    break;
+                }
+            }
+        }
+        if (key == NULL) {
+            if ((key = json_parse_string(p)) == NULL) goto done;
+            idx = init_param_index(plan, key);
+            if (idx == -2) {
+                Py_DECREF(key);
+                goto done;
+            }
+            if (idx == -1 && !plan->call_class) {
+                PyErr_Format(PyExc_TypeError, "%U() got an unexpected field %R", plan->qualname, key);
+                Py_DECREF(key);
+                goto done;
+            }
+        }
+        if (!json_expect(p, ':')) {
+            Py_DECREF(key);
+            json_error(p, "expecting ':' delimiter");
+            goto done;
+        }
+        PyObject *value = json_parse_value(p, idx >= 0 ? plan->fields[plan->params[idx]].shape : NULL, path);
+        if (value == NULL) {
+            path_note(path, key);
+            Py_DECREF(key);
+            goto done;
+        }
+        if (kwargs != NULL) {
+            int res = PyDict_SetItem(kwargs, key, value);
+            Py_DECREF(value);
+            if (res < 0) {
+                Py_DECREF(key);
+                goto done;
+            }
+        } else {
+            Py_XSETREF(values[idx], value);   // duplicate keys: the last one wins, as in json.loads
+        }
+        Py_DECREF(key);
+        if (json_expect(p, ',')) continue;
+        if (json_expect(p, '}')) break;
+        json_error(p, "expecting ',' delimiter");
+        goto done;
+    }
+
+build:
+    if (kwargs != NULL) {
+        result = PyObject_Call((PyObject *)cls, EmptyTuple, kwargs);
+    } else {
+        result = plan_construct(plan, cls, values, path);
+    }
+
+done:
+    for (Py_ssize_t j = 0; j < (values == stack_values ? INIT_STACK_PARAMS : plan->n_params); j++) Py_XDECREF(values[j]);
+    if (values != stack_values) PyMem_Free(values);
+    Py_XDECREF(kwargs);
+    return result;
+}
+
+static PyObject *json_parse_value(JsonParser *p, PyObject *shape, PyObject **path) {
+    json_skip_ws(p);
+    if (p->pos >= p->end) return json_error(p, "expecting value");
+    char c = *p->pos;
+    if (c == '"') return json_parse_string(p);
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        if (json_literal(p, "-Infinity", 9)) return PyFloat_FromDouble(-Py_HUGE_VAL);
+        return json_parse_number(p);
+    }
+    if (json_literal(p, "null", 4)) return Py_NewRef(Py_None);
+    if (json_literal(p, "true", 4)) return Py_NewRef(Py_True);
+    if (json_literal(p, "false", 5)) return Py_NewRef(Py_False);
+    if (json_literal(p, "NaN", 3)) return PyFloat_FromDouble(Py_NAN);
+    if (json_literal(p, "Infinity", 8)) return PyFloat_FromDouble(Py_HUGE_VAL);
+    if (c != '[' && c != '{') return json_error(p, "expecting value");
+
+    if (Py_EnterRecursiveCall(" while decoding a JSON document")) return NULL;
+    PyObject *result = NULL;
+    if (c == '{' && shape != NULL && PyType_Check(shape)) {
+        result = json_parse_dataclass(p, (PyTypeObject *)shape, path);
+    } else if (c == '[') {
+        PyObject *inner = (shape != NULL && !PyType_Check(shape) && PyTuple_GET_SIZE(shape) == 1) ? PyTuple_GET_ITEM(shape, 0) : NULL;
+        p->pos++;
+        result = PyList_New(0);
+        if (result != NULL && !json_expect(p, ']')) {
+            while (1) {
+                PyObject *item = json_parse_value(p, inner, path);
+                if (item == NULL) path_note_index(path, PyList_GET_SIZE(result));
+                if (item == NULL || PyList_Append(result, item) < 0) {
+                    Py_XDECREF(item);
+                    Py_CLEAR(result);
+                    break;
+                }
+                Py_DECREF(item);
+                if (json_expect(p, ',')) continue;
+                if (json_expect(p, ']')) break;
+                json_error(p, "expecting ',' delimiter");
+                Py_CLEAR(result);
+                break;
+            }
+        }
+    } else {
+        PyObject *inner = (shape != NULL && !PyType_Check(shape) && PyTuple_GET_SIZE(shape) == 2) ? PyTuple_GET_ITEM(shape, 1) : NULL;
+        p->pos++;
+        result = PyDict_New();
+        if (result != NULL && !json_expect(p, '}')) {
+            while (1) {
+                json_skip_ws(p);
+                PyObject *key = (p->pos < p->end && *p->pos == '"') ? json_parse_string(p)
+                    : json_error(p, "expecting property name enclosed in double quotes");
+                if (key == NULL) {
+                    Py_CLEAR(result);
+                    break;
+                }
+                PyObject *item = NULL;
+                if (!json_expect(p, ':')) {
+                    json_error(p, "expecting ':' delimiter");
+                } else if ((item = json_parse_value(p, inner, path)) == NULL) {
+                    path_note(path, key);
+                }
+                int res = item ? PyDict_SetItem(result, key, item) : -1;
+                Py_DECREF(key);
+                Py_XDECREF(item);
+                if (res < 0) {
+                    Py_CLEAR(result);
+                    break;
+                }
+                if (json_expect(p, ',')) continue;
+                if (json_expect(p, '}')) break;
+                json_error(p, "expecting ',' delimiter");
+                Py_CLEAR(result);
+                break;
+            }
+        }
+    }
+    Py_LeaveRecursiveCall();
+    return result;
+}
+
+static PyObject *from_json(PyObject *module, PyObject *args) {
+    PyObject *cls, *data;
+    if (!PyArg_ParseTuple(args, "OO", &cls, &data)) return NULL;
+    if (require_init_plan(cls) == NULL) return NULL;
+
+    Py_buffer view = {NULL};
+    const char *text;
+    Py_ssize_t len;
+    if (PyUnicode_Check(data)) {
+        text = PyUnicode_AsUTF8AndSize(data, &len);
+        if (text == NULL) return NULL;
+    } else {
+        if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0) return NULL;
+        text = view.buf;
+        len = view.len;
+    }
+
+    JsonParser p = {text, text, text + len};
+    PyObject *path = NULL;
+    PyObject *result = NULL;
+    json_skip_ws(&p);
+    if (p.pos >= p.end || *p.pos != '{') {
+        json_error(&p, "expecting an object");
+    } else if ((result = json_parse_dataclass(&p, (PyTypeObject *)cls, &path)) != NULL) {
+        json_skip_ws(&p);
+        if (p.pos != p.end) {
+            json_error(&p, "extra data");
+            Py_CLEAR(result);
+        }
+    }
+    if (result == NULL) raise_with_path(path);
+    Py_XDECREF(path);
+    if (view.obj != NULL) PyBuffer_Release(&view);
+    return result;
+}
+
+// --- BULK VALIDATION ---
+// validate_many / validate_columns run compiled rules over a whole batch in one C
+// loop instead of one Python-level call per record. Work is column-major: each rule
+// walks its own column, so its inline caches stay hot, and a column whose rule is
+// headed by a single type skips runs of exact hits with the homogeneous scan kernel.
+
+// Clears ok[i] for every item of seq (a PySequence_Fast result of length n) that fails r.
+static int bulk_scan_column(const RuleObject *r, PyObject *seq, Py_ssize_t n, char *ok) {
+    const RuleNode *root = r->nodes;
+    if (root->op == OP_ANY) return 0;
+    int typed = (root->op == OP_EXACT || root->op == OP_INSTANCE) && root->type != NULL;
+    Py_ssize_t i = 0;
+    while (i < n) {
+        // A failing check may run Python code; the sequence must not change underneath us.
+        if (PySequence_Fast_GET_SIZE(seq) != n) {
+            PyErr_SetString(PyExc_RuntimeError, "sequence changed size during validation");
+            return -1;
+        }
+        PyObject **items = PySequence_Fast_ITEMS(seq);
+        if (typed) {
+            i += scan_exact_type(items + i, n - i, root->type);
+            if (i >= n) break;
+        }
+        PyObject *item = Py_NewRef(items[i]);
+        int res = check_node(r, root, item);
+        Py_DECREF(item);
+        if (res < 0) return -1;
+        if (res == 0) ok[i] = 0;
+        i++;
+    }
+    return 0;
+}
+
+// bulk_scan_column with the column locked against writers on other threads; a list
+// column is the caller's own list, not a copy.
+static int bulk_check_column(const RuleObject *r, PyObject *seq, Py_ssize_t n, char *ok) {
+    int res;
+    Py_BEGIN_CRITICAL_SECTION(seq);
+    res = bulk_scan_column(r, seq, n, ok);
+    Py_END_CRITICAL_SECTION();
     return res;
 }
 
-static PyTypeObject CFieldDescriptorType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "guardian._guardian_core.CFieldDescriptor",
-    .tp_basicsize = sizeof(CFieldDescriptorObject),
-    .tp_flags = Py_TPFLAGS_DEFAULT,
-    .tp_dealloc = (destructor)CFieldDescriptor_dealloc,
-    .tp_descr_get = CFieldDescriptor_descr_get,
-    .tp_descr_set = CFieldDescriptor_descr_set,
-};
+// Turns per-row verdicts into a list of bools, or the indices of the failing rows.
+static PyObject *bulk_result(const char *ok, Py_ssize_t n, int failures_only) {
+    if (!failures_only) {
+        PyObject *out = PyList_New(n);
+        if (out == NULL) return NULL;
+        for (Py_ssize_t i = 0; i < n; i++) PyList_SET_ITEM(out, i, Py_NewRef(ok[i] ? Py_True : Py_False));
+        return out;
+    }
+    PyObject *out = PyList_New(0);
+    for (Py_ssize_t i = 0; out != NULL && i < n; i++) {
+        if (ok[i]) continue;
+        PyObject *index = PyLong_FromSsize_t(i);
+        if (index == NULL || PyList_Append(out, index) < 0) Py_CLEAR(out);
+        Py_XDECREF(index);
+    }
+    return out;
+}
 
-// Factory function to instantiate the descriptor from Python
-static PyObject* make_c_descriptor(PyObject *module, PyObject *args) {
-    PyObject *name, *private_name, *rule, *expected_name, *custom_val;
-    if (!PyArg_ParseTuple(args, "OOOOO", &name, &private_name, &rule, &expected_name, &custom_val)) return NULL;
+static PyObject *validate_many(PyObject *module, PyObject *args) {
+    PyObject *rule, *values;
+    int failures_only;
+    if (!PyArg_ParseTuple(args, "O!Op", RuleType, &rule, &values, &failures_only)) return NULL;
+    PyObject *seq = PySequence_Fast(values, "validate_many() expects an iterable");
+    if (seq == NULL) return NULL;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    char *ok = PyMem_Malloc(n > 0 ? n : 1);
+    if (ok == NULL) {
+        Py_DECREF(seq);
+        return PyErr_NoMemory();
+    }
+    memset(ok, 1, n);
+    PyObject *result = bulk_check_column((const RuleObject *)rule, seq, n, ok) < 0 ? NULL : bulk_result(ok, n, failures_only);
+    PyMem_Free(ok);
+    Py_DECREF(seq);
+    return result;
+}
 
-    CFieldDescriptorObject *desc = PyObject_New(CFieldDescriptorObject, &CFieldDescriptorType);
-    
-    Py_INCREF(name); Py_INCREF(private_name); Py_INCREF(rule); 
-    Py_INCREF(expected_name); Py_INCREF(custom_val);
-    
-    desc->name = name;
-    desc->private_name = private_name;
-    desc->rule = rule;
-    desc->expected_name = expected_name;
-    desc->custom_validator = custom_val;
-    
-    return (PyObject *)desc;
+// validate_columns(names, rules, columns, failures_only): one rule per named column,
+// where every column is a sequence of the same length; a row passes if all its cells do.
+static PyObject *validate_columns(PyObject *module, PyObject *args) {
+    PyObject *names, *rules, *columns;
+    int failures_only;
+    if (!PyArg_ParseTuple(args, "O!O!O!p", &PyTuple_Type, &names, &PyTuple_Type, &rules, &PyTuple_Type, &columns,
+                          &failures_only)) return NULL;
+    Py_ssize_t n_cols = PyTuple_GET_SIZE(rules);
+    if (PyTuple_GET_SIZE(names) != n_cols || PyTuple_GET_SIZE(columns) != n_cols) {
+        PyErr_SetString(PyExc_ValueError, "validate_columns() needs one name, rule and column per column");
+        return NULL;
+    }
+    for (Py_ssize_t c = 0; c < n_cols; c++) {
+        if (!Rule_Check(PyTuple_GET_ITEM(rules, c))) {
+            PyErr_Format(PyExc_TypeError, "rule for column %R must be a Rule", PyTuple_GET_ITEM(names, c));
+            return NULL;
+        }
+    }
+
+    PyObject *seqs = PyTuple_New(n_cols);
+    if (seqs == NULL) return NULL;
+    Py_ssize_t n = -1;
+    for (Py_ssize_t c = 0; c < n_cols; c++) {
+        PyObject *seq = PySequence_Fast(PyTuple_GET_ITEM(columns, c), "columns must be iterables");
+        if (seq == NULL) {
+            Py_DECREF(seqs);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(seqs, c, seq);
+        if (n >= 0 && PySequence_Fast_GET_SIZE(seq) != n) {
+            PyErr_Format(PyExc_ValueError, "column %R has %zd rows, expected %zd",
+                         PyTuple_GET_ITEM(names, c), PySequence_Fast_GET_SIZE(seq), n);
+            Py_DECREF(seqs);
+            return NULL;
+        }
+        n = PySequence_Fast_GET_SIZE(seq);
+    }
+    if (n < 0) n = 0;
+
+    char *ok = PyMem_Malloc(n > 0 ? n : 1);
+    if (ok == NULL) {
+        Py_DECREF(seqs);
+        return PyErr_NoMemory();
+    }
+    memset(ok, 1, n);
+    PyObject *result = NULL;
+    Py_ssize_t c = 0;
+    for (; c < n_cols; c++) {
+        if (bulk_check_column((const RuleObject *)PyTuple_GET_ITEM(rules, c), PyTuple_GET_ITEM(seqs, c), n, ok) < 0) break;
+    }
+    if (c == n_cols) result = bulk_result(ok, n, failures_only);
+    PyMem_Free(ok);
+    Py_DECREF(seqs);
+    return result;
 }
 
 // --- CLASS-LEVEL METACLASS PROTECTION ---
@@ -583,81 +6742,343 @@ static PyObject* make_c_descriptor(PyObject *module, PyObject *args) {
 static int shield_meta_setattro(PyObject *cls, PyObject *name, PyObject *value) {
     if (unlikely(!PyUnicode_Check(name))) return PyType_Type.tp_setattro(cls, name, value);
 
-    const char *name_str = PyUnicode_AsUTF8(name);
+    // Standard dunders (like __module__ or __shield_rules__) are never access-checked
+    int flags = attr_name_flags(name);
+    if (unlikely(flags & ATTR_PRIVATE)) {
+        // Only code defined by the class itself may rebind its private attributes
+        if (!check_internal_access((PyTypeObject *)cls, cls, 1)) {
+            PyErr_Format(GuardianAccessError, "External access denied: Cannot modify protected/private class attribute '%U'.", name);
+            return -1;
+        }
+    }
+
+    // Delegate the actual assignment to Python's core type implementation
+    if (PyType_Type.tp_setattro(cls, name, value) < 0) return -1;
 
-    if (unlikely(name_str[0] == '_')) {
-        size_t len = strlen(name_str);
-        // Ignore standard dunders (like __module__ or __shield_rules__)
-        if (!(len >= 4 && name_str[1] == '_' && name_str[len-1] == '_' && name_str[len-2] == '_')) {
-            // Perform the C-level internal frame check against the class object itself
-            if (!check_internal_access(cls, name_str)) {
-                PyErr_Format(GuardianAccessError, "External access denied: Cannot modify protected/private class attribute '%s'.", name_str);
-                return -1;
+    // New rules, new bases, or a rebound field (which may replace its slot descriptor)
+    // invalidate the native attribute tables down the hierarchy
+    int stale = (flags & ATTR_DUNDER) && (PyUnicode_Compare(name, str___shield_rules__) == 0
+                                          || PyUnicode_Compare(name, str___bases__) == 0);
+    if (!stale && !(flags & ATTR_DUNDER)) {
+        const ShieldAttr *attr = shield_attrs_lookup((ShieldClassObject *)cls, name);
+        if (attr == NULL && PyErr_Occurred()) return -1;
+        stale = attr != NULL;
+    }
+    return stale ? shield_attrs_invalidate(cls) : 0;
+}
+
+static int shield_meta_traverse(ShieldClassObject *cls, visitproc visit, void *arg) {
+    Py_VISIT(cls->owner_codes);
+    Py_VISIT(cls->nested_codes);
+    for (int list = 0; list < 2; list++) {
+        // The current table's own retired link is NULL until it is superseded
+        for (ShieldAttrTable *table = list ? cls->retired : cls->attrs; table != NULL; table = table->retired) {
+            for (size_t i = 0; i <= table->mask; i++) {
+                Py_VISIT(table->slots[i].rule);
+                Py_VISIT(table->slots[i].expected);
             }
         }
     }
+    return PyType_Type.tp_traverse((PyObject *)cls, visit, arg);
+}
 
-    // Delegate the actual assignment to Python's core type implementation
-    return PyType_Type.tp_setattro(cls, name, value);
+static int shield_meta_clear(ShieldClassObject *cls) {
+    Py_CLEAR(cls->owner_codes);
+    Py_CLEAR(cls->nested_codes);
+    Py_CLEAR(cls->stats);
+    shield_attrs_free(cls);
+    return PyType_Type.tp_clear((PyObject *)cls);
+}
+
+static void shield_meta_dealloc(ShieldClassObject *cls) {
+    Py_CLEAR(cls->owner_codes);
+    Py_CLEAR(cls->nested_codes);
+    Py_CLEAR(cls->stats);
+    shield_attrs_free(cls);
+    PyType_Type.tp_dealloc((PyObject *)cls);
 }
 
 static PyTypeObject ShieldMetaType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     .tp_name = "guardian._guardian_core.ShieldMeta",
-    .tp_basicsize = sizeof(PyHeapTypeObject), // Required size for metaclasses in C
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_basicsize = sizeof(ShieldClassObject), // PyHeapTypeObject plus the per-class shield state
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+    .tp_dealloc = (destructor)shield_meta_dealloc,
+    .tp_traverse = (traverseproc)shield_meta_traverse,
+    .tp_clear = (inquiry)shield_meta_clear,
     .tp_setattro = shield_meta_setattro,      // Intercepts MyClass._var = 5
 };
 
 static PyMethodDef GuardianMethods[] = {
     {"make_guard", make_guard, METH_VARARGS, "Create a C-level guard wrapper"},
+    {"make_lazy_guard", make_lazy_guard, METH_VARARGS, "Create a Guard that compiles its signature on the first call"},
     {"make_strictguard", make_strictguard, METH_VARARGS, "Create a C-level strictguard wrapper"},
+    {"deepguard_on_return", (PyCFunction)(void(*)(void))deepguard_on_return, METH_FASTCALL, "sys.monitoring PY_RETURN callback checking deepguard locals"},
     {"make_c_descriptor", make_c_descriptor, METH_VARARGS, "Create a C-level dataclass descriptor"},
+    {"make_dataclass_init", make_dataclass_init, METH_VARARGS, "Create a native single-pass dataclass __init__"},
+    {"dump_dict", dump_dict, METH_VARARGS, "Serialize a dataclass to a dict, converting nested dataclasses"},
+    {"dump_json", dump_json, METH_VARARGS, "Serialize a dataclass (or JSON-compatible value) to compact JSON bytes"},
+    {"from_dict", from_dict, METH_VARARGS, "Build and validate a guardian dataclass from a dict"},
+    {"from_json", from_json, METH_VARARGS, "Parse JSON and build and validate a guardian dataclass in one pass"},
+    {"enable_stats", enable_stats, METH_O, "Turn the per-guard statistics counters on or off"},
+    {"stats_enabled", stats_enabled, METH_NOARGS, "Whether the statistics counters are on"},
+    {"set_max_depth", set_max_depth, METH_O, "Set how many times one check may re-enter a recursive alias; returns the old limit"},
+    {"max_depth", max_depth, METH_NOARGS, "How many times one check may re-enter a recursive alias"},
+    {"stats_snapshot", stats_snapshot, METH_O, "Snapshot the statistics records, optionally resetting them"},
+    {"validate_many", validate_many, METH_VARARGS, "Check every item of an iterable against a rule in one C loop"},
+    {"validate_columns", validate_columns, METH_VARARGS, "Check equal-length columns against per-column rules, row by row"},
+    {"register_shield_owners", register_shield_owners, METH_VARARGS, "Record the code objects that own a Shield class's private state"},
+    {"lower_rule", lower_rule, METH_O, "Lower a compiled (op, arg) rule tuple into a flat C rule program"},
     {NULL, NULL, 0, NULL}
 };
 
-static struct PyModuleDef guardianmodule = {
-    PyModuleDef_HEAD_INIT, "_guardian_core", "C core for guardian type enforcement", -1, GuardianMethods
+// --- C API ---
+// The function table behind guardian_capi.h, exported as the _C_API capsule. The
+// entry points are thin shims over the checker the core itself uses, so a decoder
+// validating records as it builds them pays what a @guard pays, minus the call.
+
+static PyObject *capi_compile(PyObject *hint) {
+    if (Rule_Check(hint)) return Py_NewRef(hint);
+    if (load_compiler() < 0) return NULL;
+    PyObject *kwargs = Py_BuildValue("{sO}", "exact_primitives", Py_True);
+    if (kwargs == NULL) return NULL;
+    PyObject *args = PyTuple_Pack(1, hint);
+    PyObject *rule = args ? PyObject_Call(CompileProgram, args, kwargs) : NULL;
+    Py_XDECREF(args);
+    Py_DECREF(kwargs);
+    if (rule != NULL && !Rule_Check(rule)) {
+        PyErr_Format(PyExc_TypeError, "compile_program() returned %R, not a Rule", rule);
+        Py_CLEAR(rule);
+    }
+    return rule;
+}
+
+// A @guard parameter by name (or "return"), compiling a lazy guard's signature first.
+static int capi_borrow_guard(GuardObject *guard, PyObject *name, PyObject **rule, PyObject **expected) {
+    if (FT_LOAD_PTR(guard->compiler) != NULL && Guard_compile(guard) < 0) return -1;
+    if (PyUnicode_Compare(name, str_return) == 0) {
+        *rule = guard->ret_rule;
+        *expected = guard->ret_name;
+        return 1;
+    }
+    if (PyErr_Occurred()) return -1;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(guard->pos_rules); i++) {
+        PyObject *rule_def = PyTuple_GET_ITEM(guard->pos_rules, i);
+        if (rule_def == Py_None || PyUnicode_Compare(PyTuple_GET_ITEM(rule_def, 0), name) != 0) continue;
+        *rule = PyTuple_GET_ITEM(rule_def, 2);
+        *expected = PyTuple_GET_ITEM(rule_def, 1);
+        return 1;
+    }
+    PyObject *rule_def = PyDict_GetItemWithError(guard->kw_rules, name);  // owned by the guard
+    if (rule_def == NULL) return PyErr_Occurred() ? -1 : 0;
+    *rule = PyTuple_GET_ITEM(rule_def, 2);
+    *expected = PyTuple_GET_ITEM(rule_def, 1);
+    return 1;
+}
+
+static int capi_borrow(PyObject *owner, PyObject *name, PyObject **rule, PyObject **expected) {
+    PyObject *ignored;
+    if (expected == NULL) expected = &ignored;
+    if (Rule_Check(owner)) {
+        *rule = *expected = owner;
+        return 1;
+    }
+    if (Py_IS_TYPE(owner, CFieldDescriptorType)) {
+        CFieldDescriptorObject *field = (CFieldDescriptorObject *)owner;
+        *rule = field->rule;
+        *expected = field->expected_name;
+        return 1;
+    }
+    if (name == NULL || !PyUnicode_Check(name)) {
+        PyErr_Format(PyExc_TypeError, "a rule of %R is looked up by attribute or parameter name", owner);
+        return -1;
+    }
+    if (Py_IS_TYPE(owner, GuardType)) return capi_borrow_guard((GuardObject *)owner, name, rule, expected);
+    if (PyType_Check(owner) && ShieldClass_Check(owner)) {
+        // Superseded attribute tables live as long as the class, so the borrow does too
+        const ShieldAttr *attr = shield_attrs_lookup((ShieldClassObject *)owner, name);
+        if (attr == NULL) return PyErr_Occurred() ? -1 : 0;
+        *rule = attr->rule;
+        *expected = attr->expected;
+        return 1;
+    }
+    if (PyType_Check(owner)) {
+        PyObject *descr = _PyType_Lookup((PyTypeObject *)owner, name);
+        if (descr != NULL && Py_IS_TYPE(descr, CFieldDescriptorType)) return capi_borrow(descr, NULL, rule, expected);
+    }
+    return 0;
+}
+
+static int capi_check(PyObject *rule, PyObject *obj) {
+    if (unlikely(rule != Py_None && !Rule_Check(rule))) {
+        PyErr_Format(PyExc_TypeError, "expected a guardian Rule, got %R", rule);
+        return -1;
+    }
+    return fast_check_type(obj, rule);
+}
+
+static PyObject *capi_check_detail(PyObject *rule, PyObject *obj, PyObject *name, PyObject *expected) {
+    if (capi_check(rule, obj) != 0) return NULL;
+    PyObject *subject = name != NULL ? PyUnicode_FromFormat("Variable '%U'", name) : PyUnicode_FromString("Value");
+    if (subject == NULL) return NULL;
+    PyObject *exc = new_rule_error(subject, name != NULL ? name : Py_None, expected != NULL ? expected : rule, rule, obj);
+    Py_DECREF(subject);
+    return exc;
+}
+
+static GuardianCAPI CAPITable = {
+    .version = GUARDIAN_CAPI_VERSION,
+    .size = sizeof(GuardianCAPI),
+    .compile = capi_compile,
+    .borrow = capi_borrow,
+    .check = capi_check,
+    .check_detail = capi_check_detail,
 };
 
-PyMODINIT_FUNC PyInit__guardian_core(void) {
-    PyObject *m = PyModule_Create(&guardianmodule);
-    if (m == NULL) return NULL;
+// --- MODULE INITIALIZATION ---
+// Multi-phase init. Every type except ShieldMeta and ShieldBase is a heap type built
+// from a spec and bound to the first module object. ShieldBase's metatype is ShieldMeta,
+// and building a type from a spec with a custom metatype needs PyType_FromMetaclass
+// (3.12+), so both stay static while 3.11 is supported. The types, exceptions and caches are still process-wide:
+// created by the first exec and shared by every module object after it. They include
+// objects owned by the importing interpreter (the compile_program function,
+// dataclasses.fields, abc.ABCMeta), so the module declares that it does not support
+// subinterpreters and isolated ones are refused on import. Legacy subinterpreters are
+// still let through by CPython and would share these objects. Per-interpreter support
+// is a tracked follow-up (README, section 7): it moves these globals into module state
+// and threads that state to check_node, which today reads them directly. Free-threaded
+// builds keep the GIL off: see FREE-THREADED BUILDS for how the shared state is accessed.
 
-    GuardianTypeError = PyErr_NewException("guardian.GuardianTypeError", PyExc_TypeError, NULL);
-    Py_XINCREF(GuardianTypeError);
-    PyModule_AddObject(m, "GuardianTypeError", GuardianTypeError);
+static int ProcessStateReady;
+static PyObject *CAPICapsule;       // _C_API: the GuardianCAPI table for other extensions
 
-    GuardianAccessError = PyErr_NewException("guardian.GuardianAccessError", PyExc_AttributeError, NULL);
-    Py_XINCREF(GuardianAccessError);
-    PyModule_AddObject(m, "GuardianAccessError", GuardianAccessError);
+// Creates one of the module's heap types; base may be NULL for object.
+static PyTypeObject *make_type(PyObject *m, PyType_Spec *spec, PyTypeObject *base) {
+    return (PyTypeObject *)PyType_FromModuleAndSpec(m, spec, (PyObject *)base);
+}
 
+static int guardian_init_process(PyObject *m) {
+    GuardianTypeErrorType = make_type(m, &GuardianTypeError_spec, (PyTypeObject *)PyExc_TypeError);
+    if (GuardianTypeErrorType == NULL) return -1;
+    GuardianTypeError = Py_NewRef((PyObject *)GuardianTypeErrorType);
+    GuardianAccessError = PyErr_NewException("guardian.GuardianAccessError", PyExc_AttributeError, NULL);
+    if (GuardianAccessError == NULL) return -1;
     GuardianInitializationError = PyErr_NewException("guardian.GuardianInitializationError", PyExc_UnboundLocalError, NULL);
-    Py_XINCREF(GuardianInitializationError);
-    PyModule_AddObject(m, "GuardianInitializationError", GuardianInitializationError);
+    if (GuardianInitializationError == NULL) return -1;
+
+    str___class__ = PyUnicode_InternFromString("__class__");
+    str_return = PyUnicode_InternFromString("return");
+    str___shield_rules__ = PyUnicode_InternFromString("__shield_rules__");
+    str___bases__ = PyUnicode_InternFromString("__bases__");
+    if (str___class__ == NULL || str_return == NULL || str___shield_rules__ == NULL || str___bases__ == NULL) return -1;
+    // Static builtin types have no tp_dict on 3.12+; go through the type lookup instead
+    ObjectClassDescr = _PyType_Lookup(&PyBaseObject_Type, str___class__);
+    if (ObjectClassDescr == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "object.__class__ descriptor not found");
+        return -1;
+    }
+    Py_INCREF(ObjectClassDescr);
+    PyObject *abc = PyImport_ImportModule("abc");
+    if (abc == NULL) return -1;
+    AbcMetaType = PyObject_GetAttrString(abc, "ABCMeta");
+    Py_DECREF(abc);
+    if (AbcMetaType == NULL) return -1;
+
+    RuleType = make_type(m, &Rule_spec, NULL);
+    StatsRecordType = make_type(m, &StatsRecord_spec, NULL);
+    if (RuleType == NULL || StatsRecordType == NULL) return -1;
+    StatsRegistry = PyList_New(0);
+    if (StatsRegistry == NULL) return -1;
 
-    GuardType.tp_vectorcall_offset = offsetof(GuardObject, vectorcall);
-    if (PyType_Ready(&GuardType) < 0) return NULL;
+    GuardType = make_type(m, &Guard_spec, NULL);
+    GuardedCoroutineType = make_type(m, &GuardedCoroutine_spec, NULL);
+    GuardedGeneratorType = make_type(m, &GuardedGenerator_spec, NULL);
+    GuardedAsyncGeneratorType = make_type(m, &GuardedAsyncGenerator_spec, NULL);
+    StrictGuardType = make_type(m, &StrictGuard_spec, NULL);
+    ProfileScopeType = make_type(m, &ProfileScope_spec, NULL);
+    if (GuardType == NULL || GuardedCoroutineType == NULL || GuardedGeneratorType == NULL
+            || GuardedAsyncGeneratorType == NULL || StrictGuardType == NULL || ProfileScopeType == NULL) return -1;
+    MonitoredCodes = PyDict_New();
+    if (MonitoredCodes == NULL) return -1;
 
-    StrictGuardType.tp_vectorcall_offset = offsetof(StrictGuardObject, vectorcall);
-    if (PyType_Ready(&StrictGuardType) < 0) return NULL;
+    if (PyType_Ready(&ShieldBaseType) < 0) return -1;
+    CFieldDescriptorType = make_type(m, &CFieldDescriptor_spec, NULL);
+    DataclassInitType = make_type(m, &DataclassInit_spec, NULL);
+    if (CFieldDescriptorType == NULL || DataclassInitType == NULL) return -1;
+    str___post_init__ = PyUnicode_InternFromString("__post_init__");
+    if (str___post_init__ == NULL) return -1;
 
-    if (PyType_Ready(&ShieldBaseType) < 0) return NULL;
-    Py_INCREF(&ShieldBaseType);
-    PyModule_AddObject(m, "ShieldBase", (PyObject *)&ShieldBaseType);
+    str___guardian_fields__ = PyUnicode_InternFromString("__guardian_fields__");
+    str___guardian_serialize__ = PyUnicode_InternFromString("__guardian_serialize__");
+    str___dataclass_fields__ = PyUnicode_InternFromString("__dataclass_fields__");
+    str_name = PyUnicode_InternFromString("name");
+    if (!str___guardian_fields__ || !str___guardian_serialize__ || !str___dataclass_fields__ || !str_name) return -1;
+    PyObject *dataclasses = PyImport_ImportModule("dataclasses");
+    if (dataclasses == NULL) return -1;
+    DataclassesFields = PyObject_GetAttrString(dataclasses, "fields");
+    Py_DECREF(dataclasses);
+    if (DataclassesFields == NULL) return -1;
 
-    if (PyType_Ready(&CFieldDescriptorType) < 0) return NULL;
+    str___guardian_init__ = PyUnicode_InternFromString("__guardian_init__");
+    str_path = PyUnicode_InternFromString("path");
+    EmptyTuple = PyTuple_New(0);
+    if (str___guardian_init__ == NULL || str_path == NULL || EmptyTuple == NULL) return -1;
 
-    // Register ShieldBase
-    if (PyType_Ready(&ShieldBaseType) < 0) return NULL;
-    Py_INCREF(&ShieldBaseType);
-    PyModule_AddObject(m, "ShieldBase", (PyObject *)&ShieldBaseType);
+    GuardedListType = make_type(m, &GuardedList_spec, &PyList_Type);
+    GuardedDictType = make_type(m, &GuardedDict_spec, &PyDict_Type);
+    GuardedSetType = make_type(m, &GuardedSet_spec, &PySet_Type);
+    if (GuardedListType == NULL || GuardedDictType == NULL || GuardedSetType == NULL) return -1;
 
-    // Register ShieldMeta (Inherits from type)
+    // ShieldMeta inherits from type
     ShieldMetaType.tp_base = &PyType_Type;
-    if (PyType_Ready(&ShieldMetaType) < 0) return NULL;
-    Py_INCREF(&ShieldMetaType);
-    PyModule_AddObject(m, "ShieldMeta", (PyObject *)&ShieldMetaType);
+    if (PyType_Ready(&ShieldMetaType) < 0) return -1;
 
-    return m;
-}
\ No newline at end of file
+    CAPITable.RuleType = RuleType;
+    CAPITable.TypeError = GuardianTypeError;
+    CAPICapsule = PyCapsule_New(&CAPITable, GUARDIAN_CAPSULE_NAME, NULL);
+    if (CAPICapsule == NULL) return -1;
+    return 0;
+}
+
+static int guardian_exec(PyObject *m) {
+    if (!ProcessStateReady) {
+        if (guardian_init_process(m) < 0) return -1;
+        ProcessStateReady = 1;
+    }
+    if (PyModule_AddObjectRef(m, "GuardianTypeError", GuardianTypeError) < 0
+            || PyModule_AddObjectRef(m, "GuardianAccessError", GuardianAccessError) < 0
+            || PyModule_AddObjectRef(m, "GuardianInitializationError", GuardianInitializationError) < 0
+            || PyModule_AddObjectRef(m, "Rule", (PyObject *)RuleType) < 0
+            || PyModule_AddObjectRef(m, "ShieldBase", (PyObject *)&ShieldBaseType) < 0
+            || PyModule_AddObjectRef(m, "ShieldMeta", (PyObject *)&ShieldMetaType) < 0
+            || PyModule_AddObjectRef(m, "CFieldDescriptor", (PyObject *)CFieldDescriptorType) < 0
+            || PyModule_AddObjectRef(m, "GuardedList", (PyObject *)GuardedListType) < 0
+            || PyModule_AddObjectRef(m, "GuardedDict", (PyObject *)GuardedDictType) < 0
+            || PyModule_AddObjectRef(m, "GuardedSet", (PyObject *)GuardedSetType) < 0
+            || PyModule_AddObjectRef(m, "_C_API", CAPICapsule) < 0) return -1;
+    return 0;
+}
+
+static PyModuleDef_Slot GuardianSlots[] = {
+    {Py_mod_exec, guardian_exec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_NOT_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+static struct PyModuleDef guardianmodule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "_guardian_core",
+    .m_doc = "C core for guardian type enforcement",
+    .m_size = 0,
+    .m_methods = GuardianMethods,
+    .m_slots = GuardianSlots,
+};
+
+PyMODINIT_FUNC PyInit__guardian_core(void) {
+    return PyModuleDef_Init(&guardianmodule);
+}
@@ -1,9 +1,29 @@
+import abc
+import asyncio
+import collections.abc
+import ctypes
+import enum
+import gc
+import array
+import inspect
+import itertools
+import json
+import os
+import pickle
+import sys
+import sysconfig
+import threading
 import pytest
-from typing import List, Dict, Union, Any, Optional
+from dataclasses import field, InitVar, dataclass as std_dataclass
+from typing import List, Dict, Union, Any, Optional, Literal, TypedDict, Annotated, NamedTuple, NotRequired, Protocol, Required
 
-from guardian import guard, deepguard, Shield
-from guardian.dataclasses import dataclass, validator, FrozenInstanceError, asdict
-from guardian._guardian_core import GuardianTypeError, GuardianAccessError
+import guardian
+from guardian import guard, deepguard, Shield, GuardedList, GuardedDict, GuardedSet, Buffer
+from guardian import validate, validate_many, validate_columns, set_max_depth
+from guardian.dataclasses import dataclass, validator, FrozenInstanceError, asdict, dump_json, from_dict, from_json
+from guardian._guardian_core import GuardianTypeError, GuardianAccessError, GuardianInitializationError
+from guardian import _guardian_core
+from guardian._compiler import compile_rule, compile_program, OP_UNION_DISPATCH, OP_TAGGED_UNION, OP_LIST, OP_EXACT, OP_LITERAL, OP_REF
 
 # ==========================================
 # SCENARIO 1: API Payload Processing (Functions)
@@ -90,7 +110,7 @@ def test_shield_encapsulation_and_access():
     with pytest.raises(GuardianAccessError, match="Cannot modify protected/private class attribute"):
         BankAccount._total_accounts = 999
 
-    # 4. Private Attribute Internal Write (Allowed by C-Extension frame walker)
+    # 4. Private Attribute Internal Write (Allowed by C-Extension ownership check)
     account.close_account()
     assert account._is_active is False
 
@@ -168,7 +188,7 @@ def audited_calculation(multiplier: float) -> float:
     return 10.0 # Return is valid, but internal state was corrupted
 
 def test_deepguard_tracing():
-    """Test the PyEval_SetProfile tracing catches internal frame mutations."""
+    """Test deepguard's return-time local checks catch internal frame mutations."""
     
     # 1. Standard Guard catches the bad return, but doesn't trace internal state
     with pytest.raises(GuardianTypeError, match="return"):
@@ -176,4 +196,1324 @@ def test_deepguard_tracing():
 
     # 2. Deepguard intercepts the local frame and catches the internal variable mutation
     with pytest.raises(GuardianTypeError, match="Variable 'multiplier' expected float"):
-        audited_calculation(5.0)
\ No newline at end of file
+        audited_calculation(5.0)
+
+
+# ==========================================
+# SCENARIO 5: Compiled Rule Programs
+# ==========================================
+
+@guard
+def ingest_sensor_payload(payload: Dict[str, List[Union[int, float]]]) -> int:
+    return len(payload)
+
+def test_rule_program_lowering():
+    """Test nested hints lower into a flat C rule program and are checked from it."""
+
+    program = compile_program(Dict[str, List[Union[int, float]]])
+    assert program.source == compile_rule(Dict[str, List[Union[int, float]]])
+    assert program.node_count == 6  # dict, str, list, union, int, float
+
+    assert program.check({"sensor_A": [1, 2.5, 3]}) is True
+    assert program.check({"sensor_A": [1, 2.5, "3.0"]}) is False
+    assert program.check({1: [1]}) is False
+
+    assert ingest_sensor_payload({"sensor_A": [1, 2.5], "sensor_B": []}) == 2
+    with pytest.raises(GuardianTypeError, match="expected dict"):
+        ingest_sensor_payload({"sensor_A": [1, 2.5, "3.0"]})
+
+
+# ==========================================
+# SCENARIO 6: Inline Type Caches
+# ==========================================
+
+class Animal: pass
+class Dog(Animal): pass
+class Robot: pass
+
+class Walker(abc.ABC): pass
+
+def test_inline_caches_track_type_changes():
+    """Test cached isinstance verdicts stay correct when classes or ABC registries change."""
+
+    rule = compile_program(Animal)
+    for _ in range(3):
+        assert rule.check(Dog()) is True
+        assert rule.check(Robot()) is False
+
+    # Rebasing a class bumps its version tag, so the cached miss is discarded.
+    class Mutant(Robot): pass
+    assert rule.check(Mutant()) is False
+    Mutant.__bases__ = (Dog,)
+    assert rule.check(Mutant()) is True
+
+    # ABC hits are cached, misses are not: register() must take effect immediately.
+    abc_rule = compile_program(Walker)
+    assert abc_rule.check(Robot()) is False
+    Walker.register(Robot)
+    assert abc_rule.check(Robot()) is True
+
+    union_rule = compile_program(Union[int, Robot, Dog, List[int]])
+    for _ in range(3):
+        assert union_rule.check(Dog()) is True
+        assert union_rule.check([1, 2]) is True
+        assert union_rule.check(["x"]) is False
+        assert union_rule.check("x") is False
+
+
+# ==========================================
+# SCENARIO 7: Wide & Discriminated Unions
+# ==========================================
+
+@dataclass
+class ClickEvent:
+    kind: Literal["click"]
+    x: int
+
+@dataclass
+class KeyEvent:
+    kind: Literal["key"]
+    code: str
+
+class ClickPayload(TypedDict):
+    kind: Literal["click"]
+    x: int
+
+class ScrollPayload(TypedDict):
+    kind: Literal["scroll"]
+    delta: float
+
+def test_union_dispatch_tables():
+    """Test wide unions dispatch on the value's type and tagged unions on their discriminator."""
+
+    wide = Union[int, str, bytes, List[int], Dict[str, int], None]
+    assert compile_rule(wide)[0] == OP_UNION_DISPATCH
+    rule = compile_program(wide)
+    assert rule.check(None) and rule.check(b"x") and rule.check({"a": 1})
+    assert rule.check(True)           # bool misses the table and falls back to the int branch
+    assert not rule.check([1, "2"])   # the list branch is the only candidate
+    assert not rule.check(1.5)
+
+    events = Union[ClickEvent, KeyEvent]
+    assert compile_rule(events)[0] == OP_TAGGED_UNION
+    rule = compile_program(events)
+    assert rule.check(KeyEvent(kind="key", code="Enter"))
+    assert not rule.check(Animal())
+
+    payloads = compile_program(Union[ClickPayload, ScrollPayload])
+    assert payloads.check({"kind": "scroll", "delta": 1.0})
+    assert not payloads.check({"kind": "hover"})
+    assert not payloads.check({"delta": 1.0})
+    assert not payloads.check(["kind"])
+
+
+# ==========================================
+# SCENARIO 8: Code-Object Ownership
+# ==========================================
+
+def _external_reset(account):
+    account._is_active = True
+
+class SavingsAccount(BankAccount):
+    _rate: float
+
+    def __init__(self, initial_balance: float):
+        super().__init__(initial_balance)
+        self._rate = 0.01
+
+    def apply(self, updates):
+        # Closures and comprehensions compiled inside a method belong to the class
+        [setattr(self, "_rate", r) for r in updates]
+        (lambda: self.close_account())()
+
+    def delegate_reset(self):
+        _external_reset(self)
+
+    def poke(self, other):
+        other._rate = 99.0
+
+    def ask(self, other):
+        other.apply([0.5])  # through the other instance's own method
+
+    def set_later(self, rate):
+        return lambda: setattr(self, "_rate", rate)
+
+def test_shield_ownership_by_code_object():
+    """Test private writes are allowed from the class's own code objects only."""
+
+    account = SavingsAccount(10.0)
+    assert account._rate == 0.01 and account._is_active is True
+
+    account.apply([0.02, 0.03])
+    assert account._rate == 0.03
+    assert account._is_active is False
+
+    # A helper outside the class is denied, even when called from a method.
+    with pytest.raises(GuardianAccessError):
+        account.delegate_reset()
+    with pytest.raises(GuardianAccessError):
+        _external_reset(account)
+
+    # A method may only write the private state of the instance it was called on
+    other = SavingsAccount(5.0)
+    with pytest.raises(GuardianAccessError):
+        account.poke(other)
+    assert other._rate == 0.01
+    account.ask(other)
+    assert other._rate == 0.5
+    with pytest.raises(GuardianAccessError):
+        SavingsAccount.poke(other, account)  # explicit self: still not the target
+
+    # Nested code acts for the method frame that calls it, not for wherever it escapes to
+    with pytest.raises(GuardianAccessError):
+        account.set_later(0.7)()
+
+    # Ownership is fixed at class creation: functions attached later are not owners
+    def late(self):
+        self._rate = 1.0
+    SavingsAccount.late = late
+    with pytest.raises(GuardianAccessError):
+        account.late()
+
+
+# ==========================================
+# SCENARIO 9: Native Shield Rule Tables
+# ==========================================
+
+class Sensor(Shield):
+    reading: int
+
+class CalibratedSensor(Sensor):
+    offset: float
+
+def test_shield_rule_table_invalidation():
+    """Test the per-class rule table follows rule reassignment down the class hierarchy."""
+
+    sensor, calibrated = Sensor(), CalibratedSensor()
+    setattr(calibrated, "".join(["off", "set"]), 0.5)  # non-interned attribute name
+    with pytest.raises(GuardianTypeError):
+        setattr(calibrated, "".join(["off", "set"]), "0.5")
+    with pytest.raises(GuardianTypeError):
+        sensor.reading = "12"
+
+    Sensor.__shield_rules__ = {"reading": (compile_program(str, exact_primitives=True), "str")}
+    sensor.reading = "12"
+    with pytest.raises(GuardianTypeError):
+        sensor.reading = 12
+
+    # Subclasses merged their rules at creation; they are rebuilt rather than left stale.
+    CalibratedSensor.__shield_rules__ = dict(CalibratedSensor.__shield_rules__, reading=(compile_program(Any), "Any"))
+    calibrated.reading = 12
+    calibrated.reading = "12"
+
+
+# ==========================================
+# SCENARIO 10: Slotted Models
+# ==========================================
+
+class Tick(Shield, slots=True):
+    price: float
+    symbol: str
+    venue: str = "XNYS"
+
+@dataclass(slots=True)
+class Quote:
+    bid: float
+    ask: float = 0.0
+
+@dataclass(slots=True, frozen=True)
+class Trade:
+    qty: int
+
+def test_slotted_field_storage():
+    """Test slotted Shield models and dataclasses validate into fixed slots, without a private dict copy."""
+
+    tick = Tick()
+    tick.price, tick.symbol = 101.5, "ACME"
+    assert (tick.price, tick.symbol, tick.venue) == (101.5, "ACME", "XNYS")
+    assert "price" not in tick.__dict__  # defaulted fields keep a dict; slotted ones never touch it
+    with pytest.raises(GuardianTypeError):
+        tick.price = "101.5"
+    del tick.symbol
+    with pytest.raises(AttributeError):
+        tick.symbol
+
+    quote = Quote(1.25)
+    quote.ask = 1.5
+    assert not hasattr(quote, "__dict__") and (quote.bid, quote.ask) == (1.25, 1.5)
+    with pytest.raises(GuardianTypeError):
+        quote.bid = "1.25"
+
+    assert Trade(3).qty == 3
+    with pytest.raises(GuardianTypeError):
+        Trade("3")
+    with pytest.raises(FrozenInstanceError):
+        Trade(3).qty = 4
+
+
+# ==========================================
+# SCENARIO 11: Native Dataclass Constructors
+# ==========================================
+
+@dataclass(frozen=True)
+class LedgerEntry:
+    account: str
+    amount: float
+    tags: list = field(default_factory=list)
+    currency: str = field(default="USD", kw_only=True)
+
+    @validator("account")
+    def normalize_account(cls, value):
+        return value.strip().upper()
+
+@dataclass
+class Batch:
+    size: int
+    seed: InitVar[int]
+
+    def __post_init__(self, seed):
+        self.checksum = self.size * seed
+
+def test_native_dataclass_init():
+    """Test the generated constructor binds arguments, applies defaults and validates in one pass."""
+
+    entry = LedgerEntry(" acc-1 ", 10.5)
+    assert (entry.account, entry.amount, entry.tags, entry.currency) == ("ACC-1", 10.5, [], "USD")
+    assert LedgerEntry("a", 1.0).tags is not entry.tags  # factories run per instance
+    assert str(inspect.signature(LedgerEntry)) == "(account: str, amount: float, tags: list = <factory>, *, currency: str = 'USD') -> None"
+
+    with pytest.raises(GuardianTypeError):
+        LedgerEntry("acc", "10.5")
+    with pytest.raises(GuardianTypeError):
+        LedgerEntry("acc", 1.0, currency=978)
+    with pytest.raises(TypeError, match="missing 1 required positional argument: 'amount'"):
+        LedgerEntry("acc")
+    with pytest.raises(TypeError, match="takes 4 positional arguments but 5 were given"):
+        LedgerEntry("acc", 1.0, [], "EUR")
+    with pytest.raises(TypeError, match="unexpected keyword argument 'memo'"):
+        LedgerEntry("acc", 1.0, memo="x")
+
+    # InitVar classes keep the stdlib constructor, still validated through the descriptors
+    assert Batch(3, seed=7).checksum == 21
+    with pytest.raises(GuardianTypeError):
+        Batch("3", seed=7)
+
+
+# ==========================================
+# SCENARIO 12: Native Serialization
+# ==========================================
+
+@dataclass
+class LineItem:
+    sku: str
+    price: float
+
+@dataclass(slots=True)
+class Invoice:
+    number: int
+    lines: list
+    by_sku: dict
+    totals: tuple
+    memo: Optional[str] = None
+
+def test_native_serialization():
+    """Test dump_dict walks nested containers and dump_json matches json.dumps byte for byte."""
+
+    first, second = LineItem('Widget "A"\n', 2.5), LineItem("Gadget é", 1e16)
+    invoice = Invoice(7, [first, second], {"w": first, 3: [second]}, (1, float("inf")))
+
+    dump = asdict(invoice)
+    assert dump["lines"][1] == {"sku": "Gadget é", "price": 1e16}
+    assert dump["by_sku"][3] == [{"sku": "Gadget é", "price": 1e16}]  # no longer limited to list-of-dataclass heads
+    assert asdict(invoice, include={"number", "memo"}, exclude={"memo"}, number=8, extra=True) == {"number": 8, "extra": True}
+
+    expected = json.dumps(dump, separators=(",", ":"), ensure_ascii=False).encode()
+    assert dump_json(invoice) == expected
+    assert dump_json(invoice, include={"number"}) == b'{"number":7}'
+    with pytest.raises(TypeError, match="not JSON serializable"):
+        dump_json(Invoice(1, [object()], {}, ()))
+
+
+# ==========================================
+# SCENARIO 13: Validated Ingest
+# ==========================================
+
+@dataclass(frozen=True)
+class ShipTo:
+    city: str
+
+@dataclass
+class CartLine:
+    sku: str
+    qty: int = 1
+
+    @validator("sku")
+    def normalize_sku(cls, value):
+        return value.upper()
+
+@dataclass
+class Cart:
+    id: int
+    lines: list[CartLine]
+    ship_to: Optional[ShipTo] = None
+    by_sku: dict[str, CartLine] = field(default_factory=dict)
+
+def test_from_dict_and_json():
+    """Test payloads are parsed, validated and nested into dataclasses in one pass, with error paths."""
+
+    payload = {"id": 1, "lines": [{"sku": "a"}, {"sku": "b", "qty": 3}], "ship_to": {"city": "Oslo"}, "by_sku": {"c": {"sku": "c"}}}
+    cart = from_dict(Cart, payload)
+    assert cart.lines[1] == CartLine("B", 3) and cart.ship_to == ShipTo("Oslo") and cart.by_sku["c"].sku == "C"
+    assert from_json(Cart, json.dumps(payload).encode()) == cart
+    assert from_json(Cart, dump_json(cart)) == cart
+
+    with pytest.raises(GuardianTypeError, match=r"^Variable 'sku' expected str, got int \(5\) at lines\[1\]\.sku$") as info:
+        from_json(Cart, b'{"id": 1, "lines": [{"sku": "a"}, {"sku": 5}]}')
+    error = info.value  # the field's own structured error, located in the document
+    assert error.path == ("lines", 1, "sku") and error.name == "sku" and error.value == 5 and error.expected == "str"
+    assert error.__cause__ is None
+    with pytest.raises(GuardianTypeError) as info:
+        from_dict(Cart, {"id": 1, "lines": [], "by_sku": {"c": {"sku": ["c", 7]}}})
+    assert info.value.path == ("by_sku", "c", "sku") and info.value.value == ["c", 7]
+    with pytest.raises(GuardianTypeError) as info:
+        from_dict(Cart, {"id": 1, "lines": [1]})
+    assert info.value.path == ("lines", 0) and str(info.value).endswith("got int (1) at lines[0]")
+    with pytest.raises(TypeError, match="by_sku.c: .*unexpected field 'price'"):
+        from_dict(Cart, {"id": 1, "lines": [], "by_sku": {"c": {"sku": "c", "price": 2}}})
+    with pytest.raises(TypeError, match="missing 1 required positional argument: 'lines'"):
+        from_dict(Cart, {"id": 1})
+    with pytest.raises(ValueError, match="Invalid JSON at byte"):
+        from_json(Cart, b'{"id": 1, "lines": [}')
+
+
+# ==========================================
+# SCENARIO 14: Scoped Deepguard
+# ==========================================
+
+def _scaled(value):
+    return value * 2
+
+@deepguard
+def reconcile(count: int) -> int:
+    total: int = 0
+    for i in range(count):
+        total += _scaled(i)
+    return total
+
+@deepguard
+def reconcile_partial(fail: bool) -> int:
+    settled: int
+    if fail:
+        raise ValueError("upstream failed")
+    return 0
+
+def test_deepguard_is_scoped():
+    """Test deepguard leaves installed profilers in place and only judges normal returns."""
+
+    seen = []
+    def profiler(frame, event, arg):
+        if event == "call":
+            seen.append(frame.f_code.co_name)
+
+    sys.setprofile(profiler)
+    try:
+        assert reconcile(3) == 6
+        assert sys.getprofile() is profiler
+    finally:
+        sys.setprofile(None)
+    assert "_scaled" in seen  # the existing profiler kept receiving nested events
+
+    with pytest.raises(GuardianInitializationError, match="'settled' was declared as int"):
+        reconcile_partial(False)
+    with pytest.raises(ValueError, match="upstream failed"):
+        reconcile_partial(True)
+
+
+# ==========================================
+# SCENARIO 15: Guarded Containers
+# ==========================================
+
+@guard
+def average_latency(samples: list[Union[int, float]]) -> float:
+    return sum(samples) / len(samples)
+
+@guard
+def route_table(routes: dict[str, int]) -> int:
+    return len(routes)
+
+@dataclass
+class Fleet:
+    tags: set[str]
+
+def test_guarded_containers():
+    """Test guarded containers reject bad elements on mutation and satisfy matching boundaries."""
+
+    samples = GuardedList(float, [1.0, 2.0])
+    samples += [3.0]
+    samples[0:1] = (x for x in [0.5])
+    for mutate in (lambda: samples.append("4"), lambda: samples.insert(0, None),
+                   lambda: samples.extend([4.0, "5"]), lambda: samples.__setitem__(1, "x")):
+        with pytest.raises(GuardianTypeError, match="GuardedList item expected float"):
+            mutate()
+    assert samples == [0.5, 2.0, 3.0] and average_latency(samples) == pytest.approx(5.5 / 3)
+
+    routes = GuardedDict(str, int, {"a": 1}, b=2)
+    routes |= {"c": 3}
+    with pytest.raises(GuardianTypeError, match="GuardedDict value expected int"):
+        routes.update(d="4")
+    with pytest.raises(GuardianTypeError, match="GuardedDict key expected str"):
+        routes[5] = 5
+    assert route_table(routes) == 3
+
+    tags = GuardedSet(str, ["x"])
+    with pytest.raises(GuardianTypeError, match="GuardedSet item expected str"):
+        tags |= {1}
+    assert Fleet(tags).tags is tags
+
+    # A binding that does not subsume the requirement falls back to the element scan
+    with pytest.raises(GuardianTypeError):
+        route_table(GuardedDict(str, object, {"a": "b"}))
+    assert route_table(GuardedDict(str, object, {"a": 1})) == 1
+
+    restored = pickle.loads(pickle.dumps(samples))
+    assert type(restored) is GuardedList and restored.item_type is float and restored == samples
+
+
+# ==========================================
+# SCENARIO 16: Homogeneous Container Scans
+# ==========================================
+
+class Reading:
+    pass
+
+class ShrinkingReading:
+    """Claims to be a Reading; the __class__ lookup empties the list being checked."""
+    batch = []
+
+    @property
+    def __class__(self):
+        ShrinkingReading.batch.clear()
+        return Reading
+
+def test_homogeneous_container_scan():
+    """Test the batched type scan defers misses to the full check and survives resizing."""
+
+    ints = compile_program(list[int])
+    bulk = list(range(5000))
+    assert ints.check(bulk)
+    bulk[4097] = True  # subclass: the scan stops, the full check accepts, the scan resumes
+    assert ints.check(bulk)
+    bulk[4998] = "4998"
+    assert not ints.check(bulk)
+    assert compile_program(tuple[str, ...]).check(tuple("abcdefghij"))
+    assert not compile_program(tuple[str, ...]).check(tuple("abcdefghi") + (None,))
+    assert not _guardian_core.lower_rule((OP_LIST, (OP_EXACT, int))).check([1, 2, 3, 4, 5, True])
+
+    readings = compile_program(list[Reading])
+    ShrinkingReading.batch[:] = [Reading() for _ in range(10)] + [ShrinkingReading()] + [Reading() for _ in range(10)]
+    assert readings.check(ShrinkingReading.batch) and ShrinkingReading.batch == []
+
+
+# ==========================================
+# SCENARIO 17: Buffer Rules
+# ==========================================
+
+@guard
+def ingest_unit_samples(samples: Annotated[array.array, Buffer("d", ndim=1, ge=0.0, le=1.0)]) -> int:
+    return len(samples)
+
+def test_buffer_rules():
+    """Test buffers are checked by format, shape and value range without converting the items."""
+
+    samples = array.array("d", [0.0, 0.25] * 600 + [1.0])
+    assert ingest_unit_samples(samples) == 1201
+    samples[900] = float("nan")
+    with pytest.raises(GuardianTypeError, match=r"expected array\[Buffer\('d', ndim=1, ge=0.0, le=1.0\)\]"):
+        ingest_unit_samples(samples)
+    with pytest.raises(GuardianTypeError):
+        ingest_unit_samples(array.array("f", [0.5]))
+    with pytest.raises(GuardianTypeError):
+        ingest_unit_samples(memoryview(array.array("d", [0.5])))  # right buffer, wrong exporter
+
+    ascii_bytes = compile_program(Buffer("B", le=127))
+    assert ascii_bytes.check(b"plain ascii") and not ascii_bytes.check("café".encode()) and not ascii_bytes.check("str")
+
+    grid = memoryview(array.array("i", range(100))).cast("B").cast("i", shape=[10, 10])
+    assert compile_program(Buffer("i", ndim=2, ge=0, le=99)).check(grid)
+    assert not compile_program(Buffer("i", ndim=1)).check(grid)
+    every_third = memoryview(array.array("q", range(100)))[::3]  # strided: 0, 3, ..., 99
+    assert compile_program(Buffer("q", ge=0, le=99)).check(every_third)
+    assert not compile_program(Buffer("q", ge=0, le=98)).check(every_third)
+    assert not compile_program(Buffer("B", ge=256)).check(b"\xff")  # bound outside the format's range
+    assert compile_program(Buffer("Q", le=2**70)).check(array.array("Q", [2**64 - 1]))
+
+# ==========================================
+# SCENARIO 18: Bulk Validation
+# ==========================================
+
+def test_bulk_validation():
+    """Test batches are validated in one call, as bool vectors, failure indices or columns."""
+
+    assert validate(list[int], [1, 2, 3]) and not validate(int, True)  # @guard semantics: bool is not an int
+    assert validate(compile_program(str), "x")
+    assert validate_many(int, [1, "2", 3, True]) == [True, False, True, False]
+    assert validate_many(int | None, (x if x % 7 else None for x in range(50)), failures=True) == []
+    assert validate_many(float, [0.5] * 1000 + ["1"], failures=True) == [1000]
+    assert validate_many(int, []) == []
+
+    batch = {"id": [1, 2, 3, 4], "price": [9.5, None, 3.0, 2.0], "note": [object()] * 4}
+    assert validate_columns({"id": int, "price": float}, batch) == [True, False, True, True]
+    batch["id"][3] = "4"
+    assert validate_columns({"id": int, "price": float}, batch, failures=True) == [1, 3]
+
+    @dataclass
+    class Row:
+        id: int
+        price: float | None
+
+    assert validate_columns(Row, batch, failures=True) == [3]
+    with pytest.raises(KeyError, match="price"):
+        validate_columns(Row, {"id": [1]})
+    with pytest.raises(ValueError, match="'price' has 1 rows, expected 2"):
+        validate_columns(Row, {"id": [1, 2], "price": [1.0]})
+
+    class Shrinking:
+        def __init__(self, items):
+            self.items = items
+
+        @property
+        def __class__(self):
+            self.items.clear()
+            return Shrinking
+
+    items = [1, 2]
+    items.insert(1, Shrinking(items))
+    with pytest.raises(RuntimeError, match="changed size"):
+        validate_many(int | str, items)
+
+
+# ==========================================
+# SCENARIO 19: Structured Type Errors
+# ==========================================
+
+@guard
+def ingest_readings(payload: dict[str, list[int]] | None) -> int:
+    return len(payload or ())
+
+def test_structured_type_errors():
+    """Test rejections record the failing path and offending element, and render a bounded message lazily."""
+
+    with pytest.raises(GuardianTypeError) as info:
+        ingest_readings({"sensor_A": [1, 2, "x"], "sensor_B": [3]})
+    err = info.value
+    assert err.name == "payload" and err.expected == "dict[str, list[int]] | NoneType"
+    assert err.path == ("sensor_A", 2) and err.value == "x" and err.rule.check({"ok": [1]})
+    assert str(err) == "Variable 'payload' expected dict[str, list[int]] | NoneType, got str ('x') at payload['sensor_A'][2]"
+
+    with pytest.raises(GuardianTypeError) as info:
+        ingest_readings(["x" * 10**6] * 1000)
+    assert info.value.path == () and len(str(info.value)) < 400  # the payload is never rendered in full
+
+    restored = pickle.loads(pickle.dumps(err))
+    assert str(restored) == str(err) and restored.path == ("sensor_A", 2)
+    assert str(GuardianTypeError("plain")) == "plain" and GuardianTypeError("plain").path == ()
+
+    with pytest.raises(GuardianTypeError, match=r"GuardedList item expected list\[int\], got str \('a'\) at item\[1\]"):
+        GuardedList(list[int]).append([1, "a"])
+
+# ==========================================
+# SCENARIO 20: Runtime Statistics
+# ==========================================
+
+@guard
+def store_batch(rows: list[int], tags: dict[str, int]) -> int:
+    return len(rows)
+
+class Meter(Shield):
+    window: tuple[int, ...]
+
+def test_runtime_statistics():
+    """Test guards, Shield classes and dataclass fields count calls, rejections and scanned elements while enabled."""
+
+    @dataclass
+    class Batch:
+        labels: set[str]
+
+    store_batch([1], {})  # not counted: statistics are off
+    guardian.enable_stats()
+    try:
+        guardian.reset_stats()
+        store_batch([1, 2, 3], {"a": 1})
+        with pytest.raises(GuardianTypeError):
+            store_batch([1, "2"], {})
+        meter = Meter()
+        meter.window = (1, 2)
+        Batch({"x", "y"})
+        records = {entry["name"].rsplit(".", 2)[-1]: entry for entry in guardian.stats()}
+    finally:
+        guardian.disable_stats()
+
+    assert records["store_batch"]["kind"] == "guard"
+    assert records["store_batch"]["calls"] == 2 and records["store_batch"]["failures"] == 1
+    assert records["store_batch"]["scanned"]["list"] == 5 and records["store_batch"]["scanned"]["dict"] == 1
+    assert records["store_batch"]["ns"] > 0
+    assert records["Meter"]["kind"] == "shield" and records["Meter"]["scanned"]["tuple"] == 2
+    assert records["labels"]["kind"] == "field" and records["labels"]["name"].endswith("Batch.labels")
+
+    store_batch([1], {})
+    assert {e["name"]: e["calls"] for e in guardian.stats(reset=True)}[records["store_batch"]["name"]] == 2
+    assert all(entry["calls"] == 0 for entry in guardian.stats())
+
+# ==========================================
+# SCENARIO 21: Cold Start (Shared Rules & Lazy Guards)
+# ==========================================
+
+@guard(lazy=True)
+def route_order(order: "PendingOrder", *, priority: int = 0) -> "PendingOrder":
+    return order
+
+class PendingOrder:  # defined after the guard: resolved on the first call
+    pass
+
+def test_cold_start_compilation():
+    """Test equal hints share one compiled Rule and lazy guards compile their signature on the first call."""
+    from guardian._compiler import compile_program
+
+    assert compile_program(dict[str, list[int]]) is compile_program(dict[str, list[int]])
+
+    order = PendingOrder()
+    assert route_order(order, priority=2) is order
+    with pytest.raises(GuardianTypeError) as exc:
+        route_order("not an order")
+    assert exc.value.expected == "PendingOrder"
+    with pytest.raises(GuardianTypeError):
+        route_order(order, priority="high")
+
+    @guard(lazy=True, check_return=False)
+    def tally(counts: list[int]) -> str:
+        return len(counts)
+
+    assert tally([1, 2]) == 2
+    with pytest.raises(GuardianTypeError, match=r"at counts\[1\]"):
+        tally([1, "2"])
+
+# ==========================================
+# SCENARIO 22: Specialized Call Paths
+# ==========================================
+
+@guard
+def scale(x: int, factor: float = 2.0) -> float:
+    return x * factor
+
+@guard
+def halve(x: int) -> int:
+    return x / 2
+
+@guard
+def first_reading(readings: list[int]) -> int:
+    return readings[0] if readings else None
+
+class CountingMeta(type):
+    calls = 0
+
+    def __instancecheck__(cls, obj):
+        CountingMeta.calls += 1
+        if obj == "boom":
+            raise ValueError("instance check failed")
+        return obj == "ok"
+
+class Probed(metaclass=CountingMeta):
+    pass
+
+@guard
+def probe(value: Probed) -> None: ...
+
+def test_specialized_call_paths():
+    """Test the exact-primitive and single-argument guard entry points reject what the generic path rejects."""
+    assert scale(3) == 6.0 and scale(3, 0.5) == 1.5 and scale(x=1, factor=1.0) == 1.0
+    with pytest.raises(GuardianTypeError, match="Variable 'x' expected int"):
+        scale(True)  # exact primitives: bool is not an int
+    with pytest.raises(GuardianTypeError, match="Variable 'factor' expected float"):
+        scale(1, **{"".join(["fac", "tor"]): 1})  # keyword name that is not interned
+    with pytest.raises(GuardianTypeError, match="Variable 'return' expected int"):
+        halve(3)
+
+    assert first_reading([4, 5]) == 4 and first_reading(readings=[7]) == 7
+    with pytest.raises(GuardianTypeError, match=r"at readings\[1\]"):
+        first_reading([4, "5"])
+    with pytest.raises(GuardianTypeError, match="Variable 'return' expected int"):
+        first_reading([])
+
+    # Errors from a user __instancecheck__ surface as-is, and a rejection runs it only once
+    with pytest.raises(ValueError, match="instance check failed"):
+        probe("boom")
+    CountingMeta.calls = 0
+    probe("ok")
+    with pytest.raises(GuardianTypeError, match="Variable 'value' expected Probed"):
+        probe("no")
+    assert CountingMeta.calls == 2
+
+# ==========================================
+# SCENARIO 23: Structural Models (TypedDict, NamedTuple, Dataclass, Protocol)
+# ==========================================
+
+class ShippingAddress(TypedDict):
+    city: str
+    zip_code: NotRequired[int]
+
+class OrderRequest(TypedDict, total=False):
+    order_id: Required[int]
+    address: ShippingAddress
+    notes: list[str]
+
+class GridPoint(NamedTuple):
+    x: int
+    y: int
+
+@std_dataclass(slots=True)
+class Route:
+    start: GridPoint
+    stops: list[GridPoint]
+    name: Optional[str] = None
+
+class SupportsClose(Protocol):
+    def close(self) -> None: ...
+
+class Handle:
+    def close(self) -> None:
+        pass
+
+@guard
+def submit_order(body: OrderRequest) -> int:
+    return body["order_id"]
+
+@std_dataclass
+class Shipment:
+    carrier: "Carrier"  # defined inside test_structural_models, after the first guard
+
+def test_structural_models():
+    """Test TypedDict, NamedTuple, plain dataclass and Protocol hints are checked field by field, with the failing field located."""
+    assert submit_order({"order_id": 7, "address": {"city": "Oslo"}}) == 7
+    assert submit_order({"order_id": 7, "extra": object()}) == 7  # TypedDicts are open
+    with pytest.raises(GuardianTypeError):
+        submit_order({"address": {"city": "Oslo"}})  # required key missing
+    with pytest.raises(GuardianTypeError) as exc:
+        submit_order({"order_id": 7, "address": {"city": "Oslo", "zip_code": "0150"}})
+    assert exc.value.path == ("address", "zip_code") and str(exc.value).endswith("at body['address']['zip_code']")
+
+    route = compile_program(Route)
+    assert route.check(Route(GridPoint(0, 0), [GridPoint(1, 2)]))
+    assert not route.check(Route(GridPoint(0, 0), [GridPoint(1, "2")]))
+    assert not route.check(Route(GridPoint(0, 0), [], name=3))
+    assert not route.check(GridPoint(0, 0))
+
+    @guard
+    def plan(r: Route) -> None: ...
+
+    with pytest.raises(GuardianTypeError) as exc:
+        plan(Route(GridPoint(0, 0), [GridPoint(1, 2), (3, 4)]))
+    assert exc.value.path == ("stops", 1) and "at r.stops[1]" in str(exc.value)
+
+    closer = compile_program(SupportsClose)  # not runtime_checkable: isinstance() would raise
+    assert closer.check(Handle()) and closer.check(Handle())  # second hit served from the per-type cache
+    assert not closer.check(object())
+    dynamic = type("Dynamic", (), {})()
+    dynamic.close = lambda: None
+    assert closer.check(dynamic)
+
+    # A fallback compiled while a forward reference was unresolved is not cached for later guards
+    @guard
+    def ship_early(s: Shipment) -> None: ...
+
+    ship_early(Shipment("not a Carrier"))  # nominal check only
+    global Carrier
+
+    class Carrier:
+        pass
+
+    @guard
+    def ship_late(s: Shipment) -> None: ...
+
+    ship_late(Shipment(Carrier()))
+    with pytest.raises(GuardianTypeError) as exc:
+        ship_late(Shipment("not a Carrier"))
+    assert exc.value.path == ("carrier",)
+
+
+# ==========================================
+# SCENARIO 24: Hashed Literal Tables
+# ==========================================
+class Priority(enum.IntEnum):
+    LOW = 1
+    HIGH = 2
+
+class Side(enum.Enum):
+    BUY = "buy"
+    SELL = "sell"
+
+def test_hashed_literal_tables():
+    """Test Literal membership is a hashed, type-strict lookup for wide and narrow value sets alike."""
+    one = compile_program(Literal[1])
+    assert one.check(1)
+    assert not one.check(True) and not one.check(1.0) and not one.check(Priority.LOW)
+    both = compile_program(Literal[1, True])
+    assert both.check(1) and both.check(True) and not both.check(1.0)
+
+    routes = tuple(f"route.{i}" for i in range(300))
+    wide = compile_program(Literal[routes])
+    assert wide.check("route.299") and wide.check(json.loads('"route.150"'))  # equal but not identical
+    assert wide.check("".join(["route.", "7"]))
+    assert not wide.check("route.300") and not wide.check(299)
+    assert not wide.check([]) and not wide.check({})  # unhashable input is a plain miss
+
+    sides = compile_program(Literal[Side.BUY, Priority.HIGH])
+    assert sides.check(Side.BUY) and sides.check(Priority.HIGH)
+    assert not sides.check("buy") and not sides.check(2) and not sides.check(Side.SELL)
+
+    with pytest.raises(TypeError, match="hashable"):
+        compile_program(Literal[[1, 2]])
+
+    status = compile_rule(Union[Literal["open", "closed"], int, bytes, None])
+    assert status[0] == OP_UNION_DISPATCH
+    program = compile_program(Union[Literal["open", "closed"], int, bytes, None])
+    assert program.check("open") and program.check(3) and program.check(None)
+    assert program.check(b"x") and not program.check("pending") and not program.check(2.5)
+
+
+# ==========================================
+# SCENARIO 25: Recursive Aliases & Bounded Depth
+# ==========================================
+class Comment(TypedDict):
+    body: str
+    replies: list["Comment"]
+
+@std_dataclass
+class Category:
+    name: str
+    children: list["Category"]
+    parent: Optional["Category"] = None
+
+def nested(levels, leaf):
+    value = leaf
+    for _ in range(levels):
+        value = [value]
+    return value
+
+def test_recursive_aliases():
+    """Test self-referencing models and `type` aliases are enforced to any depth, cycles included, up to the configured limit."""
+    assert compile_rule(Comment)[0] == OP_REF
+    thread = compile_program(Comment)
+    assert thread.check({"body": "a", "replies": [{"body": "b", "replies": [{"body": "c", "replies": []}]}]})
+    assert not thread.check({"body": "a", "replies": [{"body": "b", "replies": [{"body": 3, "replies": []}]}]})
+
+    root = Category("root", [])
+    root.children.append(Category("leaf", [], parent=root))  # parent pointers form a cycle
+    assert validate(Category, root)
+    root.children.append(Category("bad", [Category(7, [])]))
+    assert not validate(Category, root)
+
+    @guard
+    def publish(category: Category) -> None: ...
+
+    with pytest.raises(GuardianTypeError) as exc:
+        publish(root)
+    assert exc.value.path == ("children", 1, "children", 0, "name")
+
+    if sys.version_info >= (3, 12):
+        namespace = {}
+        exec("type JSON = dict[str, JSON] | list[JSON] | str | int | float | bool | None", namespace)
+        document = compile_program(namespace["JSON"])
+        assert document.check(json.loads('{"a": [1, 2.5, {"b": null, "c": [true, "x"]}]}'))
+        assert not document.check({"a": [1, {"b": object()}]})
+        assert not document.check({1: "non-string key"})
+        assert document.check(nested(900, 1))
+        with pytest.raises(RecursionError):
+            document.check(nested(100_000, 1))  # bounded memory: refused, not walked
+        loop = []
+        loop.append(loop)
+        assert document.check(loop)
+
+    previous = set_max_depth(8)
+    try:
+        assert thread.check({"body": "a", "replies": []})
+        deep = {"body": "x", "replies": []}
+        for _ in range(20):
+            deep = {"body": "x", "replies": [deep]}
+        with pytest.raises(RecursionError):
+            thread.check(deep)
+        with pytest.raises(ValueError):
+            set_max_depth(0)
+    finally:
+        assert set_max_depth(previous) == 8
+
+# ==========================================
+# SCENARIO 26: Concurrent Checks (Free-Threading)
+# ==========================================
+
+@guard
+def tally(reading: Union[int, float, str, bytes], series: list[int]) -> int:
+    return len(series)
+
+class Gauge(Shield):
+    level: int
+    unit: str
+
+class Dial(Shield):
+    level: int = 0
+
+class EvictingMeta(type):
+    def __instancecheck__(cls, obj):
+        cls.victims.clear()  # drops the container's reference to the item under check
+        cls.filler = [Evicted("reused") for _ in range(64)]  # takes over a freed item's memory
+        return False
+
+class Evicting(metaclass=EvictingMeta):
+    victims = []
+
+class PayloadMeta(type):
+    def __instancecheck__(cls, obj):
+        return obj.payload == 1
+
+class HasPayload(metaclass=PayloadMeta):
+    pass
+
+class Evicted:
+    def __init__(self, payload):
+        self.payload = payload
+
+def run_threads(n, target):
+    errors = []
+    def body(i):
+        try:
+            target(i)
+        except BaseException as exc:
+            errors.append(exc)
+    threads = [threading.Thread(target=body, args=(i,)) for i in range(n)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert not errors, errors
+
+def test_concurrent_checks():
+    """Test guards, Shield classes and statistics stay exact when many threads check through shared rules at once."""
+    if sysconfig.get_config_var("Py_GIL_DISABLED"):
+        assert not sys._is_gil_enabled()  # importing the core must not turn the GIL back on
+
+    previous = sys.getswitchinterval()
+    sys.setswitchinterval(1e-6)  # with a GIL, switch threads as often as possible
+    guardian.enable_stats()
+    try:
+        guardian.reset_stats()
+        readings = (1, 2.5, "x", b"y", True)  # more types than the union's inline cache holds
+        def hammer(i):
+            gauge = Gauge()
+            for k in range(2000):
+                assert tally(readings[(i + k) % 5], [k]) == 1
+                gauge.level = k
+                with pytest.raises(GuardianTypeError):
+                    gauge.unit = k
+        run_threads(8, hammer)
+        records = {entry["name"].rsplit(".", 1)[-1]: entry for entry in guardian.stats()}
+    finally:
+        guardian.disable_stats()
+        sys.setswitchinterval(previous)
+    assert records["tally"]["calls"] == 16_000 and records["tally"]["failures"] == 0
+    assert records["tally"]["scanned"]["list"] == 16_000
+    assert records["Gauge"]["calls"] == 32_000 and records["Gauge"]["failures"] == 16_000
+
+    # Rebinding a field on the class swaps its attribute table while instances are being assigned
+    def churn(i):
+        dial = Dial()
+        for k in range(2000):
+            if i == 0:
+                Dial.level = k
+            dial.level = k
+            with pytest.raises(GuardianTypeError):
+                dial.level = "high"
+    run_threads(4, churn)
+
+    @guard(lazy=True)
+    def first_call(value: "Gauge") -> int:
+        return 1
+
+    start = threading.Barrier(8)
+    def race(i):
+        start.wait()
+        assert first_call(Gauge()) == 1
+        with pytest.raises(GuardianTypeError):
+            first_call(i)
+    run_threads(8, race)
+
+    # A check that empties the container it is walking must not free the item it is reading
+    for hint, victims in ((list[Union[Evicting, HasPayload]], [Evicted(1)]),
+                          (dict[str, Union[Evicting, HasPayload]], {"a": Evicted(1)})):
+        Evicting.victims = victims
+        assert compile_program(hint).check(victims)  # the second branch still sees the original item
+
+# ==========================================
+# SCENARIO 27: C API Capsule (Native Callers)
+# ==========================================
+
+class GuardianCAPI(ctypes.Structure):  # mirrors guardian_capi.h
+    _fields_ = [
+        ("version", ctypes.c_uint),
+        ("size", ctypes.c_size_t),
+        ("RuleType", ctypes.py_object),
+        ("TypeError", ctypes.py_object),
+        ("compile", ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.py_object)),
+        ("borrow", ctypes.PYFUNCTYPE(ctypes.c_int, ctypes.py_object, ctypes.c_void_p,
+                                     ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_void_p))),
+        ("check", ctypes.PYFUNCTYPE(ctypes.c_int, ctypes.py_object, ctypes.py_object)),
+        ("check_detail", ctypes.PYFUNCTYPE(ctypes.c_void_p, ctypes.py_object, ctypes.py_object,
+                                           ctypes.c_void_p, ctypes.c_void_p)),
+    ]
+
+def load_capi():
+    get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+    get_pointer.restype = ctypes.c_void_p
+    get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+    return GuardianCAPI.from_address(get_pointer(_guardian_core._C_API, b"guardian._guardian_core._C_API"))
+
+def borrowed(api, owner, name=None):
+    rule, expected = ctypes.c_void_p(), ctypes.c_void_p()
+    if not api.borrow(owner, None if name is None else id(name), ctypes.byref(rule), ctypes.byref(expected)):
+        return None
+    return ctypes.cast(rule, ctypes.py_object).value, ctypes.cast(expected, ctypes.py_object).value
+
+def check_detail(api, rule, value, name=None, expected=None):
+    address = api.check_detail(rule, value, None if name is None else id(name), None if expected is None else id(expected))
+    if address is None:
+        return None
+    error = ctypes.cast(address, ctypes.py_object).value
+    ctypes.pythonapi.Py_DecRef(ctypes.c_void_p(address))  # the table hands out a new reference
+    return error
+
+@guard
+def decode_frame(rows: list[int], *, channel: str = "a") -> int:
+    return len(rows)
+
+@dataclass
+class Receipt:
+    price: float
+
+class Symbol(Shield):
+    symbol: str
+
+def test_c_api_capsule():
+    """Test other extensions can compile or borrow rules and run the native checker through the _C_API capsule."""
+    api = load_capi()
+    assert api.version == 1 and api.size == ctypes.sizeof(GuardianCAPI)
+    assert api.RuleType is _guardian_core.Rule and api.TypeError is GuardianTypeError
+    with open(os.path.join(guardian.get_include(), "guardian_capi.h"), encoding="utf-8") as header:
+        assert "#define GUARDIAN_CAPI_VERSION 1" in header.read()
+
+    rows = api.compile(list[int])
+    assert rows is compile_program(list[int], exact_primitives=True)  # shared with @guard
+    assert api.check(rows, [1, 2, 3]) == 1
+    assert api.check(rows, [1, "2"]) == 0
+    assert api.check(api.compile(int), True) == 0  # bool is not an int, as in @guard
+    with pytest.raises(TypeError):
+        api.check(list[int], [])
+
+    rule, expected = borrowed(api, decode_frame, "rows")
+    assert api.check(rule, [1]) == 1 and expected == list[int]
+    assert api.check(borrowed(api, decode_frame, "channel")[0], 5) == 0
+    assert api.check(borrowed(api, decode_frame, "return")[0], 1) == 1
+    assert borrowed(api, decode_frame, "missing") is None
+    assert api.check(borrowed(api, Receipt, "price")[0], "cheap") == 0
+    assert api.check(borrowed(api, Receipt.__dict__["price"])[0], 1.5) == 1
+    assert api.check(borrowed(api, Symbol, "symbol")[0], "ACME") == 1
+    assert borrowed(api, rows)[0] is rows
+
+    assert check_detail(api, rows, [1, 2]) is None
+    error = check_detail(api, rows, [1, 2, "3"], "rows", list[int])
+    assert isinstance(error, GuardianTypeError) and error.path == (2,) and error.value == "3"
+    assert "Variable 'rows' expected list[int]" in str(error)
+    assert check_detail(api, rows, "oops").path == ()
+
+# ==========================================
+# SCENARIO 28: Coroutine & Generator Guards
+# ==========================================
+
+@guard
+async def fetch_price(sku: str) -> float:
+    await asyncio.sleep(0)
+    return 9.5 if sku != "free" else "0"
+
+@guard
+async def fetch_basket(skus: list[str]) -> list[float]:
+    return [await fetch_price(sku) for sku in skus]
+
+@guard
+def running_total(start: int) -> collections.abc.Generator[int, int, str]:
+    total = start
+    while total < 100:
+        step = yield total
+        total += step if step is not None else 1
+    return "done" if total == 100 else total
+
+@guard
+def countdown(n: int) -> collections.abc.Iterator[int]:
+    yield from range(n, 0, -1)
+    yield "liftoff"
+
+@guard
+async def ticks(n: int) -> collections.abc.AsyncGenerator[int, None]:
+    for i in range(n):
+        await asyncio.sleep(0)
+        yield i
+    yield None
+
+@guard(lazy=True)
+async def lazy_quote(sku: str) -> float:
+    return 1
+
+def test_coroutine_and_generator_guards():
+    """Test async functions check the awaited result and generators every yield, send and return value."""
+    async def shop():
+        assert await fetch_basket(["a", "b"]) == [9.5, 9.5]
+        assert await asyncio.gather(fetch_price("a"), asyncio.create_task(fetch_price("b"))) == [9.5, 9.5]
+        with pytest.raises(GuardianTypeError, match="Variable 'return' expected float, got str"):
+            await fetch_basket(["a", "free"])
+        with pytest.raises(GuardianTypeError, match="got int"):
+            await lazy_quote("a")
+    asyncio.run(shop())
+    assert asyncio.run(fetch_price("a")) == 9.5
+
+    with pytest.raises(GuardianTypeError, match="Variable 'sku'"):
+        fetch_price(7)  # arguments are still checked on the call, before any await
+    pending = fetch_price("a")
+    assert asyncio.iscoroutine(pending) and pending.cr_code.co_name == "fetch_price"
+    pending.close()
+
+    totals = running_total(97)
+    assert next(totals) == 97 and totals.send(2) == 99 and isinstance(totals, collections.abc.Generator)
+    with pytest.raises(StopIteration) as stop:
+        next(totals)
+    assert stop.value.value == "done"
+    totals = running_total(98)
+    next(totals)
+    with pytest.raises(GuardianTypeError, match="Variable 'send' expected int, got str"):
+        totals.send("2")
+    totals = running_total(99)
+    next(totals)
+    with pytest.raises(GuardianTypeError, match="Variable 'return' expected str, got int"):
+        totals.send(5)  # overshoots to 104 and returns it
+    with pytest.raises(GuardianTypeError, match="Variable 'yield' expected int, got str"):
+        list(countdown(3))
+
+    async def watch():
+        seen = []
+        with pytest.raises(GuardianTypeError, match="Variable 'yield' expected int, got NoneType"):
+            async for tick in ticks(2):
+                seen.append(tick)
+        return seen
+    assert asyncio.run(watch()) == [0, 1]
+
+
+
+# ==========================================
+# SCENARIO 29: Out-of-Band Container Writes
+# ==========================================
+
+@guard
+def total_units(units: list[int]) -> int:
+    return sum(units)
+
+@guard
+def count_routes(routes: dict[str, int]) -> int:
+    return len(routes)
+
+@guard
+def count_tags(tags: set[str]) -> int:
+    return len(tags)
+
+def test_guarded_container_bypass():
+    """Test writes through the base type's methods are caught, by a scan or by a trusted container's length snapshot."""
+    units = GuardedList(int, [1, 2])
+    assert not units.trusted
+    assert total_units(units) == 3
+    list.append(units, "bypass")  # skips GuardedList.append
+    with pytest.raises(GuardianTypeError, match=r"at units\[2\]"):
+        total_units(units)
+    units.pop()
+    units.append(3)
+    assert total_units(units) == 6
+    list.__setitem__(units, 0, "same-size")
+    assert not validate(list[int], units)  # untrusted containers are scanned at every boundary
+    units[0] = 1
+
+    routes = GuardedDict(str, int, {"a": 1})
+    dict.__setitem__(routes, "b", "2")
+    with pytest.raises(GuardianTypeError):
+        count_routes(routes)
+    del routes["b"]
+    assert count_routes(routes) == 1
+
+    tags = GuardedSet(str, ["x"])
+    set.add(tags, 7)
+    with pytest.raises(GuardianTypeError):
+        count_tags(tags)
+
+    tree = Category("root", GuardedList(Category, []))
+    list.append(tree.children, "bypass")
+    assert not validate(Category, tree)  # recursive rules take the same snapshot check
+
+    # Opting in skips the scan; the length snapshot still catches appends and removals
+    units.trusted = True
+    assert total_units(units) == 6
+    list.append(units, "bypass")
+    with pytest.raises(GuardianTypeError, match=r"at units\[3\]"):
+        total_units(units)
+    units.pop()
+    assert total_units(units) == 6  # rescanned once, then trusted again
+    assert not pickle.loads(pickle.dumps(units)).trusted
+    with pytest.raises(AttributeError):
+        del units.trusted
+
+    # Known limit of trusted: an out-of-band write that leaves the length unchanged is not noticed
+    list.__setitem__(units, 0, "same-size")
+    assert validate(list[int], units)
+    units.trusted = True  # re-trusting rescans the contents
+    assert not validate(list[int], units)
+
+
+
+# ==========================================
+# SCENARIO 30: Heap Types
+# ==========================================
+
+HEAPTYPE = 1 << 9
+
+class UnitList(GuardedList):
+    pass
+
+def churn_core_objects(n):
+    UnitList(int, [n]).append(n)
+    GuardedDict(str, int, a=n)
+    assert list(itertools.islice(countdown(2), 2)) == [2, 1]
+    with pytest.raises(GuardianTypeError):
+        total_units(["x"])
+
+def test_core_types_are_heap_types():
+    """Test the core's types are immutable heap types and their instances release the type reference."""
+    core_types = [_guardian_core.Rule, GuardianTypeError, GuardedList, GuardedDict, GuardedSet,
+                  type(total_units), type(countdown(1))]
+    for tp in core_types:
+        assert tp.__flags__ & HEAPTYPE, tp
+        with pytest.raises(TypeError):
+            tp.extra = 1
+    for tp in (_guardian_core.Rule, type(total_units), type(countdown(1))):
+        with pytest.raises(TypeError):
+            tp()
+    assert not _guardian_core.ShieldBase.__flags__ & HEAPTYPE  # needs its static metatype
+
+    tracked = core_types + [UnitList]
+    churn_core_objects(0)  # compiles and caches the rules first
+    gc.collect()
+    before = [sys.getrefcount(tp) for tp in tracked]
+    for n in range(100):
+        churn_core_objects(n)
+    gc.collect()
+    assert [sys.getrefcount(tp) for tp in tracked] == before